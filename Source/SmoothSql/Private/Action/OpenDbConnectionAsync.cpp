@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Action/OpenDbConnectionAsync.h"
+
+#include "DbComponents/DbObject.h"
+
+UOpenDbConnectionAsync* UOpenDbConnectionAsync::OpenDbConnectionAsync(UObject* WorldContextObject, int32 OpenFlags, bool bUseDefaultWarmup, const FDbWarmupParams& Warmup)
+{
+	if (auto Node = NewObject<UOpenDbConnectionAsync>())
+	{
+		Node->OpenFlags = OpenFlags;
+		Node->bUseDefaultWarmup = bUseDefaultWarmup;
+		Node->Warmup = Warmup;
+		Node->RegisterWithGameInstance(WorldContextObject);
+		return Node;
+	}
+
+	return nullptr;
+}
+
+void UOpenDbConnectionAsync::Activate()
+{
+	Super::Activate();
+
+	TFuture<UDbObject*> Future = bUseDefaultWarmup ? UDbObject::OpenAsync(OpenFlags) : UDbObject::OpenAsync(OpenFlags, Warmup);
+
+	// Continuation runs on the game thread, where future is fulfilled
+	TWeakObjectPtr<UOpenDbConnectionAsync> WeakThis(this);
+	Future.Next([WeakThis](UDbObject* Connection)
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->OnOpened(Connection);
+		}
+	});
+}
+
+void UOpenDbConnectionAsync::OnOpened(UDbObject* Connection)
+{
+	if (Connection)
+	{
+		Opened.Broadcast(Connection);
+	}
+	else
+	{
+		Failed.Broadcast(nullptr);
+	}
+
+	SetReadyToDestroy();
+}
@@ -17,6 +17,8 @@ void UExecuteQueryAsync::Step()
 	}
 	else
 	{
+		const EDbInterruptReason Reason = Stmt->GetInterruptReason();
+		
 		// Clear all timers
 		auto World = GEngine->GetWorldFromContextObjectChecked(WorldContext);
 		World->GetTimerManager().ClearAllTimersForObject(this);
@@ -26,7 +28,15 @@ void UExecuteQueryAsync::Step()
 		Stmt = nullptr;
 		bActive = false;
 				
-		Completed.Broadcast();
+		switch (Reason)
+		{
+		case EDbInterruptReason::Cancelled:
+			Cancelled.Broadcast(); break;
+		case EDbInterruptReason::TimedOut:
+			TimedOut.Broadcast(); break;
+		default:
+			Completed.Broadcast(); break;
+		}
 
 		// Notify others that query on given statement finished
 		// Singleton->OnAsyncQueryEnd.Broadcast(Statement);
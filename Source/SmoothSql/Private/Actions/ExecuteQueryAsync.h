@@ -44,6 +44,14 @@ public:
 	
 	UPROPERTY(BlueprintAssignable)
 	FQueryCompleteOutputPin Completed;
+
+	/// Query was interrupted with Cancel()
+	UPROPERTY(BlueprintAssignable)
+	FQueryCompleteOutputPin Cancelled;
+
+	/// Query step exceeded statement time budget
+	UPROPERTY(BlueprintAssignable)
+	FQueryCompleteOutputPin TimedOut;
 	
 	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"), Category = "SmoothSqlite|Query")
 	static UExecuteQueryAsync* ForEachResultAsync(UObject* WorldContextObject, UDbStmt* Statement);
@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Data/DbStructBinding.h"
+
+#include "SmoothSql.h"
+#include "SmoothSqliteUtils.h"
+#include "sqlite3.h"
+
+namespace
+{
+	/// Column as string, sqlite3 keeps text valid until next step
+	FString ColumnText(sqlite3_stmt* Stmt, int32 Column)
+	{
+		const char* Text = reinterpret_cast<const char*>(sqlite3_column_text(Stmt, Column));
+		const int32 Len = sqlite3_column_bytes(Stmt, Column);
+
+		return SmoothSql::Utf8ToString(Text, Len);
+	}
+
+	FName ColumnName(sqlite3_stmt* Stmt, int32 Column)
+	{
+		const char* Text = reinterpret_cast<const char*>(sqlite3_column_text(Stmt, Column));
+		const int32 Len = sqlite3_column_bytes(Stmt, Column);
+		return SmoothSql::Utf8ToName(Text, Len);
+	}
+}
+
+bool SmoothSql::IsSupportedProperty(const FProperty* Property)
+{
+	if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		// Blob
+		return ArrayProperty->Inner->IsA<FByteProperty>();
+	}
+
+	return Property->IsA<FBoolProperty>()
+		|| Property->IsA<FNumericProperty>()
+		|| Property->IsA<FEnumProperty>()
+		|| Property->IsA<FStrProperty>()
+		|| Property->IsA<FNameProperty>()
+		|| Property->IsA<FTextProperty>();
+}
+
+void SmoothSql::BuildStructBindings(const UScriptStruct* Struct, sqlite3_stmt* Stmt, TArray<FDbPropertyBinding>& OutBindings)
+{
+	OutBindings.Reset();
+
+	const int32 NumColumns = sqlite3_column_count(Stmt);
+	TArray<FString> ColumnNames;
+	ColumnNames.Reserve(NumColumns);
+	for (int32 Idx = 0; Idx < NumColumns; ++Idx)
+	{
+		ColumnNames.Add(UTF8_TO_TCHAR(sqlite3_column_name(Stmt, Idx)));
+	}
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		// Members of Blueprint structs have generated names, authored name is the one user typed
+		const FString Name = It->GetAuthoredName();
+		const int32 Column = ColumnNames.IndexOfByPredicate([&Name](const FString& ColumnName)
+		{
+			return ColumnName.Equals(Name, ESearchCase::IgnoreCase);
+		});
+
+		if (Column == INDEX_NONE)
+		{
+			continue;
+		}
+
+		if (!IsSupportedProperty(*It))
+		{
+			UE_LOG(LogSmoothSqlite, Warning, L"Member \"%s\" of \"%s\" has unsupported type %s, skipped", *Name, *Struct->GetName(), *It->GetCPPType());
+			continue;
+		}
+
+		OutBindings.Add({ *It, Column });
+	}
+}
+
+void SmoothSql::ReadColumn(const FProperty* Property, void* ValuePtr, sqlite3_stmt* Stmt, int32 Column)
+{
+	if (sqlite3_column_type(Stmt, Column) == SQLITE_NULL)
+	{
+		Property->ClearValue(ValuePtr);
+		return;
+	}
+
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		BoolProperty->SetPropertyValue(ValuePtr, sqlite3_column_int64(Stmt, Column) != 0);
+	}
+	else if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (NumericProperty->IsFloatingPoint())
+			NumericProperty->SetFloatingPointPropertyValue(ValuePtr, sqlite3_column_double(Stmt, Column));
+		else
+			NumericProperty->SetIntPropertyValue(ValuePtr, static_cast<int64>(sqlite3_column_int64(Stmt, Column)));
+	}
+	else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		EnumProperty->GetUnderlyingProperty()->SetIntPropertyValue(ValuePtr, static_cast<int64>(sqlite3_column_int64(Stmt, Column)));
+	}
+	else if (const FStrProperty* StrProperty = CastField<FStrProperty>(Property))
+	{
+		StrProperty->SetPropertyValue(ValuePtr, ColumnText(Stmt, Column));
+	}
+	else if (const FNameProperty* NameProperty = CastField<FNameProperty>(Property))
+	{
+		NameProperty->SetPropertyValue(ValuePtr, ColumnName(Stmt, Column));
+	}
+	else if (const FTextProperty* TextProperty = CastField<FTextProperty>(Property))
+	{
+		TextProperty->SetPropertyValue(ValuePtr, FText::FromString(ColumnText(Stmt, Column)));
+	}
+	else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		const uint8* Blob = static_cast<const uint8*>(sqlite3_column_blob(Stmt, Column));
+		const int32 Len = sqlite3_column_bytes(Stmt, Column);
+
+		TArray<uint8>& Bytes = *static_cast<TArray<uint8>*>(ValuePtr);
+		Bytes.SetNumUninitialized(Len);
+		if (Len > 0)
+		{
+			FMemory::Memcpy(Bytes.GetData(), Blob, Len);
+		}
+	}
+}
+
+void SmoothSql::ReadRow(const TArray<FDbPropertyBinding>& Bindings, void* StructPtr, sqlite3_stmt* Stmt)
+{
+	for (const FDbPropertyBinding& Binding : Bindings)
+	{
+		ReadColumn(Binding.Property, Binding.Property->ContainerPtrToValuePtr<void>(StructPtr), Stmt, Binding.Column);
+	}
+}
+
+const TCHAR* SmoothSql::GetColumnType(const FProperty* Property)
+{
+	if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		return NumericProperty->IsFloatingPoint() ? L"REAL" : L"INTEGER";
+	}
+
+	if (Property->IsA<FBoolProperty>() || Property->IsA<FEnumProperty>())
+	{
+		return L"INTEGER";
+	}
+
+	if (Property->IsA<FArrayProperty>())
+	{
+		return L"BLOB";
+	}
+
+	return L"TEXT";
+}
+
+FSqliteValue SmoothSql::GetPropertyValue(const FProperty* Property, const void* ValuePtr)
+{
+	FSqliteValue Value;
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		Value.Type = EDbValueType::Integer;
+		Value.Integer = BoolProperty->GetPropertyValue(ValuePtr) ? 1 : 0;
+	}
+	else if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (NumericProperty->IsFloatingPoint())
+		{
+			Value.Type = EDbValueType::Float;
+			Value.Float = NumericProperty->GetFloatingPointPropertyValue(ValuePtr);
+		}
+		else
+		{
+			Value.Type = EDbValueType::Integer;
+			Value.Integer = NumericProperty->GetSignedIntPropertyValue(ValuePtr);
+		}
+	}
+	else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		Value.Type = EDbValueType::Integer;
+		Value.Integer = EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(ValuePtr);
+	}
+	else if (const FStrProperty* StrProperty = CastField<FStrProperty>(Property))
+	{
+		Value.Type = EDbValueType::Text;
+		Value.Text = StrProperty->GetPropertyValue(ValuePtr);
+	}
+	else if (const FNameProperty* NameProperty = CastField<FNameProperty>(Property))
+	{
+		Value.Type = EDbValueType::Text;
+		Value.Text = NameProperty->GetPropertyValue(ValuePtr).ToString();
+	}
+	else if (const FTextProperty* TextProperty = CastField<FTextProperty>(Property))
+	{
+		Value.Type = EDbValueType::Text;
+		Value.Text = TextProperty->GetPropertyValue(ValuePtr).ToString();
+	}
+	else if (CastField<FArrayProperty>(Property))
+	{
+		Value.Type = EDbValueType::Blob;
+		Value.Blob = *static_cast<const TArray<uint8>*>(ValuePtr);
+	}
+	return Value;
+}
+
+void SmoothSql::BindText(sqlite3_stmt* Stmt, int32 Param, const FString& Text)
+{
+	const FTCHARToUTF8 Converted(*Text);
+	sqlite3_bind_text(Stmt, Param, Converted.Get(), Converted.Length(), SQLITE_TRANSIENT);
+}
+
+void SmoothSql::BindProperty(const FProperty* Property, const void* ValuePtr, sqlite3_stmt* Stmt, int32 Param)
+{
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		sqlite3_bind_int(Stmt, Param, BoolProperty->GetPropertyValue(ValuePtr) ? 1 : 0);
+	}
+	else if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (NumericProperty->IsFloatingPoint())
+			sqlite3_bind_double(Stmt, Param, NumericProperty->GetFloatingPointPropertyValue(ValuePtr));
+		else
+			sqlite3_bind_int64(Stmt, Param, NumericProperty->GetSignedIntPropertyValue(ValuePtr));
+	}
+	else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		sqlite3_bind_int64(Stmt, Param, EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(ValuePtr));
+	}
+	else if (const FStrProperty* StrProperty = CastField<FStrProperty>(Property))
+	{
+		BindText(Stmt, Param, StrProperty->GetPropertyValue(ValuePtr));
+	}
+	else if (CastField<FArrayProperty>(Property))
+	{
+		const TArray<uint8>& Bytes = *static_cast<const TArray<uint8>*>(ValuePtr);
+		sqlite3_bind_blob(Stmt, Param, Bytes.GetData(), Bytes.Num(), SQLITE_TRANSIENT);
+	}
+	else
+	{
+		BindText(Stmt, Param, GetPropertyValue(Property, ValuePtr).Text);
+	}
+}
+
+void SmoothSql::ResultProperty(const FProperty* Property, const void* ValuePtr, sqlite3_context* Context)
+{
+	// Numbers go straight to sqlite, text is converted once
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		sqlite3_result_int(Context, BoolProperty->GetPropertyValue(ValuePtr) ? 1 : 0);
+	}
+	else if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (NumericProperty->IsFloatingPoint())
+			sqlite3_result_double(Context, NumericProperty->GetFloatingPointPropertyValue(ValuePtr));
+		else
+			sqlite3_result_int64(Context, NumericProperty->GetSignedIntPropertyValue(ValuePtr));
+	}
+	else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		sqlite3_result_int64(Context, EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(ValuePtr));
+	}
+	else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		const TArray<uint8>& Bytes = *static_cast<const TArray<uint8>*>(ValuePtr);
+		sqlite3_result_blob(Context, Bytes.GetData(), Bytes.Num(), SQLITE_TRANSIENT);
+	}
+	else
+	{
+		const FSqliteValue Value = GetPropertyValue(Property, ValuePtr);
+		const FTCHARToUTF8 Converted(*Value.Text);
+		sqlite3_result_text(Context, Converted.Get(), Converted.Length(), SQLITE_TRANSIENT);
+	}
+}
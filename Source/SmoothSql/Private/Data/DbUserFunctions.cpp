@@ -0,0 +1,254 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Data/DbUserFunctions.h"
+
+#include "SmoothSql.h"
+#include "Misc/ScopeLock.h"
+
+SmoothSql::TSqlArg<FSqliteValue>::FStorage SmoothSql::TSqlArg<FSqliteValue>::Read(sqlite3_value* Value)
+{
+	FSqliteValue Result;
+	switch (sqlite3_value_type(Value))
+	{
+	case SQLITE_INTEGER:
+		Result.Type = EDbValueType::Integer;
+		Result.Integer = sqlite3_value_int64(Value);
+		break;
+	case SQLITE_FLOAT:
+		Result.Type = EDbValueType::Float;
+		Result.Float = sqlite3_value_double(Value);
+		break;
+	case SQLITE_TEXT:
+		Result.Type = EDbValueType::Text;
+		Result.Text = TSqlArg<FString>::Read(Value);
+		break;
+	case SQLITE_BLOB:
+		Result.Type = EDbValueType::Blob;
+		Result.Blob = TSqlArg<TArray<uint8>>::Read(Value);
+		break;
+	default:
+		break;
+	}
+	return Result;
+}
+
+void SmoothSql::TSqlResult<FSqliteValue>::Write(sqlite3_context* Context, const FSqliteValue& Value)
+{
+	switch (Value.Type)
+	{
+	case EDbValueType::Integer:
+		sqlite3_result_int64(Context, Value.Integer);
+		break;
+	case EDbValueType::Float:
+		sqlite3_result_double(Context, Value.Float);
+		break;
+	case EDbValueType::Text:
+		TSqlResult<FString>::Write(Context, Value.Text);
+		break;
+	case EDbValueType::Blob:
+		TSqlResult<TArray<uint8>>::Write(Context, Value.Blob);
+		break;
+	default:
+		sqlite3_result_null(Context);
+		break;
+	}
+}
+
+namespace SmoothSql
+{
+	namespace UserFunctions
+	{
+		/// App shared by connections, destroyed with the last reference
+		struct FSharedApp
+		{
+			void (*Destroy)(void*);
+			int32 Refs;
+		};
+
+		struct FSharedFunction
+		{
+			FString DbPath;
+			FString Name;
+			FDbUserFunction Function;
+			const void* Owner;
+		};
+
+		struct FRegistry
+		{
+			FCriticalSection Mutex;
+			TMap<void*, FSharedApp> Apps;
+			TArray<FSharedFunction> Functions;
+		};
+
+		FRegistry& GetRegistry()
+		{
+			static FRegistry Registry;
+			return Registry;
+		}
+
+		bool IsShared(const FDbUserFunction& Function)
+		{
+			return Function.App && Function.Destroy;
+		}
+
+		void AddRef(void* App)
+		{
+			FRegistry& Registry = GetRegistry();
+			FScopeLock Lock(&Registry.Mutex);
+			++Registry.Apps.FindChecked(App).Refs;
+		}
+
+		/// xDestroy of every connection, and of the registry entry
+		void ReleaseApp(void* App)
+		{
+			void (*Destroy)(void*) = nullptr;
+			{
+				FRegistry& Registry = GetRegistry();
+				FScopeLock Lock(&Registry.Mutex);
+				FSharedApp& Shared = Registry.Apps.FindChecked(App);
+				if (--Shared.Refs == 0)
+				{
+					Destroy = Shared.Destroy;
+					Registry.Apps.Remove(App);
+				}
+			}
+
+			if (Destroy)
+			{
+				Destroy(App);
+			}
+		}
+
+		/// Reference held by the connection is dropped by sqlite, also when registration fails
+		int CreateFunction(sqlite3* Db, const FString& Name, const FDbUserFunction& Function)
+		{
+			const bool bShared = IsShared(Function);
+			if (bShared)
+			{
+				AddRef(Function.App);
+			}
+
+			return sqlite3_create_function_v2(Db, TCHAR_TO_UTF8(*Name), Function.NumArgs,
+				SQLITE_UTF8 | (Function.bDeterministic ? SQLITE_DETERMINISTIC : 0), Function.App,
+				Function.Func, Function.Step, Function.Final, bShared ? &ReleaseApp : Function.Destroy);
+		}
+	}
+}
+
+int32 SmoothSql::AddSharedFunction(sqlite3* Db, const FString& DbPath, const FString& Name, const FDbUserFunction& Function, const void* Owner)
+{
+	using namespace UserFunctions;
+
+	void* Replaced = nullptr;
+	{
+		FRegistry& Registry = GetRegistry();
+		FScopeLock Lock(&Registry.Mutex);
+
+		const int32 Found = Registry.Functions.IndexOfByPredicate([&](const FSharedFunction& Shared)
+		{
+			return Shared.Function.NumArgs == Function.NumArgs && Shared.Name.Equals(Name, ESearchCase::IgnoreCase) && Shared.DbPath == DbPath;
+		});
+		if (Found != INDEX_NONE)
+		{
+			if (IsShared(Registry.Functions[Found].Function))
+			{
+				Replaced = Registry.Functions[Found].Function.App;
+			}
+			Registry.Functions.RemoveAt(Found);
+		}
+
+		// Registry holds the first reference
+		if (IsShared(Function))
+		{
+			Registry.Apps.Add(Function.App, FSharedApp{Function.Destroy, 1});
+		}
+
+		if (Function.Func || Function.Step)
+		{
+			Registry.Functions.Add(FSharedFunction{DbPath, Name, Function, Owner});
+		}
+	}
+
+	if (Replaced)
+	{
+		ReleaseApp(Replaced);
+	}
+
+	const int Result = CreateFunction(Db, Name, Function);
+
+	// Function that isn't kept nor registered
+	if (IsShared(Function) && !Function.Func && !Function.Step)
+	{
+		ReleaseApp(Function.App);
+	}
+	return Result;
+}
+
+void SmoothSql::RemoveSharedFunctions(const void* Owner)
+{
+	using namespace UserFunctions;
+
+	TArray<void*> Released;
+	{
+		FRegistry& Registry = GetRegistry();
+		FScopeLock Lock(&Registry.Mutex);
+
+		Registry.Functions.RemoveAll([Owner, &Released](const FSharedFunction& Shared)
+		{
+			if (Shared.Owner != Owner)
+			{
+				return false;
+			}
+
+			if (IsShared(Shared.Function))
+			{
+				Released.Add(Shared.Function.App);
+			}
+			return true;
+		});
+	}
+
+	for (void* App : Released)
+	{
+		ReleaseApp(App);
+	}
+}
+
+void SmoothSql::CreateSharedFunctions(sqlite3* Db, const FString& DbPath)
+{
+	using namespace UserFunctions;
+
+	TArray<FSharedFunction> Functions;
+	{
+		FRegistry& Registry = GetRegistry();
+		FScopeLock Lock(&Registry.Mutex);
+
+		for (const FSharedFunction& Shared : Registry.Functions)
+		{
+			if (Shared.DbPath == DbPath)
+			{
+				// Keeps App alive while it's registered outside the lock
+				if (IsShared(Shared.Function))
+				{
+					++Registry.Apps.FindChecked(Shared.Function.App).Refs;
+				}
+				Functions.Add(Shared);
+			}
+		}
+	}
+
+	for (const FSharedFunction& Shared : Functions)
+	{
+		const int Result = CreateFunction(Db, Shared.Name, Shared.Function);
+		if (Result != SQLITE_OK)
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Function \"%s\" can't be registered on new connection to \"%s\": %s", *Shared.Name, *DbPath, UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+		}
+
+		if (IsShared(Shared.Function))
+		{
+			ReleaseApp(Shared.Function.App);
+		}
+	}
+}
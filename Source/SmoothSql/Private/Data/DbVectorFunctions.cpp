@@ -0,0 +1,212 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Data/DbVectorFunctions.h"
+
+#include "sqlite3.h"
+#include "SQLiteCpp/Database.h"
+
+namespace SmoothSql
+{
+	namespace VectorFunctions
+	{
+		/// Floats of blob argument, null if it has other type or size
+		const float* GetFloats(sqlite3_value* Value, int32 Size)
+		{
+			if (sqlite3_value_type(Value) != SQLITE_BLOB || sqlite3_value_bytes(Value) != Size)
+			{
+				return nullptr;
+			}
+			return static_cast<const float*>(sqlite3_value_blob(Value));
+		}
+
+		void ResultFloats(sqlite3_context* Context, const float* Floats, int32 Size)
+		{
+			sqlite3_result_blob(Context, Floats, Size, SQLITE_TRANSIENT);
+		}
+
+		void Vec(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+		{
+			const float Floats[3] = {
+				static_cast<float>(sqlite3_value_double(Args[0])),
+				static_cast<float>(sqlite3_value_double(Args[1])),
+				static_cast<float>(sqlite3_value_double(Args[2]))
+			};
+			ResultFloats(Context, Floats, VectorBlobSize);
+		}
+
+		void Quat(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+		{
+			const float Floats[4] = {
+				static_cast<float>(sqlite3_value_double(Args[0])),
+				static_cast<float>(sqlite3_value_double(Args[1])),
+				static_cast<float>(sqlite3_value_double(Args[2])),
+				static_cast<float>(sqlite3_value_double(Args[3]))
+			};
+			ResultFloats(Context, Floats, QuatBlobSize);
+		}
+
+		void Dist(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+		{
+			const float* A = GetFloats(Args[0], VectorBlobSize);
+			const float* B = GetFloats(Args[1], VectorBlobSize);
+			if (!A || !B)
+			{
+				sqlite3_result_null(Context);
+				return;
+			}
+
+			const auto Delta = VectorSubtract(VectorLoadFloat3_W0(A), VectorLoadFloat3_W0(B));
+			float DistanceSq;
+			VectorStoreFloat1(VectorDot3(Delta, Delta), &DistanceSq);
+			sqlite3_result_double(Context, FMath::Sqrt(DistanceSq));
+		}
+
+		void Dot(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+		{
+			const float* A = GetFloats(Args[0], VectorBlobSize);
+			const float* B = GetFloats(Args[1], VectorBlobSize);
+			if (!A || !B)
+			{
+				sqlite3_result_null(Context);
+				return;
+			}
+
+			float Result;
+			VectorStoreFloat1(VectorDot3(VectorLoadFloat3_W0(A), VectorLoadFloat3_W0(B)), &Result);
+			sqlite3_result_double(Context, Result);
+		}
+
+		void BoxContains(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+		{
+			const float* Min = GetFloats(Args[0], VectorBlobSize);
+			const float* Max = GetFloats(Args[1], VectorBlobSize);
+			const float* Point = GetFloats(Args[2], VectorBlobSize);
+			if (!Min || !Max || !Point)
+			{
+				sqlite3_result_null(Context);
+				return;
+			}
+
+			// W lanes are all zero and never compare greater
+			const auto P = VectorLoadFloat3_W0(Point);
+			const bool bOutside = VectorAnyGreaterThan(VectorLoadFloat3_W0(Min), P) || VectorAnyGreaterThan(P, VectorLoadFloat3_W0(Max));
+			sqlite3_result_int(Context, bOutside ? 0 : 1);
+		}
+
+		void QuatAngle(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+		{
+			const float* A = GetFloats(Args[0], QuatBlobSize);
+			const float* B = GetFloats(Args[1], QuatBlobSize);
+			if (!A || !B)
+			{
+				sqlite3_result_null(Context);
+				return;
+			}
+
+			float Dot;
+			VectorStoreFloat1(VectorDot4(VectorLoad(A), VectorLoad(B)), &Dot);
+
+			// q and -q are the same rotation
+			const float Cos = FMath::Min(FMath::Abs(Dot), 1.f);
+			sqlite3_result_double(Context, FMath::RadiansToDegrees(2.f * FMath::Acos(Cos)));
+		}
+
+		/// Running sum of avg_vec, doubles keep precision over many rows
+		struct FAvgState
+		{
+			double Sum[3];
+			int64 Count;
+		};
+
+		void AvgStep(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+		{
+			const float* V = GetFloats(Args[0], VectorBlobSize);
+			if (!V)
+			{
+				return;
+			}
+
+			// Zeroed by sqlite on first call
+			FAvgState* State = static_cast<FAvgState*>(sqlite3_aggregate_context(Context, sizeof(FAvgState)));
+			if (!State)
+			{
+				sqlite3_result_error_nomem(Context);
+				return;
+			}
+
+			State->Sum[0] += V[0];
+			State->Sum[1] += V[1];
+			State->Sum[2] += V[2];
+			++State->Count;
+		}
+
+		void AvgFinal(sqlite3_context* Context)
+		{
+			const FAvgState* State = static_cast<FAvgState*>(sqlite3_aggregate_context(Context, 0));
+			if (!State || State->Count == 0)
+			{
+				sqlite3_result_null(Context);
+				return;
+			}
+
+			const float Floats[3] = {
+				static_cast<float>(State->Sum[0] / State->Count),
+				static_cast<float>(State->Sum[1] / State->Count),
+				static_cast<float>(State->Sum[2] / State->Count)
+			};
+			ResultFloats(Context, Floats, VectorBlobSize);
+		}
+	}
+}
+
+TArray<uint8> SmoothSql::EncodeVector(const FVector& Vector)
+{
+	const float Floats[3] = { static_cast<float>(Vector.X), static_cast<float>(Vector.Y), static_cast<float>(Vector.Z) };
+	return TArray<uint8>(reinterpret_cast<const uint8*>(Floats), VectorBlobSize);
+}
+
+TArray<uint8> SmoothSql::EncodeQuat(const FQuat& Quat)
+{
+	const float Floats[4] = { static_cast<float>(Quat.X), static_cast<float>(Quat.Y), static_cast<float>(Quat.Z), static_cast<float>(Quat.W) };
+	return TArray<uint8>(reinterpret_cast<const uint8*>(Floats), QuatBlobSize);
+}
+
+bool SmoothSql::DecodeVector(const uint8* Data, int32 Size, FVector& Vector)
+{
+	if (!Data || Size != VectorBlobSize)
+	{
+		return false;
+	}
+
+	float Floats[3];
+	FMemory::Memcpy(Floats, Data, VectorBlobSize);
+	Vector = FVector(Floats[0], Floats[1], Floats[2]);
+	return true;
+}
+
+bool SmoothSql::DecodeQuat(const uint8* Data, int32 Size, FQuat& Quat)
+{
+	if (!Data || Size != QuatBlobSize)
+	{
+		return false;
+	}
+
+	float Floats[4];
+	FMemory::Memcpy(Floats, Data, QuatBlobSize);
+	Quat = FQuat(Floats[0], Floats[1], Floats[2], Floats[3]);
+	return true;
+}
+
+void SmoothSql::RegisterVectorFunctions(SQLite::Database& Db)
+{
+	namespace Functions = SmoothSql::VectorFunctions;
+
+	Db.createFunction("vec", 3, true, nullptr, &Functions::Vec);
+	Db.createFunction("quat", 4, true, nullptr, &Functions::Quat);
+	Db.createFunction("vec_dist", 2, true, nullptr, &Functions::Dist);
+	Db.createFunction("vec_dot", 2, true, nullptr, &Functions::Dot);
+	Db.createFunction("box_contains", 3, true, nullptr, &Functions::BoxContains);
+	Db.createFunction("quat_angle", 2, true, nullptr, &Functions::QuatAngle);
+	Db.createFunction("avg_vec", 1, true, nullptr, nullptr, &Functions::AvgStep, &Functions::AvgFinal);
+}
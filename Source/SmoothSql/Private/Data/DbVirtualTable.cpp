@@ -0,0 +1,338 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Data/DbVirtualTable.h"
+
+#include "Data/DbStructBinding.h"
+#include "Data/DbUserFunctions.h"
+#include "Engine/DataTable.h"
+#include "SmoothSqliteUtils.h"
+#include "sqlite3.h"
+
+namespace SmoothSql
+{
+	namespace VirtualTable
+	{
+		/// idxNum of plans using the key column
+		constexpr int KeyLookup = 1;
+
+		struct FTable : sqlite3_vtab
+		{
+			TSharedPtr<FDbVirtualRows> Rows;
+			TArray<const FProperty*> Columns;		///< Members, after RowName if rows have names
+			int32 FirstMemberColumn = 0;			///< 1 if column 0 is RowName
+			int32 KeyColumn = INDEX_NONE;			///< Column handled by xFilter
+		};
+
+		struct FCursor : sqlite3_vtab_cursor
+		{
+			TArray<const uint8*> Rows;
+			TArray<FName> Names;
+			int32 Index = 0;
+		};
+
+		void SetError(sqlite3_vtab* Table, const char* Message)
+		{
+			sqlite3_free(Table->zErrMsg);
+			Table->zErrMsg = sqlite3_mprintf("%s", Message);
+		}
+
+		int Connect(sqlite3* Db, void* Aux, int Argc, const char* const* Argv, sqlite3_vtab** OutTable, char** OutError)
+		{
+			// argv[2] is the name of the new table
+			const FString Name = UTF8_TO_TCHAR(Argv[2]);
+			const FDbVirtualTableSource* Source = static_cast<const FDbVirtualTableSources*>(Aux)->Find(Name);
+			if (!Source || !Source->Rows.IsValid() || !Source->Rows->GetStruct())
+			{
+				*OutError = sqlite3_mprintf("no rows registered for virtual table \"%s\"", Argv[2]);
+				return SQLITE_ERROR;
+			}
+
+			TUniquePtr<FTable> Table = MakeUnique<FTable>();
+			Table->Rows = Source->Rows;
+
+			FString Schema = L"CREATE TABLE x(";
+			if (Source->Rows->HasRowNames())
+			{
+				Schema += L"RowName TEXT";
+				Table->FirstMemberColumn = 1;
+				if (Source->KeyColumn.IsEmpty() || Source->KeyColumn.Equals(L"RowName", ESearchCase::IgnoreCase))
+				{
+					Table->KeyColumn = 0;
+				}
+			}
+
+			for (TFieldIterator<FProperty> It(Source->Rows->GetStruct()); It; ++It)
+			{
+				if (!IsSupportedProperty(*It) || It->ArrayDim != 1)
+				{
+					continue;
+				}
+
+				const FString ColumnName = It->GetAuthoredName();
+				if (Table->KeyColumn == INDEX_NONE && ColumnName.Equals(Source->KeyColumn, ESearchCase::IgnoreCase))
+				{
+					Table->KeyColumn = Table->FirstMemberColumn + Table->Columns.Num();
+				}
+
+				if (Table->FirstMemberColumn + Table->Columns.Num() > 0)
+				{
+					Schema += L", ";
+				}
+				Schema += FString::Printf(L"%s %s", *QuoteIdentifier(ColumnName), GetColumnType(*It));
+				Table->Columns.Add(*It);
+			}
+			Schema += L")";
+
+			if (Table->FirstMemberColumn + Table->Columns.Num() == 0)
+			{
+				*OutError = sqlite3_mprintf("struct of virtual table \"%s\" has no supported members", Argv[2]);
+				return SQLITE_ERROR;
+			}
+
+			const int Result = sqlite3_declare_vtab(Db, TCHAR_TO_UTF8(*Schema));
+			if (Result != SQLITE_OK)
+			{
+				return Result;
+			}
+
+			*OutTable = Table.Release();
+			return SQLITE_OK;
+		}
+
+		int Disconnect(sqlite3_vtab* Table)
+		{
+			delete static_cast<FTable*>(Table);
+			return SQLITE_OK;
+		}
+
+		int BestIndex(sqlite3_vtab* InTable, sqlite3_index_info* Info)
+		{
+			const FTable* Table = static_cast<FTable*>(InTable);
+
+			for (int Idx = 0; Idx < Info->nConstraint; ++Idx)
+			{
+				const auto& Constraint = Info->aConstraint[Idx];
+				if (!Constraint.usable || Constraint.op != SQLITE_INDEX_CONSTRAINT_EQ || Constraint.iColumn != Table->KeyColumn)
+				{
+					continue;
+				}
+
+				Info->aConstraintUsage[Idx].argvIndex = 1;
+				Info->idxNum = KeyLookup;
+
+				if (Table->KeyColumn == 0 && Table->FirstMemberColumn == 1)
+				{
+					// Row names are unique, sqlite rechecks the name since FName ignores case
+					Info->estimatedCost = 1.0;
+					Info->estimatedRows = 1;
+					Info->idxFlags = SQLITE_INDEX_SCAN_UNIQUE;
+				}
+				else
+				{
+					// Members are compared natively, sqlite still checks the result with its own affinity rules
+					Info->estimatedCost = 100.0;
+					Info->estimatedRows = 10;
+				}
+				return SQLITE_OK;
+			}
+
+			Info->estimatedCost = 1000000.0;
+			return SQLITE_OK;
+		}
+
+		int Open(sqlite3_vtab* Table, sqlite3_vtab_cursor** OutCursor)
+		{
+			*OutCursor = new FCursor();
+			return SQLITE_OK;
+		}
+
+		int Close(sqlite3_vtab_cursor* Cursor)
+		{
+			delete static_cast<FCursor*>(Cursor);
+			return SQLITE_OK;
+		}
+
+		int Filter(sqlite3_vtab_cursor* InCursor, int IdxNum, const char* IdxStr, int Argc, sqlite3_value** Argv)
+		{
+			FCursor* Cursor = static_cast<FCursor*>(InCursor);
+			const FTable* Table = static_cast<FTable*>(Cursor->pVtab);
+
+			if (!IsInGameThread())
+			{
+				SetError(Cursor->pVtab, "virtual tables over engine data can be read only on the game thread");
+				return SQLITE_ERROR;
+			}
+
+			Cursor->Rows.Reset();
+			Cursor->Names.Reset();
+			Cursor->Index = 0;
+
+			if (IdxNum != KeyLookup || Argc < 1)
+			{
+				Table->Rows->GetRows(Cursor->Rows, Cursor->Names);
+				return SQLITE_OK;
+			}
+
+			if (sqlite3_value_type(Argv[0]) == SQLITE_NULL)
+			{
+				// Nothing is equal to NULL
+				return SQLITE_OK;
+			}
+
+			if (Table->KeyColumn < Table->FirstMemberColumn)
+			{
+				// Unknown name is not added to the name table, no row can have it
+				const FName Name(*TSqlArg<FString>::Read(Argv[0]), FNAME_Find);
+				if (Name.IsNone())
+				{
+					return SQLITE_OK;
+				}
+
+				if (const uint8* Row = Table->Rows->FindRow(Name))
+				{
+					Cursor->Rows.Add(Row);
+					Cursor->Names.Add(Name);
+				}
+				return SQLITE_OK;
+			}
+
+			const FProperty* Key = Table->Columns[Table->KeyColumn - Table->FirstMemberColumn];
+			const FSqliteValue Wanted = TSqlArg<FSqliteValue>::Read(Argv[0]);
+
+			// Text compared to a number column is converted by column affinity, leave it to sqlite
+			const bool bTextKey = FCString::Strcmp(GetColumnType(Key), L"TEXT") == 0;
+			if ((Wanted.Type == EDbValueType::Text) != bTextKey)
+			{
+				Table->Rows->GetRows(Cursor->Rows, Cursor->Names);
+				return SQLITE_OK;
+			}
+
+			TArray<const uint8*> Rows;
+			TArray<FName> Names;
+			Table->Rows->GetRows(Rows, Names);
+
+			for (int32 Idx = 0; Idx < Rows.Num(); ++Idx)
+			{
+				if (GetPropertyValue(Key, Key->ContainerPtrToValuePtr<void>(Rows[Idx])).Compare(Wanted) == 0)
+				{
+					Cursor->Rows.Add(Rows[Idx]);
+					if (Names.IsValidIndex(Idx))
+					{
+						Cursor->Names.Add(Names[Idx]);
+					}
+				}
+			}
+			return SQLITE_OK;
+		}
+
+		int Next(sqlite3_vtab_cursor* Cursor)
+		{
+			++static_cast<FCursor*>(Cursor)->Index;
+			return SQLITE_OK;
+		}
+
+		int Eof(sqlite3_vtab_cursor* InCursor)
+		{
+			const FCursor* Cursor = static_cast<FCursor*>(InCursor);
+			return Cursor->Index >= Cursor->Rows.Num();
+		}
+
+		int Column(sqlite3_vtab_cursor* InCursor, sqlite3_context* Context, int Column)
+		{
+			const FCursor* Cursor = static_cast<FCursor*>(InCursor);
+			const FTable* Table = static_cast<FTable*>(Cursor->pVtab);
+
+			if (Column < Table->FirstMemberColumn)
+			{
+				TSqlResult<FName>::Write(Context, Cursor->Names[Cursor->Index]);
+				return SQLITE_OK;
+			}
+
+			const FProperty* Property = Table->Columns[Column - Table->FirstMemberColumn];
+			ResultProperty(Property, Property->ContainerPtrToValuePtr<void>(Cursor->Rows[Cursor->Index]), Context);
+			return SQLITE_OK;
+		}
+
+		int Rowid(sqlite3_vtab_cursor* InCursor, sqlite3_int64* OutRowid)
+		{
+			*OutRowid = static_cast<FCursor*>(InCursor)->Index;
+			return SQLITE_OK;
+		}
+
+		sqlite3_module MakeModule()
+		{
+			sqlite3_module Module = {};
+			Module.iVersion = 1;
+			Module.xCreate = &Connect;
+			Module.xConnect = &Connect;
+			Module.xBestIndex = &BestIndex;
+			Module.xDisconnect = &Disconnect;
+			Module.xDestroy = &Disconnect;
+			Module.xOpen = &Open;
+			Module.xClose = &Close;
+			Module.xFilter = &Filter;
+			Module.xNext = &Next;
+			Module.xEof = &Eof;
+			Module.xColumn = &Column;
+			Module.xRowid = &Rowid;
+			return Module;
+		}
+
+		// Read-only: no xUpdate, writes fail with "table may not be modified"
+		const sqlite3_module Module = MakeModule();
+	}
+}
+
+void SmoothSql::FDbStructArrayRows::GetRows(TArray<const uint8*>& Rows, TArray<FName>& Names) const
+{
+	const int32 Stride = Struct->GetStructureSize();
+	const uint8* Data = static_cast<const uint8*>(Array->GetData());
+
+	Rows.Reserve(Array->Num());
+	for (int32 Idx = 0; Idx < Array->Num(); ++Idx)
+	{
+		Rows.Add(Data + Idx * Stride);
+	}
+}
+
+SmoothSql::FDbDataTableRows::FDbDataTableRows(const UDataTable* InTable)
+	: Table(InTable)
+	, Struct(InTable ? InTable->GetRowStruct() : nullptr)
+{
+}
+
+void SmoothSql::FDbDataTableRows::GetRows(TArray<const uint8*>& Rows, TArray<FName>& Names) const
+{
+	const UDataTable* DataTable = Table.Get();
+	if (!DataTable)
+	{
+		return;
+	}
+
+	const TMap<FName, uint8*>& RowMap = DataTable->GetRowMap();
+	Rows.Reserve(RowMap.Num());
+	Names.Reserve(RowMap.Num());
+	for (const auto& Pair : RowMap)
+	{
+		Names.Add(Pair.Key);
+		Rows.Add(Pair.Value);
+	}
+}
+
+const uint8* SmoothSql::FDbDataTableRows::FindRow(FName Name) const
+{
+	const UDataTable* DataTable = Table.Get();
+	if (!DataTable)
+	{
+		return nullptr;
+	}
+
+	uint8* const* Row = DataTable->GetRowMap().Find(Name);
+	return Row ? *Row : nullptr;
+}
+
+int SmoothSql::RegisterVirtualTableModule(sqlite3* Db, const FDbVirtualTableSources* Sources)
+{
+	return sqlite3_create_module_v2(Db, VirtualTableModule, &VirtualTable::Module, const_cast<FDbVirtualTableSources*>(Sources), nullptr);
+}
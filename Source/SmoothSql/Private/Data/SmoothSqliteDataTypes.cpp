@@ -1,6 +1,203 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 #include "Data/SmoothSqliteDataTypes.h"
 
+#include "SmoothSqliteUtils.h"
+#include "sqlite3.h"
+#include "SQLiteCpp/Statement.h"
+
+
+FSqliteValue FSqliteValue::FromColumn(const SQLite::Column& Column)
+{
+	FSqliteValue Value;
+	switch (Column.getType())
+	{
+	case SQLITE_INTEGER:
+		Value.Type = EDbValueType::Integer;
+		Value.Integer = Column.getInt64();
+		break;
+	case SQLITE_FLOAT:
+		Value.Type = EDbValueType::Float;
+		Value.Float = Column.getDouble();
+		break;
+	case SQLITE_TEXT:
+	{
+		// Bytes are valid only after text was fetched
+		const char* Text = Column.getText();
+		Value.Type = EDbValueType::Text;
+		Value.Text = SmoothSql::Utf8ToString(Text, Column.getBytes());
+		break;
+	}
+	case SQLITE_BLOB:
+		Value.Type = EDbValueType::Blob;
+		Value.Blob.Append(static_cast<const uint8*>(Column.getBlob()), Column.getBytes());
+		break;
+	default:
+		break;
+	}
+
+	return Value;
+}
+
+void FSqliteValue::BindTo(SQLite::Statement& Statement, int32 Index) const
+{
+	switch (Type)
+	{
+	case EDbValueType::Integer:
+		Statement.bind(Index, static_cast<long long>(Integer)); break;
+	case EDbValueType::Float:
+		Statement.bind(Index, Float); break;
+	case EDbValueType::Text:
+	{
+		const FTCHARToUTF8 Converted(*Text);
+		Statement.bind(Index, Converted.Get());
+		break;
+	}
+	case EDbValueType::Blob:
+		Statement.bind(Index, Blob.GetData(), Blob.Num()); break;
+	default:
+		Statement.bind(Index); break;
+	}
+}
+
+bool FSqliteValue::operator==(const FSqliteValue& Other) const
+{
+	if (Type != Other.Type)
+	{
+		return false;
+	}
+
+	switch (Type)
+	{
+	case EDbValueType::Integer:
+		return Integer == Other.Integer;
+	case EDbValueType::Float:
+		return Float == Other.Float;
+	case EDbValueType::Text:
+		return Text.Equals(Other.Text, ESearchCase::CaseSensitive);
+	case EDbValueType::Blob:
+		return Blob == Other.Blob;
+	default:
+		return true;
+	}
+}
+
+uint32 FSqliteValue::GetHash() const
+{
+	switch (Type)
+	{
+	case EDbValueType::Integer:
+		return HashCombine(1, ::GetTypeHash(Integer));
+	case EDbValueType::Float:
+		return HashCombine(2, ::GetTypeHash(Float));
+	case EDbValueType::Text:
+		return HashCombine(3, FCrc::StrCrc32(*Text));
+	case EDbValueType::Blob:
+		return HashCombine(4, FCrc::MemCrc32(Blob.GetData(), Blob.Num()));
+	default:
+		return 0;
+	}
+}
+
+int32 FSqliteValue::Compare(const FSqliteValue& Other) const
+{
+	// Integers and floats compare as numbers
+	auto GetClass = [](EDbValueType ValueType)
+	{
+		return ValueType == EDbValueType::Float ? static_cast<int32>(EDbValueType::Integer) : static_cast<int32>(ValueType);
+	};
+
+	const int32 Class = GetClass(Type);
+	const int32 OtherClass = GetClass(Other.Type);
+	if (Class != OtherClass)
+	{
+		return Class - OtherClass;
+	}
+
+	switch (Type)
+	{
+	case EDbValueType::Integer:
+	case EDbValueType::Float:
+		if (Type == EDbValueType::Integer && Other.Type == EDbValueType::Integer)
+		{
+			return Integer < Other.Integer ? -1 : Integer > Other.Integer ? 1 : 0;
+		}
+		return AsFloat() < Other.AsFloat() ? -1 : AsFloat() > Other.AsFloat() ? 1 : 0;
+	case EDbValueType::Text:
+		return FCString::Strcmp(*Text, *Other.Text);
+	case EDbValueType::Blob:
+	{
+		const int32 Result = FMemory::Memcmp(Blob.GetData(), Other.Blob.GetData(), FMath::Min(Blob.Num(), Other.Blob.Num()));
+		return Result != 0 ? Result : Blob.Num() - Other.Blob.Num();
+	}
+	default:
+		return 0;
+	}
+}
+
+int64 FSqliteValue::AsInteger() const
+{
+	switch (Type)
+	{
+	case EDbValueType::Integer:
+		return Integer;
+	case EDbValueType::Float:
+		return static_cast<int64>(Float);
+	case EDbValueType::Text:
+		return FCString::Atoi64(*Text);
+	default:
+		return 0;
+	}
+}
+
+double FSqliteValue::AsFloat() const
+{
+	switch (Type)
+	{
+	case EDbValueType::Integer:
+		return static_cast<double>(Integer);
+	case EDbValueType::Float:
+		return Float;
+	case EDbValueType::Text:
+		return FCString::Atod(*Text);
+	default:
+		return 0.0;
+	}
+}
+
+FString FSqliteValue::AsString() const
+{
+	switch (Type)
+	{
+	case EDbValueType::Integer:
+		return LexToString(Integer);
+	case EDbValueType::Float:
+		return LexToString(Float);
+	case EDbValueType::Text:
+		return Text;
+	case EDbValueType::Blob:
+	{
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Blob.GetData()), Blob.Num());
+		return FString(Converted.Length(), Converted.Get());
+	}
+	default:
+		return FString();
+	}
+}
+
+FSqliteRow FSqliteRow::FromStatement(SQLite::Statement& Statement)
+{
+	FSqliteRow Row;
+	const int32 Num = Statement.getColumnCount();
+	
+	Row.Values.Reserve(Num);
+	for (int32 Idx = 0; Idx < Num; ++Idx)
+	{
+		Row.Values.Add(FSqliteValue::FromColumn(Statement.getColumn(Idx)));
+	}
+
+	return Row;
+}
+
 
 // FDbConnectionHandle::FDbConnectionHandle(const FSqliteDBConnectionParms& Params)
 // {
@@ -181,3 +378,9 @@
 // {
 // 	return StatementPtr.Get();
 // }
+
+float FDbRetrySettings::GetBackoffSeconds(int32 Retry) const
+{
+	const float Backoff = FMath::Min(MaxBackoffMs, InitialBackoffMs * FMath::Pow(2.f, FMath::Min(Retry, 30)));
+	return FMath::FRandRange(0.f, FMath::Max(Backoff, 0.f)) / 1000.f;
+}
@@ -0,0 +1,587 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbBulkImporter.h"
+
+#include "SmoothSql.h"
+#include "SmoothSqliteUtils.h"
+#include "Data/DbStructBinding.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+#include "Engine/DataTable.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "SQLiteCpp/Database.h"
+#include "SQLiteCpp/Statement.h"
+#include "sqlite3.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace SmoothSql
+{
+	namespace BulkImport
+	{
+		/// Reads CSV records from UTF-8 file in chunks, fields are kept as raw bytes
+		class FCsvReader
+		{
+		public:
+
+			explicit FCsvReader(const FString& Path)
+				: File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path))
+			{
+				Chunk.SetNumUninitialized(ChunkSize);
+			}
+
+			bool IsOpen() const { return File.IsValid(); }
+
+			/**
+			 * @brief Read next record
+			 * @return False at end of file
+			 */
+			bool ReadRecord()
+			{
+				Bytes.Reset();
+				Starts.Reset();
+				Lengths.Reset();
+
+				bool bAny = false;
+				bool bQuoted = false;
+				int32 FieldStart = 0;
+
+				auto EndField = [&]()
+				{
+					Starts.Add(FieldStart);
+					Lengths.Add(Bytes.Num() - FieldStart);
+
+					// Terminated, so numbers can be parsed in place
+					Bytes.Add('\0');
+					FieldStart = Bytes.Num();
+				};
+
+				for (;;)
+				{
+					const int32 Char = NextByte();
+					if (Char < 0)
+					{
+						if (bAny)
+						{
+							EndField();
+						}
+						return bAny;
+					}
+					bAny = true;
+
+					if (bQuoted)
+					{
+						if (Char != '"')
+						{
+							Bytes.Add(static_cast<ANSICHAR>(Char));
+						}
+						else if (PeekByte() == '"')
+						{
+							Bytes.Add('"');
+							NextByte();
+						}
+						else
+						{
+							bQuoted = false;
+						}
+					}
+					else if (Char == '"')
+					{
+						bQuoted = true;
+					}
+					else if (Char == ',')
+					{
+						EndField();
+					}
+					else if (Char == '\n')
+					{
+						EndField();
+						return true;
+					}
+					else if (Char != '\r')
+					{
+						Bytes.Add(static_cast<ANSICHAR>(Char));
+					}
+				}
+			}
+
+			int32 NumFields() const { return Starts.Num(); }
+
+			/// Null-terminated field, valid until next record
+			const ANSICHAR* GetField(int32 Index) const { return Bytes.GetData() + Starts[Index]; }
+			int32 GetFieldLength(int32 Index) const { return Lengths[Index]; }
+
+			/// Line without any characters
+			bool IsBlankRecord() const { return NumFields() == 1 && Lengths[0] == 0; }
+
+		private:
+
+			static constexpr int32 ChunkSize = 1 << 20;
+
+			int32 NextByte()
+			{
+				const int32 Char = PeekByte();
+				if (Char >= 0)
+				{
+					++Position;
+				}
+				return Char;
+			}
+
+			int32 PeekByte()
+			{
+				if (Position == Filled && !Fill())
+				{
+					return -1;
+				}
+				return static_cast<uint8>(Chunk[Position]);
+			}
+
+			bool Fill()
+			{
+				const int64 Left = File->Size() - File->Tell();
+				if (Left <= 0)
+				{
+					return false;
+				}
+
+				Filled = static_cast<int32>(FMath::Min<int64>(Left, ChunkSize));
+				if (!File->Read(reinterpret_cast<uint8*>(Chunk.GetData()), Filled))
+				{
+					Filled = 0;
+					return false;
+				}
+				Position = 0;
+
+				// UTF-8 BOM
+				if (bFirstChunk && Filled >= 3 && FMemory::Memcmp(Chunk.GetData(), "\xEF\xBB\xBF", 3) == 0)
+				{
+					Position = 3;
+				}
+				bFirstChunk = false;
+				return Position < Filled;
+			}
+
+			TUniquePtr<IFileHandle> File;
+			TArray<ANSICHAR> Chunk;
+			int32 Position = 0;
+			int32 Filled = 0;
+			bool bFirstChunk = true;
+
+			TArray<ANSICHAR> Bytes;		///< Unescaped fields of the record
+			TArray<int32> Starts;
+			TArray<int32> Lengths;
+		};
+
+		/// Declared type of column with this value in the first row
+		const TCHAR* GuessType(const ANSICHAR* Field, int32 Length)
+		{
+			if (Length == 0)
+			{
+				return L"";
+			}
+
+			char* End = nullptr;
+			errno = 0;
+			std::strtoll(Field, &End, 10);
+			if (End == Field + Length && errno == 0)
+			{
+				return L"INTEGER";
+			}
+
+			std::strtod(Field, &End);
+			const bool bNumberLike = FCharAnsi::IsDigit(Field[0]) || Field[0] == '-' || Field[0] == '+' || Field[0] == '.';
+			if (End == Field + Length && bNumberLike)
+			{
+				return L"REAL";
+			}
+			return L"TEXT";
+		}
+
+		const TCHAR* GuessType(const TSharedPtr<FJsonValue>& Value)
+		{
+			switch (Value->Type)
+			{
+			case EJson::Number:
+			{
+				const double Number = Value->AsNumber();
+				return Number == FMath::FloorToDouble(Number) ? L"INTEGER" : L"REAL";
+			}
+			case EJson::Boolean:
+				return L"INTEGER";
+			case EJson::Null:
+			case EJson::None:
+				return L"";
+			default:
+				return L"TEXT";
+			}
+		}
+
+		void BindJson(sqlite3_stmt* Stmt, int32 Param, const TSharedPtr<FJsonValue>& Value)
+		{
+			if (!Value.IsValid())
+			{
+				sqlite3_bind_null(Stmt, Param);
+				return;
+			}
+
+			switch (Value->Type)
+			{
+			case EJson::Number:
+			{
+				// Integers above 2^53 are not exact in double anyway
+				const double Number = Value->AsNumber();
+				if (Number == FMath::FloorToDouble(Number) && FMath::Abs(Number) < 9007199254740992.0)
+					sqlite3_bind_int64(Stmt, Param, static_cast<sqlite3_int64>(Number));
+				else
+					sqlite3_bind_double(Stmt, Param, Number);
+				break;
+			}
+			case EJson::Boolean:
+				sqlite3_bind_int(Stmt, Param, Value->AsBool() ? 1 : 0);
+				break;
+			case EJson::String:
+				BindText(Stmt, Param, Value->AsString());
+				break;
+			case EJson::Array:
+			{
+				FString Text;
+				FJsonSerializer::Serialize(Value->AsArray(), TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Text));
+				BindText(Stmt, Param, Text);
+				break;
+			}
+			case EJson::Object:
+			{
+				FString Text;
+				FJsonSerializer::Serialize(Value->AsObject().ToSharedRef(), TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Text));
+				BindText(Stmt, Param, Text);
+				break;
+			}
+			default:
+				sqlite3_bind_null(Stmt, Param);
+				break;
+			}
+		}
+	}
+}
+
+FDbBulkImporter::FDbBulkImporter(SQLite::Database& InDb, const FDbImportSettings& InSettings)
+	: Db(InDb)
+	, Settings(InSettings)
+{
+	Settings.RowsPerTransaction = FMath::Max(1, Settings.RowsPerTransaction);
+}
+
+FDbBulkImporter::~FDbBulkImporter()
+{
+	Cleanup();
+}
+
+FDbImportResult FDbBulkImporter::ImportDataTable(const UDataTable* Table)
+{
+	return Run([this, Table]()
+	{
+		if (!IsValid(Table) || !Table->GetRowStruct())
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" failed, DataTable is not valid", *Settings.Table);
+			return false;
+		}
+
+		TArray<const FProperty*> Properties;
+		TArray<FColumn> Columns;
+		Columns.Add({ L"RowName", L"TEXT" });
+		for (TFieldIterator<FProperty> It(Table->GetRowStruct()); It; ++It)
+		{
+			if (!SmoothSql::IsSupportedProperty(*It) || It->ArrayDim != 1)
+			{
+				UE_LOG(LogSmoothSqlite, Warning, L"Member \"%s\" of \"%s\" has unsupported type %s, skipped", *It->GetAuthoredName(), *Table->GetRowStruct()->GetName(), *It->GetCPPType());
+				continue;
+			}
+
+			Columns.Add({ It->GetAuthoredName(), SmoothSql::GetColumnType(*It) });
+			Properties.Add(*It);
+		}
+
+		Begin(Columns);
+
+		for (const auto& Row : Table->GetRowMap())
+		{
+			SmoothSql::BindText(Stmt, 1, Row.Key.ToString());
+			for (int32 Idx = 0; Idx < Properties.Num(); ++Idx)
+			{
+				SmoothSql::BindProperty(Properties[Idx], Properties[Idx]->ContainerPtrToValuePtr<void>(Row.Value), Stmt, Idx + 2);
+			}
+			InsertRow();
+		}
+		return true;
+	});
+}
+
+FDbImportResult FDbBulkImporter::ImportCsv(const FString& Path)
+{
+	return Run([this, &Path]()
+	{
+		SmoothSql::BulkImport::FCsvReader Reader(Path);
+		if (!Reader.IsOpen())
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" failed, can't open \"%s\"", *Settings.Table, *Path);
+			return false;
+		}
+
+		if (!Reader.ReadRecord())
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" failed, \"%s\" has no header", *Settings.Table, *Path);
+			return false;
+		}
+
+		TArray<FColumn> Columns;
+		for (int32 Idx = 0; Idx < Reader.NumFields(); ++Idx)
+		{
+			const FUTF8ToTCHAR Name(Reader.GetField(Idx), Reader.GetFieldLength(Idx));
+			Columns.Add({ FString(Name.Length(), Name.Get()), L"" });
+		}
+
+		bool bHasRow = Reader.ReadRecord();
+		while (bHasRow && Reader.IsBlankRecord())
+		{
+			bHasRow = Reader.ReadRecord();
+		}
+
+		if (bHasRow)
+		{
+			for (int32 Idx = 0; Idx < Columns.Num() && Idx < Reader.NumFields(); ++Idx)
+			{
+				Columns[Idx].Type = SmoothSql::BulkImport::GuessType(Reader.GetField(Idx), Reader.GetFieldLength(Idx));
+			}
+		}
+
+		Begin(Columns);
+
+		for (; bHasRow; bHasRow = Reader.ReadRecord())
+		{
+			if (Reader.IsBlankRecord())
+			{
+				continue;
+			}
+
+			// Text goes in as is, column affinity turns numbers into numbers
+			for (int32 Idx = 0; Idx < Columns.Num(); ++Idx)
+			{
+				if (Idx < Reader.NumFields() && Reader.GetFieldLength(Idx) > 0)
+					sqlite3_bind_text(Stmt, Idx + 1, Reader.GetField(Idx), Reader.GetFieldLength(Idx), SQLITE_STATIC);
+				else
+					sqlite3_bind_null(Stmt, Idx + 1);
+			}
+			InsertRow();
+		}
+		return true;
+	});
+}
+
+FDbImportResult FDbBulkImporter::ImportJson(const FString& Path)
+{
+	return Run([this, &Path]()
+	{
+		FString Text;
+		if (!FFileHelper::LoadFileToString(Text, *Path))
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" failed, can't open \"%s\"", *Settings.Table, *Path);
+			return false;
+		}
+
+		TArray<TSharedPtr<FJsonValue>> Objects;
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Objects))
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" failed, \"%s\" is not a JSON array", *Settings.Table, *Path);
+			return false;
+		}
+		Text.Empty();
+
+		const TSharedPtr<FJsonObject>* First = nullptr;
+		if (Objects.Num() == 0 || !Objects[0]->TryGetObject(First))
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" failed, \"%s\" has no objects", *Settings.Table, *Path);
+			return false;
+		}
+
+		TArray<FColumn> Columns;
+		for (const auto& Field : (*First)->Values)
+		{
+			Columns.Add({ Field.Key, SmoothSql::BulkImport::GuessType(Field.Value) });
+		}
+
+		Begin(Columns);
+
+		for (const TSharedPtr<FJsonValue>& Value : Objects)
+		{
+			const TSharedPtr<FJsonObject>* Object = nullptr;
+			if (!Value->TryGetObject(Object))
+			{
+				continue;
+			}
+
+			for (int32 Idx = 0; Idx < Columns.Num(); ++Idx)
+			{
+				SmoothSql::BulkImport::BindJson(Stmt, Idx + 1, (*Object)->TryGetField(Columns[Idx].Name));
+			}
+			InsertRow();
+		}
+		return true;
+	});
+}
+
+FDbImportResult FDbBulkImporter::Run(TFunctionRef<bool()> Body)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	FDbImportResult Result;
+	try
+	{
+		if (Body())
+		{
+			Finish();
+			Result.bSuccess = true;
+		}
+	}
+	catch (const SQLite::Exception& Ex)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" failed after %lld rows: %s", *Settings.Table, Rows, UTF8_TO_TCHAR(Ex.what()));
+	}
+	Cleanup();
+
+	Result.Rows = CommittedRows;
+	Result.Seconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+	Result.RowsPerSecond = Result.Seconds > 0.f ? Result.Rows / Result.Seconds : 0.f;
+
+	if (Result.bSuccess)
+	{
+		UE_LOG(LogSmoothSqlite, Log, L"Imported %lld rows into \"%s\" in %.2f s (%.0f rows/s)", Result.Rows, *Settings.Table, Result.Seconds, Result.RowsPerSecond);
+	}
+	return Result;
+}
+
+void FDbBulkImporter::Begin(const TArray<FColumn>& Columns)
+{
+	bOwnTransaction = sqlite3_get_autocommit(Db.getHandle()) != 0;
+
+	if (bOwnTransaction && Settings.bFastLoad)
+	{
+		OldSynchronous = Db.execAndGet("PRAGMA synchronous").getInt();
+		Db.exec("PRAGMA synchronous=OFF");
+	}
+
+	if (bOwnTransaction)
+	{
+		Db.exec("BEGIN IMMEDIATE");
+		bInTransaction = true;
+	}
+
+	const FString Table = SmoothSql::QuoteIdentifier(Settings.Table);
+	if (Settings.bReplaceTable)
+	{
+		Db.exec(TCHAR_TO_UTF8(*(L"DROP TABLE IF EXISTS " + Table)));
+	}
+
+	TArray<FString> Definitions;
+	TArray<FString> Params;
+	for (const FColumn& Column : Columns)
+	{
+		FString Definition = SmoothSql::QuoteIdentifier(Column.Name);
+		if (*Column.Type)
+		{
+			Definition += L" ";
+			Definition += Column.Type;
+		}
+		if (!Settings.PrimaryKey.IsEmpty() && Column.Name.Equals(Settings.PrimaryKey, ESearchCase::IgnoreCase))
+		{
+			Definition += L" PRIMARY KEY";
+		}
+		Definitions.Add(MoveTemp(Definition));
+		Params.Add(L"?");
+	}
+
+	Db.exec(TCHAR_TO_UTF8(*FString::Printf(L"CREATE TABLE %s (%s)", *Table, *FString::Join(Definitions, L", "))));
+
+	Insert = MakeUnique<SQLite::Statement>(Db, TCHAR_TO_UTF8(*FString::Printf(L"INSERT INTO %s VALUES (%s)", *Table, *FString::Join(Params, L", "))));
+	Stmt = Insert->getStatementHandle();
+}
+
+void FDbBulkImporter::InsertRow()
+{
+	const int Result = sqlite3_step(Stmt);
+	sqlite3_reset(Stmt);
+	if (Result != SQLITE_DONE)
+	{
+		throw SQLite::Exception(Db.getHandle(), Result);
+	}
+	++Rows;
+
+	if (bOwnTransaction && ++RowsInBatch >= Settings.RowsPerTransaction)
+	{
+		Db.exec("COMMIT");
+		CommittedRows = Rows;
+		RowsInBatch = 0;
+		Db.exec("BEGIN IMMEDIATE");
+	}
+}
+
+void FDbBulkImporter::Finish()
+{
+	Insert.Reset();
+	Stmt = nullptr;
+
+	if (bInTransaction)
+	{
+		Db.exec("COMMIT");
+		bInTransaction = false;
+	}
+	CommittedRows = Rows;
+
+	// Building index over loaded rows is faster than updating it on every insert
+	for (const FString& Index : Settings.Indexes)
+	{
+		TArray<FString> IndexColumns;
+		Index.ParseIntoArray(IndexColumns, L",");
+
+		FString Name = Settings.Table + L"_idx";
+		for (FString& Column : IndexColumns)
+		{
+			Column.TrimStartAndEndInline();
+			Name += L"_" + Column;
+			Column = SmoothSql::QuoteIdentifier(Column);
+		}
+
+		Db.exec(TCHAR_TO_UTF8(*FString::Printf(L"CREATE INDEX IF NOT EXISTS %s ON %s (%s)",
+			*SmoothSql::QuoteIdentifier(Name), *SmoothSql::QuoteIdentifier(Settings.Table), *FString::Join(IndexColumns, L", "))));
+	}
+}
+
+void FDbBulkImporter::Cleanup()
+{
+	Insert.Reset();
+	Stmt = nullptr;
+
+	try
+	{
+		if (bInTransaction)
+		{
+			bInTransaction = false;
+			Db.exec("ROLLBACK");
+		}
+
+		if (OldSynchronous != INDEX_NONE)
+		{
+			Db.exec(std::string("PRAGMA synchronous=") + std::to_string(OldSynchronous));
+			OldSynchronous = INDEX_NONE;
+		}
+	}
+	catch (const SQLite::Exception& Ex)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Import into \"%s\" can't restore connection: %s", *Settings.Table, UTF8_TO_TCHAR(Ex.what()));
+	}
+}
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbGroupCommitWriter.h"
+
+#include "SmoothSql.h"
+#include "SmoothSqliteUtils.h"
+#include "HAL/Event.h"
+#include "HAL/RunnableThread.h"
+#include "SQLiteCpp/Database.h"
+#include "SQLiteCpp/Transaction.h"
+
+FDbGroupCommitWriter::FDbGroupCommitWriter(TUniquePtr<SQLite::Database> InDb, const FDbGroupCommitSettings& InSettings, const FString& InName):
+	Db(MoveTemp(InDb)),
+	Settings(InSettings),
+	Name(InName)
+{
+	Settings.WindowMicroseconds = FMath::Max(Settings.WindowMicroseconds, 0);
+	Settings.MaxWritesPerCommit = FMath::Max(Settings.MaxWritesPerCommit, 1);
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, *FString::Printf(L"SmoothSqlGroupCommit_%s", *Name));
+}
+
+FDbGroupCommitWriter::~FDbGroupCommitWriter()
+{
+	if (Thread)
+	{
+		// Pending writes are committed before thread exits
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	// Writes that raced with shutdown
+	FPendingWrite Write;
+	while (Queue.Dequeue(Write))
+	{
+		Write.Promise.SetValue(FDbWriteResult());
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+TFuture<FDbWriteResult> FDbGroupCommitWriter::Submit(FWriteOp Op)
+{
+	FPendingWrite Write;
+	Write.Op = MoveTemp(Op);
+	TFuture<FDbWriteResult> Future = Write.Promise.GetFuture();
+
+	if (bStopping)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Write submitted to stopped group commit writer of \"%s\"", *Name);
+		Write.Promise.SetValue(FDbWriteResult());
+		return Future;
+	}
+
+	Queue.Enqueue(MoveTemp(Write));
+	++NumPending;
+	WakeEvent->Trigger();
+
+	return Future;
+}
+
+TFuture<FDbWriteResult> FDbGroupCommitWriter::Submit(const FString& SQL)
+{
+	return Submit([cSQL = std::string(TCHAR_TO_UTF8(*SQL))](SQLite::Database& Database)
+	{
+		return Database.exec(cSQL);
+	});
+}
+
+uint32 FDbGroupCommitWriter::Run()
+{
+	TArray<FPendingWrite> Batch;
+
+	while (true)
+	{
+		if (NumPending == 0)
+		{
+			if (bStopping)
+				break;
+
+			WakeEvent->Wait(100);
+			continue;
+		}
+
+		// Give other submitters a chance to join this batch
+		const double Deadline = FPlatformTime::Seconds() + Settings.WindowMicroseconds / 1000000.0;
+		while (!bStopping && NumPending < Settings.MaxWritesPerCommit)
+		{
+			const double Remaining = Deadline - FPlatformTime::Seconds();
+			if (Remaining <= 0.0)
+				break;
+
+			if (Remaining >= 0.001)
+				WakeEvent->Wait(static_cast<uint32>(Remaining * 1000.0));
+			else
+				FPlatformProcess::SleepNoStats(0.f);
+		}
+
+		FPendingWrite Write;
+		while (Batch.Num() < Settings.MaxWritesPerCommit && Queue.Dequeue(Write))
+		{
+			--NumPending;
+			Batch.Add(MoveTemp(Write));
+		}
+
+		CommitBatch(Batch);
+		Batch.Reset();
+	}
+
+	return 0;
+}
+
+void FDbGroupCommitWriter::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+void FDbGroupCommitWriter::CommitBatch(TArray<FPendingWrite>& Batch)
+{
+	TArray<FDbWriteResult> Results;
+	bool bCommitted = false;
+
+	// Writes are only committed together, so whole batch can be re-run if another connection holds the lock
+	const FDbRetrySettings& Retry = Settings.Retry;
+	const int32 MaxAttempts = FMath::Max(Retry.MaxAttempts, 1);
+	for (int32 Attempt = 0; Attempt < MaxAttempts && !bCommitted; ++Attempt)
+	{
+		if (Attempt > 0)
+		{
+			FPlatformProcess::Sleep(Retry.GetBackoffSeconds(Attempt - 1));
+		}
+
+		Results.Reset();
+		Results.SetNum(Batch.Num());
+		
+		try
+		{
+			SQLite::Transaction Transaction(*Db, SQLite::TransactionBehavior::IMMEDIATE);
+
+			for (int32 Idx = 0; Idx < Batch.Num(); ++Idx)
+			{
+				try
+				{
+					Db->exec("SAVEPOINT smoothsql_group_write");
+					Results[Idx].Changes = Batch[Idx].Op(*Db);
+					Db->exec("RELEASE smoothsql_group_write");
+					Results[Idx].bSuccess = true;
+				}
+				catch (SQLite::Exception& e)
+				{
+					if (SmoothSql::IsBusyError(e.getErrorCode()))
+					{
+						throw;
+					}
+					
+					UE_LOG(LogSmoothSqlite, Error, L"Group write to \"%s\" failed: %s", *Name, UTF8_TO_TCHAR(e.getErrorStr()));
+					Db->tryExec("ROLLBACK TO smoothsql_group_write");
+					Db->tryExec("RELEASE smoothsql_group_write");
+				}
+			}
+
+			Transaction.commit();
+			bCommitted = true;
+		}
+		catch (SQLite::Exception& e)
+		{
+			const bool bBusy = SmoothSql::IsBusyError(e.getErrorCode());
+			UE_LOG(LogSmoothSqlite, Error, L"Group commit of %d writes to \"%s\" failed%s: %s", Batch.Num(), *Name,
+				bBusy ? L", retrying" : L"", UTF8_TO_TCHAR(e.getErrorStr()));
+			
+			if (!bBusy)
+			{
+				break;
+			}
+		}
+	}
+
+	for (int32 Idx = 0; Idx < Batch.Num(); ++Idx)
+	{
+		if (!bCommitted)
+		{
+			Results[Idx] = FDbWriteResult();
+		}
+
+		Batch[Idx].Promise.SetValue(Results[Idx]);
+	}
+}
@@ -0,0 +1,322 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbIndexAdvisor.h"
+
+#include "SmoothSql.h"
+#include "SmoothSqliteUtils.h"
+#include "Data/DbUserFunctions.h"
+#include "Data/DbVectorFunctions.h"
+#include "HAL/FileManager.h"
+#include "Misc/ScopeExit.h"
+#include "SQLiteCpp/Database.h"
+#include "SQLiteCpp/Statement.h"
+#include "sqlite3.h"
+
+namespace SmoothSql
+{
+	namespace IndexAdvisor
+	{
+		bool IsIdentifierChar(TCHAR Char)
+		{
+			return FChar::IsAlnum(Char) || Char == L'_';
+		}
+
+		FString MakeIndexName(const FString& Table, const TArray<FString>& Columns)
+		{
+			FString Name = L"idx_" + Table;
+			for (const FString& Column : Columns)
+			{
+				Name += L"_" + Column;
+			}
+
+			for (TCHAR& Char : Name)
+			{
+				if (!IsIdentifierChar(Char))
+				{
+					Char = L'_';
+				}
+			}
+			return Name;
+		}
+
+		/// Plan lines of the query, throws SQLite::Exception
+		TArray<FString> ExplainQueryPlan(SQLite::Database& Db, const FString& Query)
+		{
+			TArray<FString> Lines;
+			SQLite::Statement Explain(Db, std::string("EXPLAIN QUERY PLAN ") + TCHAR_TO_UTF8(*Query));
+			while (Explain.executeStep())
+			{
+				Lines.Add(UTF8_TO_TCHAR(Explain.getColumn(3).getText()));
+			}
+			return Lines;
+		}
+
+		/// Columns of the table compared in query text, equality comparisons first and at most one range last
+		TArray<FString> GuessColumns(SQLite::Database& Db, const FString& Table, const FString& Query)
+		{
+			TArray<FString> Equal;
+			TArray<FString> Range;
+
+			SQLite::Statement Info(Db, "SELECT name FROM pragma_table_info(?)");
+			Info.bind(1, TCHAR_TO_UTF8(*Table));
+			while (Info.executeStep())
+			{
+				const FString Column = UTF8_TO_TCHAR(Info.getColumn(0).getText());
+
+				for (int32 Pos = Query.Find(Column, ESearchCase::IgnoreCase); Pos != INDEX_NONE;
+					Pos = Query.Find(Column, ESearchCase::IgnoreCase, ESearchDir::FromStart, Pos + 1))
+				{
+					// Whole word only, table prefix and quotes are fine
+					int32 End = Pos + Column.Len();
+					if ((Pos > 0 && IsIdentifierChar(Query[Pos - 1])) || (End < Query.Len() && IsIdentifierChar(Query[End])))
+					{
+						continue;
+					}
+
+					while (End < Query.Len() && (FChar::IsWhitespace(Query[End]) || Query[End] == L'"' || Query[End] == L'`' || Query[End] == L']'))
+					{
+						++End;
+					}
+
+					const FString Rest = Query.Mid(End, 8);
+					if ((Rest.StartsWith(L"=") || Rest.StartsWith(L"IN ") || Rest.StartsWith(L"IN(") || Rest.StartsWith(L"IS ")) && !Rest.StartsWith(L"IS NOT"))
+					{
+						Equal.AddUnique(Column);
+						break;
+					}
+
+					if ((Rest.StartsWith(L"<") && !Rest.StartsWith(L"<>")) || Rest.StartsWith(L">") || Rest.StartsWith(L"BETWEEN "))
+					{
+						Range.AddUnique(Column);
+						break;
+					}
+				}
+			}
+
+			// Index can't be used past the first range column
+			if (Range.Num() > 0)
+			{
+				Range.RemoveAll([&Equal](const FString& Column) { return Equal.Contains(Column); });
+				if (Range.Num() > 0)
+				{
+					Equal.Add(Range[0]);
+				}
+			}
+			return Equal;
+		}
+
+		/// Columns of "(a=? AND b>?)" at the end of automatic index plan line
+		TArray<FString> ParseAutomaticIndex(const FString& Line)
+		{
+			TArray<FString> Columns;
+
+			int32 Open = INDEX_NONE;
+			int32 Close = INDEX_NONE;
+			if (!Line.FindLastChar(L'(', Open) || !Line.FindLastChar(L')', Close) || Close < Open)
+			{
+				return Columns;
+			}
+
+			TArray<FString> Terms;
+			Line.Mid(Open + 1, Close - Open - 1).ParseIntoArray(Terms, L" AND ");
+			for (const FString& Term : Terms)
+			{
+				int32 Len = 0;
+				while (Len < Term.Len() && IsIdentifierChar(Term[Len]))
+				{
+					++Len;
+				}
+
+				if (Len > 0)
+				{
+					Columns.Add(Term.Left(Len));
+				}
+			}
+			return Columns;
+		}
+	}
+}
+
+FDbIndexAdvisor::FDbIndexAdvisor(const FDbIndexAdvisorSettings& InSettings)
+	: Settings(InSettings)
+{
+}
+
+void FDbIndexAdvisor::Record(sqlite3_stmt* Stmt)
+{
+	// Counters are reset, so the next run starts from zero
+	const int FullScanSteps = sqlite3_stmt_status(Stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+	const int AutoIndexes = sqlite3_stmt_status(Stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+	if (FullScanSteps == 0 && AutoIndexes == 0)
+	{
+		return;
+	}
+
+	const FString SQL = UTF8_TO_TCHAR(sqlite3_sql(Stmt));
+
+	FScopeLock Lock(&Mutex);
+
+	FStatementStats* Stats = Statements.Find(SQL);
+	if (!Stats)
+	{
+		if (Statements.Num() >= Settings.MaxStatements)
+		{
+			return;
+		}
+		Stats = &Statements.Add(SQL);
+	}
+
+	++Stats->Runs;
+	Stats->FullScanSteps += FullScanSteps;
+	Stats->AutoIndexes += AutoIndexes;
+
+	if (Stats->SampleQuery.IsEmpty())
+	{
+		if (char* Expanded = sqlite3_expanded_sql(Stmt))
+		{
+			Stats->SampleQuery = UTF8_TO_TCHAR(Expanded);
+			sqlite3_free(Expanded);
+		}
+	}
+}
+
+void FDbIndexAdvisor::GetAdvice(SQLite::Database& Db, TArray<FDbIndexAdvice>& OutAdvice) const
+{
+	namespace Advisor = SmoothSql::IndexAdvisor;
+
+	OutAdvice.Reset();
+
+	TArray<TPair<FString, FStatementStats>> Offenders;
+	{
+		FScopeLock Lock(&Mutex);
+		for (const auto& Statement : Statements)
+		{
+			if (Statement.Value.FullScanSteps >= Settings.MinFullScanSteps || Statement.Value.AutoIndexes > 0)
+			{
+				Offenders.Emplace(Statement.Key, Statement.Value);
+			}
+		}
+	}
+
+	Offenders.Sort([](const TPair<FString, FStatementStats>& A, const TPair<FString, FStatementStats>& B)
+	{
+		return A.Value.FullScanSteps > B.Value.FullScanSteps;
+	});
+
+	for (const auto& Offender : Offenders)
+	{
+		const TArray<FString> Plan = Advisor::ExplainQueryPlan(Db, Offender.Key);
+
+		for (const FString& Line : Plan)
+		{
+			TArray<FString> Words;
+			Line.ParseIntoArrayWS(Words);
+			if (Words.Num() < 2 || (Words[0] != L"SCAN" && Words[0] != L"SEARCH"))
+			{
+				continue;
+			}
+
+			// Older sqlite says "SCAN TABLE t"
+			const FString& Table = Words[1] == L"TABLE" && Words.Num() > 2 ? Words[2] : Words[1];
+
+			TArray<FString> Columns;
+			if (Line.Contains(L"AUTOMATIC"))
+			{
+				Columns = Advisor::ParseAutomaticIndex(Line);
+			}
+			else if (Words[0] == L"SCAN" && !Line.Contains(L" USING ") && !Line.Contains(L"VIRTUAL TABLE") && Advisor::IsIdentifierChar(Table[0]))
+			{
+				Columns = Advisor::GuessColumns(Db, Table, Offender.Key);
+			}
+
+			if (Columns.Num() == 0)
+			{
+				continue;
+			}
+
+			const bool bDuplicate = OutAdvice.ContainsByPredicate([&Table, &Columns](const FDbIndexAdvice& Advice)
+			{
+				return Advice.Table == Table && Advice.Columns == Columns;
+			});
+			if (bDuplicate)
+			{
+				continue;
+			}
+
+			TArray<FString> Quoted;
+			for (const FString& Column : Columns)
+			{
+				Quoted.Add(SmoothSql::QuoteIdentifier(Column));
+			}
+
+			FDbIndexAdvice& Advice = OutAdvice.AddDefaulted_GetRef();
+			Advice.Table = Table;
+			Advice.Columns = Columns;
+			Advice.CreateSQL = FString::Printf(L"CREATE INDEX IF NOT EXISTS %s ON %s (%s)",
+				*SmoothSql::QuoteIdentifier(Advisor::MakeIndexName(Table, Columns)), *SmoothSql::QuoteIdentifier(Table), *FString::Join(Quoted, L", "));
+			Advice.Query = Offender.Key;
+			Advice.SampleQuery = Offender.Value.SampleQuery;
+			Advice.Plan = FString::Join(Plan, L"\n");
+			Advice.Runs = Offender.Value.Runs;
+			Advice.FullScanSteps = Offender.Value.FullScanSteps;
+			Advice.AutoIndexes = Offender.Value.AutoIndexes;
+		}
+	}
+}
+
+void FDbIndexAdvisor::Benchmark(SQLite::Database& Db, const FString& DbPath, FDbIndexAdvice& Advice, int32 Runs, const FString& ScratchPath)
+{
+	namespace Advisor = SmoothSql::IndexAdvisor;
+
+	Runs = FMath::Max(1, Runs);
+	const FString Query = Advice.SampleQuery.IsEmpty() ? Advice.Query : Advice.SampleQuery;
+
+	Db.backup(TCHAR_TO_UTF8(*ScratchPath), SQLite::Database::BackupType::Save);
+	ON_SCOPE_EXIT
+	{
+		IFileManager::Get().Delete(*ScratchPath, false, true, true);
+	};
+
+	SQLite::Database Scratch(TCHAR_TO_UTF8(*ScratchPath), SQLite::OPEN_READWRITE);
+	SmoothSql::RegisterVectorFunctions(Scratch);
+	SmoothSql::CreateSharedFunctions(Scratch.getHandle(), DbPath);
+
+	// Writes are rolled back, so every run sees the same rows
+	auto TimeQuery = [&Scratch, &Query, Runs]()
+	{
+		const std::string SQL = TCHAR_TO_UTF8(*Query);
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Run = 0; Run < Runs; ++Run)
+		{
+			Scratch.exec("BEGIN");
+			{
+				SQLite::Statement Statement(Scratch, SQL);
+				while (Statement.executeStep()) {}
+			}
+			Scratch.exec("ROLLBACK");
+		}
+		return static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0 / Runs);
+	};
+
+	// Both sides are planned with the same table statistics, only the new index differs
+	Scratch.exec("ANALYZE");
+	Advice.MillisecondsBefore = TimeQuery();
+
+	const FString IndexName = Advisor::MakeIndexName(Advice.Table, Advice.Columns);
+	Scratch.exec(TCHAR_TO_UTF8(*Advice.CreateSQL));
+	Scratch.exec(std::string("ANALYZE ") + TCHAR_TO_UTF8(*SmoothSql::QuoteIdentifier(IndexName)));
+
+	Advice.MillisecondsAfter = TimeQuery();
+
+	Advice.bUsedByPlanner = Advisor::ExplainQueryPlan(Scratch, Query).ContainsByPredicate([&IndexName](const FString& Line)
+	{
+		return Line.Contains(IndexName);
+	});
+}
+
+void FDbIndexAdvisor::Reset()
+{
+	FScopeLock Lock(&Mutex);
+	Statements.Empty();
+}
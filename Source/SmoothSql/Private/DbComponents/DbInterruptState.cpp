@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbInterruptState.h"
+
+int FDbInterruptState::ProgressHandler(void* Ptr)
+{
+	auto State = static_cast<FDbInterruptState*>(Ptr);
+
+	if (State->bCancelRequested.exchange(false))
+	{
+		State->Reason = EDbInterruptReason::Cancelled;
+		return 1;
+	}
+
+	const double Deadline = State->Deadline.load(std::memory_order_relaxed);
+	if (Deadline > 0.0 && FPlatformTime::Seconds() > Deadline)
+	{
+		State->Reason = EDbInterruptReason::TimedOut;
+		return 1;
+	}
+
+	return 0;
+}
+
+FDbInterruptScope::FDbInterruptScope(FDbInterruptState* InState, float BudgetMs):
+	State(InState)
+{
+	if (State)
+	{
+		State->Reason = EDbInterruptReason::None;
+		State->Deadline = BudgetMs > 0.f ? FPlatformTime::Seconds() + BudgetMs / 1000.0 : 0.0;
+		++State->ActiveScopes;
+	}
+}
+
+FDbInterruptScope::~FDbInterruptScope()
+{
+	if (State)
+	{
+		// Cancel requested during this step must not leak into the next one
+		if (--State->ActiveScopes == 0)
+		{
+			State->bCancelRequested = false;
+		}
+		State->Deadline = 0.0;
+	}
+}
@@ -7,69 +7,160 @@
 #include "DbDefaultSettings.h"
 #include "sqlite3.h"
 #include "DbComponents/DbStmt.h"
+#include "DbComponents/DbBulkImporter.h"
+#include "Async/Async.h"
+#include "Misc/CoreDelegates.h"
+#include "SmoothSqliteUtils.h"
+#include "Data/DbVectorFunctions.h"
+#include "Engine/DataTable.h"
+#include "HAL/FileManager.h"
 
-void UDbObject::Init(int32 OpenFlags)
+namespace
 {
-	bValid = false;
-	if (const auto Settings = GetDefault<UDbDefaultSettings>())
+	/// Connection opened and warmed up off the game thread, waiting to be adopted by UDbObject
+	struct FDbOpenedConnection
 	{
-		DbParams = Settings->DefaultConnectionParams;
-	
-		// Obtain path to project dir
-		const auto GameDir = FPaths::ConvertRelativePathToFull( FPaths::ProjectDir() );
-		const auto DBName = DbParams.DBName;
-		const auto Folder = DbParams.Folder;
-
-		// Make sure that path is valid
-		check(!DBName.IsEmpty())
-		check(!Folder.IsEmpty())
-		
-		// Make path to DB
-		auto DBDir = FPaths::Combine(GameDir, Folder, DBName);
-		DBDir = FPaths::SetExtension(DBDir, "db");
+		TUniquePtr<SQLite::Database> Db;
+		TArray<TPair<FString, TUniquePtr<SQLite::Statement>>> HotStatements;
+	};
 
-		
-		// Try to open DB
-		SQLITE_TRY
+	/// Open and warm up connection, runs on worker thread
+	TSharedPtr<FDbOpenedConnection, ESPMode::ThreadSafe> OpenAndWarmup(const FSqliteDBConnectionParms& Params, int32 OpenFlags, const FDbWarmupParams& Warmup)
+	{
+		auto Opened = MakeShared<FDbOpenedConnection, ESPMode::ThreadSafe>();
+		try
 		{
-			int32 Flags = 0;
-			if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::ReadOnly))
-				Flags |= SQLite::OPEN_READONLY;
-			
-			if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::ReadWrite))
-				Flags |= SQLite::OPEN_READWRITE;
-			
-			if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::URI))
-				Flags |= SQLite::OPEN_URI;
-			
-			if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::Create))
-				Flags |= SQLite::OPEN_CREATE;
-			
-			if (OpenFlags & SQLITE_GET_FLAG( EDbOpenFlags::NoMutex))
-				Flags |= SQLite::OPEN_NOMUTEX;
-			
-			if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::PrivateCache))
-				Flags |= SQLite::OPEN_PRIVATECACHE;
-			
-			if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::SharedCache))
-				Flags |= SQLite::OPEN_SHAREDCACHE;
-			
-			if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::Memory))
-				Flags |= SQLite::OPEN_MEMORY;
-			
-			// Move
-			RawDb = MakeUnique<SQLite::Database>(SQLite::Database(std::string(TCHAR_TO_UTF8(*DBDir)), Flags, DbParams.BusyTimeout));
-			bValid = true;
+			Opened->Db = UDbObject::OpenRawDb(Params, OpenFlags);
 
-			// Log
-			Ctx.LogMsg( L"Opened database \"{0}\"", {DbParams.DBName});
+			// Force schema parse now instead of on the first prepare
+			Opened->Db->execAndGet("SELECT count(*) FROM sqlite_master");
+
+			if (Warmup.bRunQuickCheck)
+			{
+				const std::string Result = Opened->Db->execAndGet("PRAGMA quick_check").getString();
+				if (Result != "ok")
+				{
+					UE_LOG(LogSmoothSqlite, Error, L"Quick check of database \"%s\" failed: %s", *Params.DBName, UTF8_TO_TCHAR(Result.c_str()));
+				}
+			}
 		}
-		SQLITE_CATCH
+		catch (SQLite::Exception& e)
 		{
-			Ctx.Log(L"Database Opening");
+			UE_LOG(LogSmoothSqlite, Error, L"Failed to open database \"%s\" asynchronously: %s", *Params.DBName, UTF8_TO_TCHAR(e.getErrorStr()));
+			return nullptr;
 		}
-		SQLITE_END
+
+		// Pull pages of configured indexes and tables into page cache
+		for (const FString& Query : Warmup.WarmupQueries)
+		{
+			try
+			{
+				SQLite::Statement Stmt(*Opened->Db, std::string(TCHAR_TO_UTF8(*Query)));
+				while (Stmt.executeStep()) {}
+			}
+			catch (SQLite::Exception& e)
+			{
+				UE_LOG(LogSmoothSqlite, Warning, L"Warm-up query \"%s\" failed: %s", *Query, UTF8_TO_TCHAR(e.getErrorStr()));
+			}
+		}
+
+		for (const FString& SQL : Warmup.HotStatements)
+		{
+			try
+			{
+				Opened->HotStatements.Emplace(SQL, MakeUnique<SQLite::Statement>(*Opened->Db, std::string(TCHAR_TO_UTF8(*SQL))));
+			}
+			catch (SQLite::Exception& e)
+			{
+				UE_LOG(LogSmoothSqlite, Warning, L"Failed to prepare hot statement \"%s\": %s", *SQL, UTF8_TO_TCHAR(e.getErrorStr()));
+			}
+		}
+
+		return Opened;
+	}
+}
+
+FString UDbObject::MakeDbPath(const FSqliteDBConnectionParms& Params)
+{
+	// Obtain path to project dir
+	const auto GameDir = FPaths::ConvertRelativePathToFull( FPaths::ProjectDir() );
+	const auto DBName = Params.DBName;
+	const auto Folder = Params.Folder;
+
+	// Make sure that path is valid
+	check(!DBName.IsEmpty())
+	check(!Folder.IsEmpty())
+	
+	// Make path to DB
+	auto DBDir = FPaths::Combine(GameDir, Folder, DBName);
+	return FPaths::SetExtension(DBDir, "db");
+}
+
+TUniquePtr<SQLite::Database> UDbObject::OpenRawDb(const FSqliteDBConnectionParms& Params, int32 OpenFlags)
+{
+	int32 Flags = 0;
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::ReadOnly))
+		Flags |= SQLite::OPEN_READONLY;
+	
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::ReadWrite))
+		Flags |= SQLite::OPEN_READWRITE;
+	
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::URI))
+		Flags |= SQLite::OPEN_URI;
+	
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::Create))
+		Flags |= SQLite::OPEN_CREATE;
+	
+	if (OpenFlags & SQLITE_GET_FLAG( EDbOpenFlags::NoMutex))
+		Flags |= SQLite::OPEN_NOMUTEX;
+	
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::PrivateCache))
+		Flags |= SQLite::OPEN_PRIVATECACHE;
+	
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::SharedCache))
+		Flags |= SQLite::OPEN_SHAREDCACHE;
+	
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::Memory))
+		Flags |= SQLite::OPEN_MEMORY;
+
+	auto Db = MakeUnique<SQLite::Database>(std::string(TCHAR_TO_UTF8(*MakeDbPath(Params))), Flags, Params.BusyTimeout);
+
+	// Every connection, including writers and readers of other threads, gets the same SQL functions
+	SmoothSql::RegisterVectorFunctions(*Db);
+	SmoothSql::CreateSharedFunctions(Db->getHandle(), MakeDbPath(Params));
+	return Db;
+}
+
+const FSqliteDBConnectionParms& UDbObject::GetDefaultConnectionParams()
+{
+	return GetDefault<UDbDefaultSettings>()->DefaultConnectionParams;
+}
+
+void UDbObject::Init(int32 OpenFlags)
+{
+	if (const auto Settings = GetDefault<UDbDefaultSettings>())
+	{
+		Init(Settings->DefaultConnectionParams, OpenFlags);
+	}
+}
+
+void UDbObject::Init(const FSqliteDBConnectionParms& Params, int32 OpenFlags)
+{
+	bValid = false;
+	
+	// Try to open DB
+	SQLITE_TRY
+	{
+		Adopt(OpenRawDb(Params, OpenFlags), Params, OpenFlags);
+
+		// Log
+		Ctx.LogMsg( L"Opened database \"{0}\"", {DbParams.DBName});
+	}
+	SQLITE_CATCH
+	{
+		Ctx.Log(L"Database Opening");
 	}
+	SQLITE_END
 
 	if (!bValid)
 	{
@@ -78,6 +169,68 @@ void UDbObject::Init(int32 OpenFlags)
 	}
 }
 
+void UDbObject::Adopt(TUniquePtr<SQLite::Database> Db, const FSqliteDBConnectionParms& Params, int32 OpenFlags)
+{
+	DbParams = Params;
+	DbOpenFlags = OpenFlags;
+	RawDb = MoveTemp(Db);
+	bValid = RawDb.IsValid();
+
+	if (bValid)
+	{
+		// Poll cancel and deadline flags while statements are running
+		InterruptState = MakeShared<FDbInterruptState, ESPMode::ThreadSafe>();
+		if (DbParams.ProgressHandlerPeriod > 0)
+		{
+			sqlite3_progress_handler(RawDb->getHandle(), DbParams.ProgressHandlerPeriod, &FDbInterruptState::ProgressHandler, InterruptState.Get());
+		}
+	}
+}
+
+TFuture<UDbObject*> UDbObject::OpenAsync(int32 OpenFlags)
+{
+	return OpenAsync(OpenFlags, GetDefault<UDbDefaultSettings>()->DefaultWarmup);
+}
+
+TFuture<UDbObject*> UDbObject::OpenAsync(int32 OpenFlags, const FDbWarmupParams& Warmup)
+{
+	auto Promise = MakeShared<TPromise<UDbObject*>, ESPMode::ThreadSafe>();
+	TFuture<UDbObject*> Future = Promise->GetFuture();
+
+	const FSqliteDBConnectionParms Params = GetDefault<UDbDefaultSettings>()->DefaultConnectionParams;
+	
+	Async(EAsyncExecution::ThreadPool, [Promise, Params, OpenFlags, Warmup]()
+	{
+		TSharedPtr<FDbOpenedConnection, ESPMode::ThreadSafe> Opened = OpenAndWarmup(Params, OpenFlags, Warmup);
+
+		// UObjects can be created only on the game thread
+		AsyncTask(ENamedThreads::GameThread, [Promise, Params, OpenFlags, Opened]()
+		{
+			UDbObject* Obj = nullptr;
+			if (Opened.IsValid())
+			{
+				Obj = NewObject<UDbObject>();
+				Obj->Adopt(MoveTemp(Opened->Db), Params, OpenFlags);
+
+				for (auto& Hot : Opened->HotStatements)
+				{
+					if (auto Stmt = NewObject<UDbStmt>())
+					{
+						Stmt->InitFromRaw(Obj, MoveTemp(Hot.Value));
+						Obj->CachedStatements.Add(Hot.Key, Stmt);
+					}
+				}
+
+				UE_LOG(LogSmoothSqlite, Display, L"Opened database \"%s\" asynchronously, %d hot statements", *Params.DBName, Obj->CachedStatements.Num());
+			}
+
+			Promise->SetValue(Obj);
+		});
+	});
+
+	return Future;
+}
+
 int32 UDbObject::GetChangesNum() const
 {
 	if (DbObjectIsValid(this))
@@ -90,8 +243,36 @@ int32 UDbObject::GetChangesNum() const
 
 void UDbObject::Release()
 {
+	// Statements must be finalized before connection is closed
+	for (auto& Cached : CachedStatements)
+	{
+		if (IsValid(Cached.Value))
+		{
+			Cached.Value->Release();
+		}
+	}
+	CachedStatements.Empty();
+
+	DisableWriteBehind();
+	DisableChangeFeed();
+	EndSession();
+	ResultCache.Reset();
+
+	// Flushes pending writes
+	GroupWriter.Reset();
+
+	// Savepoints and transaction roll back on the connection, they must go first
+	RollbackDbTransaction();
 	RawDb.Reset();
-	Transaction.Reset();
+	SmoothSql::RemoveSharedFunctions(this);
+	IndexAdvisor.Reset();
+	bHooksInstalled = false;
+	bCommitPending = false;
+	bSpatialFunctionsRegistered = false;
+
+	// Module reads sources until connection is closed
+	bVirtualTableModuleRegistered = false;
+	VirtualTableSources.Empty();
 	bValid = false;
 }
 
@@ -108,7 +289,7 @@ UDbStmt* UDbObject::Prepare(const FString& SQL)
 	{
 		if (auto Stmt = NewObject<UDbStmt>())
 		{
-			Stmt->Init(RawDb.Get(), SQL);
+			Stmt->Init(this, SQL);
 			if (!Stmt->DbStmtIsValid())
 			{
 				Stmt->ConditionalBeginDestroy();
@@ -126,10 +307,40 @@ UDbStmt* UDbObject::Prepare(const FString& SQL)
 	return nullptr;
 }
 
+UDbStmt* UDbObject::PrepareCached(const FString& SQL)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return nullptr;
+	}
+	
+	if (UDbStmt** Found = CachedStatements.Find(SQL))
+	{
+		if (UDbStmt::DbStmtIsValid(*Found))
+		{
+			(*Found)->Reset();
+			(*Found)->ClearBindings();
+			return *Found;
+		}
+
+		CachedStatements.Remove(SQL);
+	}
+
+	UDbStmt* Stmt = Prepare(SQL);
+	if (Stmt)
+	{
+		CachedStatements.Add(SQL, Stmt);
+	}
+
+	return Stmt;
+}
+
 int32 UDbObject::Execute(const FString& SQL)
 {
 	if (DbObjectIsValid(this))
 	{
+		FDbInterruptScope InterruptScope(InterruptState.Get(), 0.f);
 		SQLITE_TRY
 		{
 			const auto cSQL = std::string(TCHAR_TO_UTF8(*SQL));
@@ -137,7 +348,15 @@ int32 UDbObject::Execute(const FString& SQL)
 		}
 		SQLITE_CATCH
 		{
-			Ctx.Log(L"Db Statements Execution");
+			ReportError(Ctx.ErrorCode);
+			if (Ctx.ErrorCode == SQLITE_INTERRUPT)
+			{
+				Ctx.LogMsg(L"Db Statements Execution was cancelled, db: \"{0}\"", {DbParams.DBName});
+			}
+			else
+			{
+				Ctx.Log(L"Db Statements Execution");
+			}
 		}
 		SQLITE_END
 	}
@@ -145,116 +364,2066 @@ int32 UDbObject::Execute(const FString& SQL)
 	return -1;
 }
 
-bool UDbObject::Fetch(const FString& SQL, UDbStmt*& Stmt)
+bool UDbObject::Attach(const FDbAttachParams& Params)
 {
-	Stmt = Prepare(SQL);
-	if (UDbStmt::DbStmtIsValid(Stmt))
+	if (!DbObjectIsValid(this))
 	{
-		return Stmt->Fetch();
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
 	}
 
-	return false;
+	if (Params.Alias.IsEmpty())
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Database \"%s\" can't be attached without alias", *Params.Database.DBName);
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement Stmt(*RawDb, std::string("ATTACH DATABASE ? AS ") + TCHAR_TO_UTF8(*SmoothSql::QuoteIdentifier(Params.Alias)));
+		const FTCHARToUTF8 Path(*MakeDbPath(Params.Database));
+		Stmt.bind(1, Path.Get());
+		Stmt.exec();
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Attach \"{0}\" as \"{1}\"", {Params.Database.DBName, Params.Alias}));
+		return false;
+	}
+	SQLITE_END
+
+	AttachedDatabases.Add(Params);
+	ClearResultCache();
+
+	bool bSuccess = true;
+	for (const auto& Pragma : Params.Pragmas)
+	{
+		bSuccess &= SetSchemaPragma(Params.Alias, Pragma.Key, Pragma.Value);
+	}
+
+	return bSuccess;
 }
 
-// bool UDbObject::Fetch(const FString& SQL, FSqliteColumn& Column)
-// {
-// 	if (DbObjectIsValid(this))
-// 	{
-// 		SQLITE_TRY
-// 		{
-// 			const auto cSQL = std::string(TCHAR_TO_UTF8(*SQL));
-// 			Column = RawDb->execAndGet(cSQL);
-// 			return true;
-// 		}
-// 		SQLITE_CATCH
-// 		{
-// 			Ctx.Log(L"Db Fetch");
-// 		}
-// 		SQLITE_END
-// 	}
-//
-// 	return false;
-// }
+bool UDbObject::Detach(const FString& Alias)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
 
-bool UDbObject::StartDbTransaction(EDbTransactionFlags Flags)
+	SQLITE_TRY
+	{
+		// Fails with SQLITE_BUSY/LOCKED while statements on the schema are running
+		RawDb->exec(std::string("DETACH DATABASE ") + TCHAR_TO_UTF8(*SmoothSql::QuoteIdentifier(Alias)));
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Detach \"{0}\"", {Alias}));
+		return false;
+	}
+	SQLITE_END
+
+	AttachedDatabases.RemoveAll([&Alias](const FDbAttachParams& Attached)
+	{
+		return Attached.Alias.Equals(Alias, ESearchCase::IgnoreCase);
+	});
+	ClearResultCache();
+
+	return true;
+}
+
+namespace SmoothSql
 {
-	if (DbObjectIsValid(this) && !DbTransactIsValid())
+	namespace Pragmas
 	{
-		SQLITE_TRY
+		/// Integer, keyword or quoted literal, anything else could splice more SQL into the statement
+		bool IsValidValue(const FString& Value)
 		{
-			SQLite::TransactionBehavior Beh = SQLite::TransactionBehavior::DEFERRED;
+			if (Value.IsEmpty())
+			{
+				return false;
+			}
 
-			switch (Flags)
+			if (Value.Len() >= 2 && Value[0] == L'\'' && Value[Value.Len() - 1] == L'\'')
 			{
-			case EDbTransactionFlags::Immediate:
-				Beh = SQLite::TransactionBehavior::IMMEDIATE; break;
-			case EDbTransactionFlags::Deferred:
-				Beh = SQLite::TransactionBehavior::DEFERRED; break;
-			case EDbTransactionFlags::Exclusive:
-				Beh = SQLite::TransactionBehavior::EXCLUSIVE; break;
+				// Quotes inside the literal must be doubled
+				const FString Inner = Value.Mid(1, Value.Len() - 2);
+				return !Inner.Replace(L"''", L"").Contains(L"'");
+			}
+
+			const int32 Start = Value[0] == L'-' || Value[0] == L'+' ? 1 : 0;
+			if (Start < Value.Len() && FChar::IsDigit(Value[Start]))
+			{
+				for (int32 Idx = Start; Idx < Value.Len(); ++Idx)
+				{
+					if (!FChar::IsDigit(Value[Idx]))
+					{
+						return false;
+					}
+				}
+				return true;
 			}
-			
-			Transaction = MakeUnique<SQLite::Transaction>(*RawDb, Beh);
-			Ctx.LogMsg(L"Initiated Db Transaction, db: \"{0}\"", {DbParams.DBName});
 
+			if (!FChar::IsAlpha(Value[0]))
+			{
+				return false;
+			}
+
+			for (const TCHAR Char : Value)
+			{
+				if (!FChar::IsAlnum(Char) && Char != L'_')
+				{
+					return false;
+				}
+			}
 			return true;
 		}
-		SQLITE_CATCH
-		{
-			Ctx.Log(L"Start Db Transaction");
-		}
-		SQLITE_END
 	}
-
-	return false;
 }
 
-bool UDbObject::CommitDbTransaction()
+bool UDbObject::SetSchemaPragma(const FString& Schema, const FString& Name, const FString& Value)
 {
-	bool bCommit = false;
-	
-	if (DbTransactIsValid())
+	if (!DbObjectIsValid(this))
 	{
-		SQLITE_TRY
-		{
-			Transaction->commit();
-			Ctx.LogMsg(L"Db Transaction Commit Success, db: \"{0}\"", {DbParams.DBName});
-			bCommit = true;
-		}
-		SQLITE_CATCH
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	// Pragma names can't be quoted
+	for (const TCHAR Char : Name)
+	{
+		if (!FChar::IsAlnum(Char) && Char != L'_')
 		{
-			Ctx.Log(L"Commiting Db Transaction");
-			bCommit = false;
+			UE_LOG(LogSmoothSqlite, Error, L"\"%s\" is not a valid PRAGMA name", *Name);
+			return false;
 		}
-		SQLITE_END
-		
-		Transaction.Reset();
 	}
 
-	return bCommit;
+	if (!SmoothSql::Pragmas::IsValidValue(Value))
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"\"%s\" is not a valid value of PRAGMA %s, expected integer, keyword or quoted literal", *Value, *Name);
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		const FString SQL = FString::Printf(L"PRAGMA %s.%s = %s", *SmoothSql::QuoteIdentifier(Schema.IsEmpty() ? L"main" : Schema), *Name, *Value);
+
+		// Some pragmas (journal_mode) return a row
+		SQLite::Statement Stmt(*RawDb, std::string(TCHAR_TO_UTF8(*SQL)));
+		while (Stmt.executeStep()) {}
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"PRAGMA {0} on \"{1}\"", {Name, Schema}));
+	}
+	SQLITE_END
+
+	return false;
 }
 
-void UDbObject::RollbackDbTransaction()
+bool UDbObject::IsFullTextAvailable()
 {
-	Transaction.Reset();
+	return sqlite3_compileoption_used("ENABLE_FTS5") != 0;
 }
 
-void UDbObject::MakeBackup()
+bool UDbObject::CreateFullTextIndex(const FDbFullTextIndex& Index)
 {
-	if (DbObjectIsValid(this))
+	if (!DbObjectIsValid(this))
 	{
-		SQLITE_TRY
-		{
-			// Obtain path to project dir
-			const auto GameDir = FPaths::ConvertRelativePathToFull( FPaths::ProjectDir() );
-			const auto DBName = DbParams.DBName + FString("-backup-") + FDateTime::Now().ToString(L"dmY-his");
-			const auto Folder = DbParams.Folder;
-			
-			RawDb->backup(TCHAR_TO_ANSI(*FPaths::Combine(GameDir, Folder, "Backups", DBName)), SQLite::Database::BackupType::Save);
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
 
-			Ctx.LogMsg(L"Performed Database Backup {0}/{1}/Backups/{2}", {GameDir, Folder, DBName});
-		}
-		SQLITE_CATCH
+	if (!IsFullTextAvailable())
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Full-text index \"%s\" can't be created, sqlite is built without FTS5", *Index.Name);
+		return false;
+	}
+
+	if (Index.Name.IsEmpty() || Index.ContentTable.IsEmpty() || Index.Columns.Num() == 0)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Full-text index needs name, content table and columns");
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement Exists(*RawDb, "SELECT count(*) FROM sqlite_master WHERE type = 'table' AND name = ?");
+		const FTCHARToUTF8 Name(*Index.Name);
+		Exists.bind(1, Name.Get());
+		Exists.executeStep();
+		if (Exists.getColumn(0).getInt() > 0)
+		{
+			return true;
+		}
+
+		const FString Table = SmoothSql::QuoteIdentifier(Index.Name);
+		const FString Content = SmoothSql::QuoteIdentifier(Index.ContentTable);
+		const FString RowId = SmoothSql::QuoteIdentifier(Index.ContentRowId);
+
+		FString Columns;
+		FString NewValues = L"new." + RowId;
+		FString OldValues = L"old." + RowId;
+		for (const FString& Column : Index.Columns)
+		{
+			const FString Quoted = SmoothSql::QuoteIdentifier(Column);
+			Columns += Quoted + L", ";
+			NewValues += L", new." + Quoted;
+			OldValues += L", old." + Quoted;
+		}
+		const FString IndexColumns = L"rowid, " + Columns.LeftChop(2);
+
+		FString Options = FString::Printf(L"content=%s, content_rowid=%s, tokenize=%s",
+			*SmoothSql::QuoteLiteral(Index.ContentTable), *SmoothSql::QuoteLiteral(Index.ContentRowId), *SmoothSql::QuoteLiteral(Index.Tokenizer));
+		if (Index.PrefixLengths.Num() > 0)
+		{
+			FString Prefixes;
+			for (const int32 Length : Index.PrefixLengths)
+			{
+				Prefixes += (Prefixes.IsEmpty() ? L"" : L" ") + LexToString(Length);
+			}
+			Options += L", prefix=" + SmoothSql::QuoteLiteral(Prefixes);
+		}
+
+		// External content tables are not updated by FTS5, triggers mirror every change of content table
+		const FString Insert = FString::Printf(L"INSERT INTO %s(%s) VALUES (%s);", *Table, *IndexColumns, *NewValues);
+		const FString Delete = FString::Printf(L"INSERT INTO %s(%s, %s) VALUES ('delete', %s);", *Table, *Table, *IndexColumns, *OldValues);
+
+		const FString SQL = FString::Printf(
+			L"CREATE VIRTUAL TABLE %s USING fts5(%s, %s);"
+			L"CREATE TRIGGER %s AFTER INSERT ON %s BEGIN %s END;"
+			L"CREATE TRIGGER %s AFTER DELETE ON %s BEGIN %s END;"
+			L"CREATE TRIGGER %s AFTER UPDATE ON %s BEGIN %s %s END;"
+			L"INSERT INTO %s(%s) VALUES ('rebuild');",
+			*Table, *Columns.LeftChop(2), *Options,
+			*SmoothSql::QuoteIdentifier(Index.Name + L"_ai"), *Content, *Insert,
+			*SmoothSql::QuoteIdentifier(Index.Name + L"_ad"), *Content, *Delete,
+			*SmoothSql::QuoteIdentifier(Index.Name + L"_au"), *Content, *Delete, *Insert,
+			*Table, *Table);
+
+		SmoothSql::FScopedSavepoint Savepoint(*RawDb, L"smoothsql_fts_create");
+		RawDb->exec(std::string(TCHAR_TO_UTF8(*SQL)));
+		Savepoint.Release();
+
+		Ctx.LogMsg(L"Created full-text index \"{0}\" over \"{1}\"", {Index.Name, Index.ContentTable});
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Create Full-Text Index \"{0}\"", {Index.Name}));
+	}
+	SQLITE_END
+
+	return false;
+}
+
+bool UDbObject::DropFullTextIndex(const FString& Index)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		const FString SQL = FString::Printf(
+			L"DROP TRIGGER IF EXISTS %s; DROP TRIGGER IF EXISTS %s; DROP TRIGGER IF EXISTS %s; DROP TABLE IF EXISTS %s;",
+			*SmoothSql::QuoteIdentifier(Index + L"_ai"), *SmoothSql::QuoteIdentifier(Index + L"_ad"),
+			*SmoothSql::QuoteIdentifier(Index + L"_au"), *SmoothSql::QuoteIdentifier(Index));
+
+		SmoothSql::FScopedSavepoint Savepoint(*RawDb, L"smoothsql_fts_drop");
+		RawDb->exec(std::string(TCHAR_TO_UTF8(*SQL)));
+		Savepoint.Release();
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Drop Full-Text Index \"{0}\"", {Index}));
+	}
+	SQLITE_END
+
+	return false;
+}
+
+bool UDbObject::SearchFullText(const FString& Index, const FString& Match, const FDbFullTextQuery& Options, TArray<FDbFullTextHit>& Hits)
+{
+	Hits.Reset();
+
+	const FString Table = SmoothSql::QuoteIdentifier(Index);
+
+	FString Rank = L"bm25(" + Table;
+	for (const float Weight : Options.ColumnWeights)
+	{
+		Rank += L", " + LexToString(Weight);
+	}
+	Rank += L")";
+
+	const bool bDecorate = Options.TextColumn != INDEX_NONE;
+	const FString Decorations = bDecorate
+		? FString::Printf(L"snippet(%s, %d, ?1, ?2, ?3, %d), highlight(%s, %d, ?1, ?2)", *Table, Options.TextColumn, FMath::Clamp(Options.SnippetTokens, 1, 64), *Table, Options.TextColumn)
+		: FString(L"NULL, NULL");
+
+	// SQL depends only on options, so statement is reused across searches
+	const FString SQL = FString::Printf(L"SELECT rowid, %s, %s FROM %s WHERE %s MATCH ?4 ORDER BY 2 LIMIT ?5 OFFSET ?6",
+		*Rank, *Decorations, *Table, *Table);
+
+	UDbStmt* Stmt = PrepareCached(SQL);
+	if (!Stmt)
+	{
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement& Query = *Stmt->Raw();
+		if (bDecorate)
+		{
+			const FTCHARToUTF8 MarkOpen(*Options.MarkOpen);
+			const FTCHARToUTF8 MarkClose(*Options.MarkClose);
+			const FTCHARToUTF8 Ellipsis(*Options.Ellipsis);
+			Query.bind(1, MarkOpen.Get());
+			Query.bind(2, MarkClose.Get());
+			Query.bind(3, Ellipsis.Get());
+		}
+		const FTCHARToUTF8 MatchText(*Match);
+		Query.bind(4, MatchText.Get());
+		Query.bind(5, FMath::Max(Options.Limit, 1));
+		Query.bind(6, FMath::Max(Options.Offset, 0));
+
+		while (Query.executeStep())
+		{
+			FDbFullTextHit& Hit = Hits.AddDefaulted_GetRef();
+			Hit.RowId = Query.getColumn(0).getInt64();
+			Hit.Rank = static_cast<float>(Query.getColumn(1).getDouble());
+			if (bDecorate)
+			{
+				Hit.Snippet = UTF8_TO_TCHAR(Query.getColumn(2).getText());
+				Hit.Highlight = UTF8_TO_TCHAR(Query.getColumn(3).getText());
+			}
+		}
+		Query.reset();
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Full-Text Search \"{0}\" in \"{1}\"", {Match, Index}));
+	}
+	SQLITE_END
+
+	Stmt->Reset();
+	return false;
+}
+
+TFuture<FDbWriteResult> UDbObject::MergeFullTextIndex(const FString& Index, int32 MergePages)
+{
+	const FString Quoted = SmoothSql::QuoteIdentifier(Index);
+	if (MergePages <= 0)
+	{
+		return SubmitWrite(FString::Printf(L"INSERT INTO %s(%s) VALUES ('optimize')", *Quoted, *Quoted));
+	}
+
+	return SubmitWrite([Table = std::string(TCHAR_TO_UTF8(*Quoted)), MergePages](SQLite::Database& Db)
+	{
+		SQLite::Statement Merge(Db, "INSERT INTO " + Table + "(" + Table + ", rank) VALUES ('merge', ?)");
+		Merge.bind(1, MergePages);
+
+		// Merge step writes less than two pages once there is nothing left to merge
+		sqlite3* Handle = Db.getHandle();
+		int32 Steps = 0;
+		for (;;)
+		{
+			const int Before = sqlite3_total_changes(Handle);
+			Merge.exec();
+			Merge.reset();
+			++Steps;
+
+			if (sqlite3_total_changes(Handle) - Before < 2)
+			{
+				break;
+			}
+		}
+		return Steps;
+	});
+}
+
+void UDbObject::K2_MergeFullTextIndex(const FString& Index, int32 MergePages, const FDbWriteCompleted& OnCompleted)
+{
+	MergeFullTextIndex(Index, MergePages).Next([OnCompleted](const FDbWriteResult& Result)
+	{
+		if (!OnCompleted.IsBound())
+			return;
+
+		// Blueprint callback must run on the game thread
+		AsyncTask(ENamedThreads::GameThread, [OnCompleted, Result]()
+		{
+			OnCompleted.ExecuteIfBound(Result.bSuccess, Result.Changes);
+		});
+	});
+}
+
+bool UDbObject::RegisterFunction(const FString& Name, const SmoothSql::FDbUserFunction& Function)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+
+		// Nobody else will free it
+		if (Function.Destroy)
+		{
+			Function.Destroy(Function.App);
+		}
+		return false;
+	}
+
+	// Indexes and generated columns using the function are written by group commit writer and other connections too
+	const int32 Result = SmoothSql::AddSharedFunction(RawDb->getHandle(), MakeDbPath(DbParams), Name, Function, this);
+	if (Result != SQLITE_OK)
+	{
+		ReportError(Result);
+		UE_LOG(LogSmoothSqlite, Error, L"Function \"%s\" can't be registered: %s", *Name, UTF8_TO_TCHAR(sqlite3_errmsg(RawDb->getHandle())));
+		return false;
+	}
+
+	return true;
+}
+
+bool UDbObject::K2_RegisterScalarFunction(const FString& Name, int32 NumArgs, const FDbScalarFunction& Function, bool bDeterministic)
+{
+	SmoothSql::FDbUserFunction Boxed;
+	Boxed.NumArgs = NumArgs;
+	Boxed.bDeterministic = bDeterministic;
+	Boxed.App = new FDbScalarFunction(Function);
+	Boxed.Destroy = [](void* App)
+	{
+		delete static_cast<FDbScalarFunction*>(App);
+	};
+	Boxed.Func = [](sqlite3_context* Context, int Num, sqlite3_value** Args)
+	{
+		if (!IsInGameThread())
+		{
+			sqlite3_result_error(Context, "Blueprint SQL function called off the game thread", -1);
+			return;
+		}
+
+		const FDbScalarFunction& Delegate = *static_cast<FDbScalarFunction*>(sqlite3_user_data(Context));
+		if (!Delegate.IsBound())
+		{
+			sqlite3_result_error(Context, "Blueprint SQL function is not bound", -1);
+			return;
+		}
+
+		TArray<FSqliteValue> Values;
+		Values.Reserve(Num);
+		for (int32 Idx = 0; Idx < Num; ++Idx)
+		{
+			Values.Add(SmoothSql::TSqlArg<FSqliteValue>::Read(Args[Idx]));
+		}
+
+		SmoothSql::TSqlResult<FSqliteValue>::Write(Context, Delegate.Execute(Values));
+	};
+
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		Boxed.Destroy(Boxed.App);
+		return false;
+	}
+
+	// Delegate can only run on the game thread, so it stays on this connection
+	SQLITE_TRY
+	{
+		// sqlite frees App with Destroy even when registration fails
+		RawDb->createFunction(TCHAR_TO_UTF8(*Name), Boxed.NumArgs, Boxed.bDeterministic, Boxed.App,
+			Boxed.Func, Boxed.Step, Boxed.Final, Boxed.Destroy);
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Register Function \"{0}\"", {Name}));
+	}
+	SQLITE_END
+
+	return false;
+}
+
+bool UDbObject::UnregisterFunction(const FString& Name, int32 NumArgs)
+{
+	return RegisterFunction(Name, SmoothSql::FDbUserFunction{NumArgs});
+}
+
+bool UDbObject::RegisterVirtualTable(const FString& Name, const TSharedRef<SmoothSql::FDbVirtualRows>& Rows, const FString& KeyColumn)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	if (!bVirtualTableModuleRegistered)
+	{
+		const int Result = SmoothSql::RegisterVirtualTableModule(RawDb->getHandle(), &VirtualTableSources);
+		if (Result != SQLITE_OK)
+		{
+			ReportError(Result);
+			UE_LOG(LogSmoothSqlite, Error, L"Virtual table module can't be registered: %s", UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+			return false;
+		}
+		bVirtualTableModuleRegistered = true;
+	}
+
+	// Table reads its source when created
+	VirtualTableSources.Add(Name, { Rows, KeyColumn });
+
+	SQLITE_TRY
+	{
+		const FString Table = L"temp." + SmoothSql::QuoteIdentifier(Name);
+		RawDb->exec(TCHAR_TO_UTF8(*FString::Printf(L"DROP TABLE IF EXISTS %s; CREATE VIRTUAL TABLE %s USING %s",
+			*Table, *Table, UTF8_TO_TCHAR(SmoothSql::VirtualTableModule))));
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		VirtualTableSources.Remove(Name);
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Register Virtual Table \"{0}\"", {Name}));
+	}
+	SQLITE_END
+
+	return false;
+}
+
+bool UDbObject::RegisterDataTable(const FString& Name, const UDataTable* Table)
+{
+	if (!IsValid(Table) || !Table->GetRowStruct())
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Virtual table \"%s\" can't be registered, DataTable is not valid", *Name);
+		return false;
+	}
+
+	return RegisterVirtualTable(Name, MakeShared<SmoothSql::FDbDataTableRows>(Table));
+}
+
+bool UDbObject::UnregisterVirtualTable(const FString& Name)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		RawDb->exec(TCHAR_TO_UTF8(*(L"DROP TABLE IF EXISTS temp." + SmoothSql::QuoteIdentifier(Name))));
+		VirtualTableSources.Remove(Name);
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Unregister Virtual Table \"{0}\"", {Name}));
+	}
+	SQLITE_END
+
+	return false;
+}
+
+namespace SmoothSql
+{
+	namespace Migrations
+	{
+		/// Checksum of migration SQL, whitespace around it is ignored
+		int64 GetChecksum(const FString& SQL)
+		{
+			const FTCHARToUTF8 Converted(*SQL.TrimStartAndEnd());
+			return FCrc::MemCrc32(Converted.Get(), Converted.Length());
+		}
+	}
+}
+
+bool UDbObject::Migrate(const TArray<FDbMigration>& Migrations, bool bVerifyChecksums)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	if (Migrations.Num() == 0)
+	{
+		return true;
+	}
+
+	TArray<FDbMigration> Sorted = Migrations;
+	Sorted.StableSort([](const FDbMigration& A, const FDbMigration& B)
+	{
+		return A.Version < B.Version;
+	});
+
+	for (int32 Idx = 0; Idx < Sorted.Num(); ++Idx)
+	{
+		if (Sorted[Idx].Version <= 0 || (Idx > 0 && Sorted[Idx].Version == Sorted[Idx - 1].Version))
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Migrations of \"%s\" need unique versions above 0, got %d", *DbParams.DBName, Sorted[Idx].Version);
+			return false;
+		}
+	}
+
+	const int32 Latest = Sorted.Last().Version;
+
+	SQLITE_TRY
+	{
+		// Fast path, nothing else is read when schema is up to date
+		int32 Current = RawDb->execAndGet("PRAGMA user_version").getInt();
+		if (Current == Latest && !bVerifyChecksums)
+		{
+			return true;
+		}
+
+		// Another process may be migrating the same file, version is read again under the write lock
+		SQLite::Transaction Migration(*RawDb, SQLite::TransactionBehavior::IMMEDIATE);
+		Current = RawDb->execAndGet("PRAGMA user_version").getInt();
+		if (Current > Latest)
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Schema of \"%s\" has version %d, newer than the latest migration %d", *DbParams.DBName, Current, Latest);
+			return false;
+		}
+
+		RawDb->exec("CREATE TABLE IF NOT EXISTS smoothsql_migrations ("
+			"version INTEGER PRIMARY KEY, name TEXT NOT NULL, checksum INTEGER NOT NULL, applied_at INTEGER NOT NULL)");
+
+		TMap<int32, int64> Applied;
+		SQLite::Statement Select(*RawDb, "SELECT version, checksum FROM smoothsql_migrations");
+		while (Select.executeStep())
+		{
+			Applied.Add(Select.getColumn(0).getInt(), Select.getColumn(1).getInt64());
+		}
+
+		for (const FDbMigration& Step : Sorted)
+		{
+			if (Step.Version > Current)
+			{
+				break;
+			}
+
+			const int64* Checksum = Applied.Find(Step.Version);
+			if (Checksum && *Checksum != SmoothSql::Migrations::GetChecksum(Step.SQL))
+			{
+				UE_LOG(LogSmoothSqlite, Error, L"Migration %d \"%s\" of \"%s\" was changed after it was applied", Step.Version, *Step.Name, *DbParams.DBName);
+				return false;
+			}
+		}
+
+		SQLite::Statement Insert(*RawDb, "INSERT OR REPLACE INTO smoothsql_migrations VALUES (?, ?, ?, strftime('%s', 'now'))");
+		for (const FDbMigration& Step : Sorted)
+		{
+			if (Step.Version <= Current)
+			{
+				continue;
+			}
+
+			RawDb->exec(TCHAR_TO_UTF8(*Step.SQL));
+
+			Insert.bind(1, Step.Version);
+			Insert.bind(2, TCHAR_TO_UTF8(*Step.Name));
+			Insert.bind(3, static_cast<long long>(SmoothSql::Migrations::GetChecksum(Step.SQL)));
+			Insert.exec();
+			Insert.reset();
+
+			UE_LOG(LogSmoothSqlite, Log, L"Applied migration %d \"%s\" to \"%s\"", Step.Version, *Step.Name, *DbParams.DBName);
+		}
+
+		if (Current != Latest)
+		{
+			RawDb->exec("PRAGMA user_version = " + std::to_string(Latest));
+		}
+		Migration.commit();
+
+		if (Current != Latest)
+		{
+			ClearResultCache();
+			Ctx.LogMsg(L"Migrated \"{0}\" from version {1} to {2}", {DbParams.DBName, Current, Latest});
+		}
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Migrate \"{0}\" to version {1}", {DbParams.DBName, Latest}));
+	}
+	SQLITE_END
+
+	return false;
+}
+
+int32 UDbObject::GetSchemaVersion()
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return 0;
+	}
+
+	SQLITE_TRY
+	{
+		return RawDb->execAndGet("PRAGMA user_version").getInt();
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(L"Get Schema Version");
+	}
+	SQLITE_END
+
+	return 0;
+}
+
+void UDbObject::EnableIndexAdvisor(const FDbIndexAdvisorSettings& Settings)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return;
+	}
+
+	IndexAdvisor = MakeUnique<FDbIndexAdvisor>(Settings);
+}
+
+void UDbObject::DisableIndexAdvisor()
+{
+	IndexAdvisor.Reset();
+}
+
+bool UDbObject::IsIndexAdvisorEnabled() const
+{
+	return IndexAdvisor.IsValid();
+}
+
+bool UDbObject::GetIndexAdvice(TArray<FDbIndexAdvice>& OutAdvice)
+{
+	OutAdvice.Reset();
+
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	if (!IndexAdvisor.IsValid())
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Index advisor of \"%s\" is not enabled", *DbParams.DBName)
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		IndexAdvisor->GetAdvice(*RawDb, OutAdvice);
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(L"Get Index Advice");
+	}
+	SQLITE_END
+
+	return false;
+}
+
+bool UDbObject::BenchmarkIndexAdvice(FDbIndexAdvice& Advice, int32 Runs)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+#if UE_BUILD_SHIPPING
+	UE_LOG(LogSmoothSqlite, Error, L"Index advice can't be benchmarked in shipping builds")
+	return false;
+#else
+	const FString ScratchPath = FPaths::Combine(FPaths::ProjectSavedDir(), L"SmoothSql",
+		FString::Printf(L"%s.advisor-%s.db", *FPaths::GetBaseFilename(DbParams.DBName), *FGuid::NewGuid().ToString()));
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(ScratchPath), true);
+
+	SQLITE_TRY
+	{
+		FDbIndexAdvisor::Benchmark(*RawDb, MakeDbPath(DbParams), Advice, Runs, ScratchPath);
+		UE_LOG(LogSmoothSqlite, Log, L"%s: %.3f ms -> %.3f ms%s", *Advice.CreateSQL, Advice.MillisecondsBefore, Advice.MillisecondsAfter,
+			Advice.bUsedByPlanner ? L"" : L" (index not used by planner)")
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		Ctx.Log(L"Benchmark Index Advice");
+	}
+	SQLITE_END
+
+	return false;
+#endif
+}
+
+FDbImportResult UDbObject::ImportDataTable(const FDbImportSettings& Settings, const UDataTable* Table)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return FDbImportResult();
+	}
+
+	const FDbImportResult Result = FDbBulkImporter(*RawDb, Settings).ImportDataTable(Table);
+	ClearResultCache();
+	return Result;
+}
+
+FDbImportResult UDbObject::ImportCsv(const FDbImportSettings& Settings, const FString& Path)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return FDbImportResult();
+	}
+
+	const FDbImportResult Result = FDbBulkImporter(*RawDb, Settings).ImportCsv(Path);
+	ClearResultCache();
+	return Result;
+}
+
+FDbImportResult UDbObject::ImportJson(const FDbImportSettings& Settings, const FString& Path)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return FDbImportResult();
+	}
+
+	const FDbImportResult Result = FDbBulkImporter(*RawDb, Settings).ImportJson(Path);
+	ClearResultCache();
+	return Result;
+}
+
+TFuture<FDbExportResult> UDbObject::ExportQuery(const FString& SQL, const TArray<FSqliteValue>& Values, const FString& Path,
+	const FDbExportSettings& Settings, FDbStreamingExporter::FProgress OnProgress, TSharedPtr<FDbStreamingExporter, ESPMode::ThreadSafe>* OutExporter)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return MakeFulfilledPromise<FDbExportResult>().GetFuture();
+	}
+
+	if (DbOpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::Memory))
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Export of in-memory database \"%s\" is not supported", *DbParams.DBName);
+		return MakeFulfilledPromise<FDbExportResult>().GetFuture();
+	}
+
+	// Own connection, so the game thread can keep using this one while rows are written
+	const int32 ReaderFlags = (DbOpenFlags & ~(SQLITE_GET_FLAG(EDbOpenFlags::ReadWrite) | SQLITE_GET_FLAG(EDbOpenFlags::Create))) | SQLITE_GET_FLAG(EDbOpenFlags::ReadOnly);
+
+	// Created here, so the caller can cancel before the worker picks the export up
+	const TSharedRef<FDbStreamingExporter, ESPMode::ThreadSafe> Exporter = MakeShared<FDbStreamingExporter, ESPMode::ThreadSafe>(Settings);
+	if (OutExporter)
+	{
+		*OutExporter = Exporter;
+	}
+
+	return Async(EAsyncExecution::ThreadPool, [Params = DbParams, ReaderFlags, Query = std::string(TCHAR_TO_UTF8(*SQL)), Values, Path, Exporter, OnProgress = MoveTemp(OnProgress)]()
+	{
+		try
+		{
+			TUniquePtr<SQLite::Database> Db = OpenRawDb(Params, ReaderFlags);
+			SQLite::Statement Statement(*Db, Query);
+			for (int32 Idx = 0; Idx < Values.Num(); ++Idx)
+			{
+				Values[Idx].BindTo(Statement, Idx + 1);
+			}
+
+			return Exporter->Export(Statement.getStatementHandle(), Path, OnProgress);
+		}
+		catch (const SQLite::Exception& Ex)
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Export to \"%s\" failed: %s", *Path, UTF8_TO_TCHAR(Ex.what()));
+		}
+		return FDbExportResult();
+	});
+}
+
+void UDbObject::K2_ExportQuery(const FString& SQL, const TArray<FSqliteValue>& Values, const FString& Path,
+	const FDbExportSettings& Settings, const FDbExportProgress& OnProgress, const FDbExportCompleted& OnCompleted)
+{
+	FDbStreamingExporter::FProgress Progress;
+	if (OnProgress.IsBound())
+	{
+		Progress = [OnProgress](int64 Rows, int64 Bytes)
+		{
+			AsyncTask(ENamedThreads::GameThread, [OnProgress, Rows, Bytes]()
+			{
+				OnProgress.ExecuteIfBound(Rows, Bytes);
+			});
+		};
+	}
+
+	ExportQuery(SQL, Values, Path, Settings, MoveTemp(Progress)).Next([OnCompleted](const FDbExportResult& Result)
+	{
+		if (!OnCompleted.IsBound())
+			return;
+
+		// Blueprint callback must run on the game thread
+		AsyncTask(ENamedThreads::GameThread, [OnCompleted, Result]()
+		{
+			OnCompleted.ExecuteIfBound(Result);
+		});
+	});
+}
+
+bool UDbObject::IsSpatialIndexAvailable()
+{
+	return sqlite3_compileoption_used("ENABLE_RTREE") != 0;
+}
+
+bool UDbObject::CreateSpatialIndex(const FString& Index)
+{
+	if (!IsSpatialIndexAvailable())
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Spatial index \"%s\" can't be created, sqlite is built without R*Tree", *Index);
+		return false;
+	}
+
+	return Execute(FString::Printf(L"CREATE VIRTUAL TABLE IF NOT EXISTS %s USING rtree(id, min_x, max_x, min_y, max_y, min_z, max_z)",
+		*SmoothSql::QuoteIdentifier(Index))) >= 0;
+}
+
+bool UDbObject::SetSpatialBounds(const FString& Index, int64 Id, const FBox& Bounds)
+{
+	UDbStmt* Stmt = PrepareCached(FString::Printf(L"INSERT OR REPLACE INTO %s VALUES (?, ?, ?, ?, ?, ?, ?)", *SmoothSql::QuoteIdentifier(Index)));
+	if (!Stmt)
+	{
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement& Query = *Stmt->Raw();
+		Query.bind(1, static_cast<long long>(Id));
+		Query.bind(2, static_cast<double>(Bounds.Min.X));
+		Query.bind(3, static_cast<double>(Bounds.Max.X));
+		Query.bind(4, static_cast<double>(Bounds.Min.Y));
+		Query.bind(5, static_cast<double>(Bounds.Max.Y));
+		Query.bind(6, static_cast<double>(Bounds.Min.Z));
+		Query.bind(7, static_cast<double>(Bounds.Max.Z));
+		Query.exec();
+		Query.reset();
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Set Spatial Bounds of {0} in \"{1}\"", {Id, Index}));
+	}
+	SQLITE_END
+
+	Stmt->Reset();
+	return false;
+}
+
+bool UDbObject::SetSpatialPoint(const FString& Index, int64 Id, const FVector& Location)
+{
+	return SetSpatialBounds(Index, Id, FBox(Location, Location));
+}
+
+bool UDbObject::RemoveSpatialEntry(const FString& Index, int64 Id)
+{
+	UDbStmt* Stmt = PrepareCached(FString::Printf(L"DELETE FROM %s WHERE id = ?", *SmoothSql::QuoteIdentifier(Index)));
+	if (!Stmt)
+	{
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement& Query = *Stmt->Raw();
+		Query.bind(1, static_cast<long long>(Id));
+		Query.exec();
+		Query.reset();
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Remove Spatial Entry {0} from \"{1}\"", {Id, Index}));
+	}
+	SQLITE_END
+
+	Stmt->Reset();
+	return false;
+}
+
+bool UDbObject::QuerySpatialBox(const FString& Index, const FBox& Box, TArray<int64>& Ids)
+{
+	Ids.Reset();
+
+	UDbStmt* Stmt = PrepareCached(FString::Printf(
+		L"SELECT id FROM %s WHERE max_x >= ?1 AND min_x <= ?2 AND max_y >= ?3 AND min_y <= ?4 AND max_z >= ?5 AND min_z <= ?6",
+		*SmoothSql::QuoteIdentifier(Index)));
+	if (!Stmt)
+	{
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement& Query = *Stmt->Raw();
+		Query.bind(1, static_cast<double>(Box.Min.X));
+		Query.bind(2, static_cast<double>(Box.Max.X));
+		Query.bind(3, static_cast<double>(Box.Min.Y));
+		Query.bind(4, static_cast<double>(Box.Max.Y));
+		Query.bind(5, static_cast<double>(Box.Min.Z));
+		Query.bind(6, static_cast<double>(Box.Max.Z));
+
+		while (Query.executeStep())
+		{
+			Ids.Add(Query.getColumn(0).getInt64());
+		}
+		Query.reset();
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Spatial Box Query on \"{0}\"", {Index}));
+	}
+	SQLITE_END
+
+	Stmt->Reset();
+	return false;
+}
+
+int UDbObject::SphereQuery(sqlite3_rtree_query_info* Info)
+{
+	if (Info->nParam != 4 || Info->nCoord != 6)
+	{
+		return SQLITE_ERROR;
+	}
+
+	const double RadiusSq = Info->aParam[3] * Info->aParam[3];
+
+	// Squared distances from center to the nearest and the farthest point of the box
+	double NearSq = 0.0;
+	double FarSq = 0.0;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const double Center = Info->aParam[Axis];
+		const double Min = Info->aCoord[Axis * 2];
+		const double Max = Info->aCoord[Axis * 2 + 1];
+
+		const double Near = Center < Min ? Min - Center : Center > Max ? Center - Max : 0.0;
+		const double Far = FMath::Max(FMath::Abs(Center - Min), FMath::Abs(Center - Max));
+		NearSq += Near * Near;
+		FarSq += Far * Far;
+	}
+
+	Info->eWithin = NearSq > RadiusSq ? NOT_WITHIN : FarSq <= RadiusSq ? FULLY_WITHIN : PARTLY_WITHIN;
+
+	// Lower scores are visited and returned first
+	Info->rScore = NearSq;
+	return SQLITE_OK;
+}
+
+bool UDbObject::QuerySpatialSphere(const FString& Index, const FVector& Center, float Radius, TArray<int64>& Ids)
+{
+	Ids.Reset();
+
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+#if SMOOTHSQL_WITH_RTREE
+	if (!bSpatialFunctionsRegistered)
+	{
+		const int Result = sqlite3_rtree_query_callback(RawDb->getHandle(), "smoothsql_sphere", &UDbObject::SphereQuery, nullptr, nullptr);
+		if (Result != SQLITE_OK)
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Failed to register sphere query on \"%s\": %s", *DbParams.DBName, UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+			return false;
+		}
+		bSpatialFunctionsRegistered = true;
+	}
+
+	UDbStmt* Stmt = PrepareCached(FString::Printf(L"SELECT id FROM %s WHERE id MATCH smoothsql_sphere(?, ?, ?, ?)", *SmoothSql::QuoteIdentifier(Index)));
+	if (!Stmt)
+	{
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement& Query = *Stmt->Raw();
+		Query.bind(1, static_cast<double>(Center.X));
+		Query.bind(2, static_cast<double>(Center.Y));
+		Query.bind(3, static_cast<double>(Center.Z));
+		Query.bind(4, static_cast<double>(Radius));
+
+		while (Query.executeStep())
+		{
+			Ids.Add(Query.getColumn(0).getInt64());
+		}
+		Query.reset();
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Spatial Sphere Query on \"{0}\"", {Index}));
+	}
+	SQLITE_END
+
+	Stmt->Reset();
+	return false;
+#else
+	// No geometry callbacks, filter bounding box of the sphere
+	UDbStmt* Stmt = PrepareCached(FString::Printf(
+		L"SELECT id, min_x, max_x, min_y, max_y, min_z, max_z FROM %s WHERE max_x >= ?1 AND min_x <= ?2 AND max_y >= ?3 AND min_y <= ?4 AND max_z >= ?5 AND min_z <= ?6",
+		*SmoothSql::QuoteIdentifier(Index)));
+	if (!Stmt)
+	{
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		SQLite::Statement& Query = *Stmt->Raw();
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Query.bind(Axis * 2 + 1, static_cast<double>(Center[Axis] - Radius));
+			Query.bind(Axis * 2 + 2, static_cast<double>(Center[Axis] + Radius));
+		}
+
+		TArray<TPair<double, int64>> Found;
+		while (Query.executeStep())
+		{
+			const FBox Bounds(
+				FVector(Query.getColumn(1).getDouble(), Query.getColumn(3).getDouble(), Query.getColumn(5).getDouble()),
+				FVector(Query.getColumn(2).getDouble(), Query.getColumn(4).getDouble(), Query.getColumn(6).getDouble()));
+
+			const double DistanceSq = Bounds.ComputeSquaredDistanceToPoint(Center);
+			if (DistanceSq <= static_cast<double>(Radius) * Radius)
+			{
+				Found.Emplace(DistanceSq, Query.getColumn(0).getInt64());
+			}
+		}
+		Query.reset();
+
+		Found.Sort([](const TPair<double, int64>& A, const TPair<double, int64>& B) { return A.Key < B.Key; });
+		for (const auto& Entry : Found)
+		{
+			Ids.Add(Entry.Value);
+		}
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		ReportError(Ctx.ErrorCode);
+		Ctx.Log(*FString::Format(L"Spatial Sphere Query on \"{0}\"", {Index}));
+	}
+	SQLITE_END
+
+	Stmt->Reset();
+	return false;
+#endif
+}
+
+bool UDbObject::Fetch(const FString& SQL, UDbStmt*& Stmt)
+{
+	Stmt = Prepare(SQL);
+	if (UDbStmt::DbStmtIsValid(Stmt))
+	{
+		return Stmt->Fetch();
+	}
+
+	return false;
+}
+
+// bool UDbObject::Fetch(const FString& SQL, FSqliteColumn& Column)
+// {
+// 	if (DbObjectIsValid(this))
+// 	{
+// 		SQLITE_TRY
+// 		{
+// 			const auto cSQL = std::string(TCHAR_TO_UTF8(*SQL));
+// 			Column = RawDb->execAndGet(cSQL);
+// 			return true;
+// 		}
+// 		SQLITE_CATCH
+// 		{
+// 			Ctx.Log(L"Db Fetch");
+// 		}
+// 		SQLITE_END
+// 	}
+//
+// 	return false;
+// }
+
+bool UDbObject::StartDbTransaction(EDbTransactionFlags Flags)
+{
+	if (DbObjectIsValid(this) && !DbTransactIsValid())
+	{
+		SQLITE_TRY
+		{
+			SQLite::TransactionBehavior Beh = SQLite::TransactionBehavior::DEFERRED;
+
+			switch (Flags)
+			{
+			case EDbTransactionFlags::Immediate:
+				Beh = SQLite::TransactionBehavior::IMMEDIATE; break;
+			case EDbTransactionFlags::Deferred:
+				Beh = SQLite::TransactionBehavior::DEFERRED; break;
+			case EDbTransactionFlags::Exclusive:
+				Beh = SQLite::TransactionBehavior::EXCLUSIVE; break;
+			}
+			
+			Transaction = MakeUnique<SQLite::Transaction>(*RawDb, Beh);
+			TransactionErrorMark = NumErrors;
+			Ctx.LogMsg(L"Initiated Db Transaction, db: \"{0}\"", {DbParams.DBName});
+
+			return true;
+		}
+		SQLITE_CATCH
+		{
+			Ctx.Log(L"Start Db Transaction");
+		}
+		SQLITE_END
+	}
+
+	return false;
+}
+
+bool UDbObject::CommitDbTransaction()
+{
+	bool bCommit = false;
+	
+	if (DbTransactIsValid())
+	{
+		// Commit keeps changes of all open savepoints
+		PopSavepoints(0, false);
+		
+		SQLITE_TRY
+		{
+			Transaction->commit();
+			Ctx.LogMsg(L"Db Transaction Commit Success, db: \"{0}\"", {DbParams.DBName});
+			bCommit = true;
+		}
+		SQLITE_CATCH
+		{
+			Ctx.Log(L"Commiting Db Transaction");
+			bCommit = false;
+		}
+		SQLITE_END
+		
+		Transaction.Reset();
+	}
+	else if (Savepoints.Num() > 0)
+	{
+		// Outermost savepoint opened the transaction, releasing it commits
+		bCommit = PopSavepoints(0, false);
+		if (!bCommit)
+		{
+			RollbackDbTransaction();
+		}
+	}
+
+	return bCommit;
+}
+
+void UDbObject::RollbackDbTransaction()
+{
+	// Rolled back savepoints are released, which ends the transaction if the outermost one opened it
+	PopSavepoints(0, true);
+	Savepoints.Empty();
+	Transaction.Reset();
+
+	// Savepoint that failed to roll back or release may still hold the transaction open
+	if (RawDb.IsValid() && !sqlite3_get_autocommit(RawDb->getHandle()))
+	{
+		SQLITE_TRY
+		{
+			RawDb->exec("ROLLBACK");
+		}
+		SQLITE_CATCH
+		{
+			Ctx.Log(L"Rollback Db Transaction");
+		}
+		SQLITE_END
+	}
+}
+
+bool UDbObject::RunTransactionWithRetry(FTransactionBody Body, const FDbRetrySettings& Settings)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	const int32 MaxAttempts = FMath::Max(Settings.MaxAttempts, 1);
+	for (int32 Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+	{
+		if (Attempt > 0)
+		{
+			++Stats.TransactionRetries;
+			FPlatformProcess::Sleep(Settings.GetBackoffSeconds(Attempt - 1));
+		}
+
+		const ETransactionAttempt Result = AttemptTransaction(Body);
+		if (Result == ETransactionAttempt::Committed || Result == ETransactionAttempt::RolledBack)
+		{
+			return Result == ETransactionAttempt::Committed;
+		}
+
+		if (Result != ETransactionAttempt::Busy)
+		{
+			break;
+		}
+		
+		UE_LOG(LogSmoothSqlite, Verbose, L"Db \"%s\" is busy, retrying transaction (attempt %d of %d)", *DbParams.DBName, Attempt + 1, MaxAttempts);
+	}
+
+	++Stats.TransactionFailures;
+	UE_LOG(LogSmoothSqlite, Warning, L"Gave up on transaction, db: \"%s\"", *DbParams.DBName);
+	return false;
+}
+
+UDbObject::ETransactionAttempt UDbObject::AttemptTransaction(TFunctionRef<bool(UDbObject*)> Body)
+{
+	if (DbTransactIsValid() || Savepoints.Num() > 0)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Retryable transaction cannot be nested, db: \"%s\"", *DbParams.DBName);
+		return ETransactionAttempt::Failed;
+	}
+
+	const int32 BusyMark = NumBusyErrors;
+	bool bBusy = false;
+	try
+	{
+		// IMMEDIATE takes the write lock up front, so BUSY can't happen halfway through on lock upgrade
+		Transaction = MakeUnique<SQLite::Transaction>(*RawDb, SQLite::TransactionBehavior::IMMEDIATE);
+		TransactionErrorMark = NumErrors;
+
+		const bool bCommit = Body(this);
+
+		// Errors swallowed by Blueprint calls inside Body
+		bBusy = NumBusyErrors != BusyMark;
+		
+		if (bCommit && !bBusy && Transaction.IsValid())
+		{
+			// Commit keeps changes of all open savepoints, failure to release them is logged by PopSavepoints
+			if (Savepoints.Num() == 0 || PopSavepoints(0, false))
+			{
+				Transaction->commit();
+				Transaction.Reset();
+				
+				++Stats.TransactionsCommitted;
+				return ETransactionAttempt::Committed;
+			}
+		}
+		else if (!bBusy)
+		{
+			UE_LOG(LogSmoothSqlite, Verbose, L"Retryable transaction rolled back by its body, db: \"%s\"", *DbParams.DBName);
+			RollbackDbTransaction();
+			return ETransactionAttempt::RolledBack;
+		}
+	}
+	catch (SQLite::Exception& e)
+	{
+		bBusy = SmoothSql::IsBusyError(e.getErrorCode());
+		if (!bBusy)
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Retryable transaction failed, db: \"%s\": %s", *DbParams.DBName, UTF8_TO_TCHAR(e.getErrorStr()));
+		}
+	}
+
+	RollbackDbTransaction();
+	return bBusy ? ETransactionAttempt::Busy : ETransactionAttempt::Failed;
+}
+
+void UDbObject::K2_RunTransactionWithRetry(const FDbTransactionBody& Body, const FDbRetrySettings& Settings, const FDbTransactionCompleted& OnCompleted)
+{
+	if (!Body.IsBound() || !DbObjectIsValid(this))
+	{
+		OnCompleted.ExecuteIfBound(false);
+		return;
+	}
+
+	TickTransactionRetry(0.f, Body, Settings, OnCompleted, 0);
+}
+
+bool UDbObject::TickTransactionRetry(float DeltaTime, FDbTransactionBody Body, FDbRetrySettings Settings, FDbTransactionCompleted OnCompleted, int32 Attempt)
+{
+	if (!DbObjectIsValid(this))
+	{
+		OnCompleted.ExecuteIfBound(false);
+		return false;
+	}
+
+	const ETransactionAttempt Result = AttemptTransaction([&Body](UDbObject* Connection)
+	{
+		return Body.Execute(Connection);
+	});
+
+	const int32 MaxAttempts = FMath::Max(Settings.MaxAttempts, 1);
+	if (Result == ETransactionAttempt::Busy && Attempt + 1 < MaxAttempts)
+	{
+		UE_LOG(LogSmoothSqlite, Verbose, L"Db \"%s\" is busy, retrying transaction (attempt %d of %d)", *DbParams.DBName, Attempt + 1, MaxAttempts);
+
+		// Backoff waits for the ticker instead of sleeping the game thread
+		++Stats.TransactionRetries;
+		FDbCoreTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &UDbObject::TickTransactionRetry, Body, Settings, OnCompleted, Attempt + 1),
+			Settings.GetBackoffSeconds(Attempt));
+		return false;
+	}
+
+	if (Result == ETransactionAttempt::Busy || Result == ETransactionAttempt::Failed)
+	{
+		++Stats.TransactionFailures;
+		UE_LOG(LogSmoothSqlite, Warning, L"Gave up on transaction, db: \"%s\"", *DbParams.DBName);
+	}
+
+	OnCompleted.ExecuteIfBound(Result == ETransactionAttempt::Committed);
+	return false;
+}
+
+void UDbObject::EnableResultCache(const FDbResultCacheSettings& Settings)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return;
+	}
+
+	InstallHooks();
+	ResultCache = MakeUnique<FDbResultCache>(Settings);
+}
+
+void UDbObject::DisableResultCache()
+{
+	ResultCache.Reset();
+}
+
+void UDbObject::ClearResultCache()
+{
+	if (ResultCache.IsValid())
+	{
+		ResultCache->Clear();
+	}
+}
+
+FDbResultCache::FRows UDbObject::QueryCached(const FString& SQL, const TArray<FSqliteValue>& Params)
+{
+	if (DbObjectIsValid(this))
+	{
+		SQLITE_TRY
+		{
+			if (ResultCache.IsValid())
+			{
+				// Tables written by committed transaction may be cached again
+				ResolveCommit();
+				return ResultCache->Query(*RawDb, SQL, Params, Stats);
+			}
+
+			// Cache is off, run in place
+			SQLite::Statement Stmt(*RawDb, std::string(TCHAR_TO_UTF8(*SQL)));
+			for (int32 Idx = 0; Idx < Params.Num(); ++Idx)
+			{
+				Params[Idx].BindTo(Stmt, Idx + 1);
+			}
+
+			TSharedRef<TArray<FSqliteRow>, ESPMode::ThreadSafe> Rows = MakeShared<TArray<FSqliteRow>, ESPMode::ThreadSafe>();
+			while (Stmt.executeStep())
+			{
+				Rows->Add(FSqliteRow::FromStatement(Stmt));
+			}
+			return Rows;
+		}
+		SQLITE_CATCH
+		{
+			ReportError(Ctx.ErrorCode);
+			Ctx.Log(L"Db Cached Query");
+		}
+		SQLITE_END
+	}
+
+	return nullptr;
+}
+
+bool UDbObject::K2_QueryCached(const FString& SQL, const TArray<FSqliteValue>& Params, TArray<FSqliteRow>& Rows)
+{
+	const FDbResultCache::FRows Result = QueryCached(SQL, Params);
+	if (Result.IsValid())
+	{
+		Rows = *Result;
+		return true;
+	}
+
+	Rows.Reset();
+	return false;
+}
+
+void UDbObject::InstallHooks()
+{
+	if (bHooksInstalled || !DbObjectIsValid(this))
+	{
+		return;
+	}
+
+	sqlite3* Handle = RawDb->getHandle();
+	sqlite3_update_hook(Handle, &UDbObject::UpdateHook, this);
+	sqlite3_commit_hook(Handle, &UDbObject::CommitHook, this);
+	sqlite3_rollback_hook(Handle, &UDbObject::RollbackHook, this);
+
+	TotalChangesMark = sqlite3_total_changes(Handle);
+	bHooksInstalled = true;
+}
+
+void UDbObject::UpdateHook(void* Self, int Op, const char* DbName, const char* Table, int64 RowId)
+{
+	static_cast<UDbObject*>(Self)->OnRowChanged(Op, Table, RowId);
+}
+
+int UDbObject::CommitHook(void* Self)
+{
+	UDbObject* Connection = static_cast<UDbObject*>(Self);
+
+	// Hook runs before COMMIT, which may still fail with SQLITE_BUSY and leave the transaction open.
+	// Changes are published once data version shows the commit went through
+	Connection->ResolveCommit();
+	Connection->bCommitPending = true;
+	Connection->CommitDataVersion = Connection->GetDataVersion();
+
+	// Non-zero would turn commit into rollback
+	return 0;
+}
+
+void UDbObject::RollbackHook(void* Self)
+{
+	UDbObject* Connection = static_cast<UDbObject*>(Self);
+	Connection->ResolveCommit();
+	Connection->bCommitPending = false;
+	Connection->OnTransactionEnd(false);
+}
+
+uint32 UDbObject::GetDataVersion() const
+{
+	sqlite3* Handle = RawDb->getHandle();
+
+	// Changes on every commit of any connection, including this one
+	unsigned int Version = 0;
+	sqlite3_file_control(Handle, "main", SQLITE_FCNTL_DATA_VERSION, &Version);
+
+	uint32 Sum = Version;
+	for (const FDbAttachParams& Attached : AttachedDatabases)
+	{
+		Version = 0;
+		sqlite3_file_control(Handle, TCHAR_TO_UTF8(*Attached.Alias), SQLITE_FCNTL_DATA_VERSION, &Version);
+		Sum += Version;
+	}
+	return Sum;
+}
+
+void UDbObject::ResolveCommit()
+{
+	if (!bCommitPending || !RawDb.IsValid())
+	{
+		return;
+	}
+
+	// Failed COMMIT keeps the write transaction open. No transaction or changed data version
+	// (new transaction already started) means it went through
+	if (sqlite3_txn_state(RawDb->getHandle(), nullptr) == SQLITE_TXN_NONE || GetDataVersion() != CommitDataVersion)
+	{
+		bCommitPending = false;
+		OnTransactionEnd(true);
+	}
+}
+
+void UDbObject::OnRowChanged(int32 Op, const char* Table, int64 RowId)
+{
+	// Changes of previous transaction belong to it
+	ResolveCommit();
+
+	++NumRowChanges;
+
+	// Bulk writes hit the same table over and over
+	if (LastChangedTable != Table)
+	{
+		LastChangedTable = Table;
+		LastChangedTableName = UTF8_TO_TCHAR(Table);
+
+		if (ResultCache.IsValid())
+		{
+			ResultCache->OnTableChanged(LastChangedTableName);
+		}
+	}
+
+	if (bChangeFeedEnabled)
+	{
+		FDbChangeEvent& Change = PendingChanges.AddDefaulted_GetRef();
+		Change.Table = LastChangedTableName;
+		Change.Op = Op == SQLITE_INSERT ? EDbChangeOp::Insert : Op == SQLITE_DELETE ? EDbChangeOp::Delete : EDbChangeOp::Update;
+		Change.RowId = RowId;
+	}
+}
+
+void UDbObject::OnTransactionEnd(bool bCommitted)
+{
+	if (!RawDb.IsValid())
+	{
+		return;
+	}
+
+	// Update hook is not called for WITHOUT ROWID tables, so changes it didn't see were made to unknown tables.
+	// Results cached after such changes may have read them, so they go on rollback as well as on commit
+	const int32 TotalChanges = sqlite3_total_changes(RawDb->getHandle());
+	const bool bUnknownChanges = TotalChanges - TotalChangesMark > NumRowChanges;
+
+	TotalChangesMark = TotalChanges;
+	NumRowChanges = 0;
+	LastChangedTable.clear();
+
+	if (PendingChanges.Num() > 0)
+	{
+		if (bCommitted)
+		{
+			FScopeLock Lock(&ChangeFeedMutex);
+			CommittedChanges.Append(MoveTemp(PendingChanges));
+		}
+		PendingChanges.Reset();
+	}
+
+	if (ResultCache.IsValid())
+	{
+		if (bUnknownChanges)
+		{
+			ResultCache->Clear();
+		}
+		ResultCache->OnTransactionEnd();
+	}
+}
+
+void UDbObject::EnableChangeFeed()
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return;
+	}
+
+	if (bChangeFeedEnabled)
+	{
+		return;
+	}
+
+	InstallHooks();
+	bChangeFeedEnabled = true;
+	ChangeFeedTicker = FDbCoreTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDbObject::TickChangeFeed));
+}
+
+void UDbObject::DisableChangeFeed()
+{
+	if (!bChangeFeedEnabled)
+	{
+		return;
+	}
+
+	bChangeFeedEnabled = false;
+	FDbCoreTicker::GetCoreTicker().RemoveTicker(ChangeFeedTicker);
+	ChangeFeedTicker.Reset();
+
+	PendingChanges.Empty();
+	FScopeLock Lock(&ChangeFeedMutex);
+	CommittedChanges.Empty();
+}
+
+bool UDbObject::TickChangeFeed(float DeltaTime)
+{
+	ResolveCommit();
+
+	TArray<FDbChangeEvent> Changes;
+	{
+		FScopeLock Lock(&ChangeFeedMutex);
+		Changes = MoveTemp(CommittedChanges);
+		CommittedChanges.Reset();
+	}
+
+	if (Changes.Num() > 0)
+	{
+		OnChangesPublishedNative.Broadcast(this, Changes);
+		OnChangesPublished.Broadcast(this, Changes);
+	}
+
+	return true;
+}
+
+bool UDbObject::BeginSession(const TArray<FString>& Tables)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+#if SMOOTHSQL_WITH_SESSION
+	EndSession();
+
+	sqlite3* Handle = RawDb->getHandle();
+	int Result = sqlite3session_create(Handle, "main", &Session);
+	if (Result == SQLITE_OK)
+	{
+		if (Tables.Num() == 0)
+		{
+			Result = sqlite3session_attach(Session, nullptr);
+		}
+
+		for (int32 Idx = 0; Idx < Tables.Num() && Result == SQLITE_OK; ++Idx)
+		{
+			Result = sqlite3session_attach(Session, TCHAR_TO_UTF8(*Tables[Idx]));
+		}
+	}
+
+	SessionTables = Tables;
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Failed to begin session on \"%s\": %s", *DbParams.DBName, UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+		ReportError(Result);
+		EndSession();
+		return false;
+	}
+
+	return true;
+#else
+	UE_LOG(LogSmoothSqlite, Error, L"Sessions are not available, SmoothSql was built without SMOOTHSQL_WITH_SESSION");
+	return false;
+#endif
+}
+
+void UDbObject::EndSession()
+{
+#if SMOOTHSQL_WITH_SESSION
+	if (Session)
+	{
+		sqlite3session_delete(Session);
+		Session = nullptr;
+	}
+#endif
+}
+
+bool UDbObject::MakeChangeset(TArray<uint8>& Changeset, bool bPatchset, bool bReset)
+{
+	Changeset.Reset();
+
+#if SMOOTHSQL_WITH_SESSION
+	if (!Session)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"No session is active on \"%s\"", *DbParams.DBName);
+		return false;
+	}
+
+	int Size = 0;
+	void* Data = nullptr;
+	const int Result = bPatchset ? sqlite3session_patchset(Session, &Size, &Data) : sqlite3session_changeset(Session, &Size, &Data);
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Failed to make changeset of \"%s\": %s", *DbParams.DBName, UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+		ReportError(Result);
+		return false;
+	}
+
+	Changeset.Append(static_cast<const uint8*>(Data), Size);
+	sqlite3_free(Data);
+
+	if (bReset)
+	{
+		// Session has no reset, recreate it with the same tables
+		const TArray<FString> Tables = SessionTables;
+		BeginSession(Tables);
+	}
+
+	return true;
+#else
+	UE_LOG(LogSmoothSqlite, Error, L"Sessions are not available, SmoothSql was built without SMOOTHSQL_WITH_SESSION");
+	return false;
+#endif
+}
+
+#if SMOOTHSQL_WITH_SESSION
+int UDbObject::ChangesetConflict(void* Handler, int Type, sqlite3_changeset_iter* It)
+{
+	const char* Table = nullptr;
+	int NumColumns = 0;
+	int Op = 0;
+	int bIndirect = 0;
+	sqlite3changeset_op(It, &Table, &NumColumns, &Op, &bIndirect);
+
+	FDbChangesetConflict Conflict;
+	Conflict.Table = UTF8_TO_TCHAR(Table);
+	Conflict.Op = Op == SQLITE_INSERT ? EDbChangeOp::Insert : Op == SQLITE_DELETE ? EDbChangeOp::Delete : EDbChangeOp::Update;
+	switch (Type)
+	{
+	case SQLITE_CHANGESET_DATA:			Conflict.Type = EDbConflictType::Data; break;
+	case SQLITE_CHANGESET_NOTFOUND:		Conflict.Type = EDbConflictType::NotFound; break;
+	case SQLITE_CHANGESET_CONFLICT:		Conflict.Type = EDbConflictType::Conflict; break;
+	case SQLITE_CHANGESET_CONSTRAINT:	Conflict.Type = EDbConflictType::Constraint; break;
+	default:							Conflict.Type = EDbConflictType::ForeignKey; break;
+	}
+
+	switch ((*static_cast<FConflictHandler*>(Handler))(Conflict))
+	{
+	case EDbConflictAction::Abort:
+		return SQLITE_CHANGESET_ABORT;
+
+	case EDbConflictAction::Replace:
+		if (Conflict.Type == EDbConflictType::Data || Conflict.Type == EDbConflictType::Conflict)
+		{
+			return SQLITE_CHANGESET_REPLACE;
+		}
+		UE_LOG(LogSmoothSqlite, Warning, L"Conflict on \"%s\" can't be resolved by replacing, change is omitted", *Conflict.Table);
+		return SQLITE_CHANGESET_OMIT;
+
+	default:
+		return SQLITE_CHANGESET_OMIT;
+	}
+}
+#endif
+
+bool UDbObject::ApplyChangeset(const TArray<uint8>& Changeset, FConflictHandler OnConflict)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+#if SMOOTHSQL_WITH_SESSION
+	const int Result = sqlite3changeset_apply(RawDb->getHandle(), Changeset.Num(), const_cast<uint8*>(Changeset.GetData()),
+		nullptr, &UDbObject::ChangesetConflict, &OnConflict);
+
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Failed to apply changeset to \"%s\": %s", *DbParams.DBName, UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+		ReportError(Result);
+		return false;
+	}
+
+	return true;
+#else
+	UE_LOG(LogSmoothSqlite, Error, L"Sessions are not available, SmoothSql was built without SMOOTHSQL_WITH_SESSION");
+	return false;
+#endif
+}
+
+bool UDbObject::K2_ApplyChangeset(const TArray<uint8>& Changeset, const FDbConflictHandler& OnConflict)
+{
+	return ApplyChangeset(Changeset, [&OnConflict](const FDbChangesetConflict& Conflict)
+	{
+		return OnConflict.IsBound() ? OnConflict.Execute(Conflict) : EDbConflictAction::Omit;
+	});
+}
+
+bool UDbObject::InvertChangeset(const TArray<uint8>& Changeset, TArray<uint8>& Inverted)
+{
+	Inverted.Reset();
+
+#if SMOOTHSQL_WITH_SESSION
+	int Size = 0;
+	void* Data = nullptr;
+	const int Result = sqlite3changeset_invert(Changeset.Num(), Changeset.GetData(), &Size, &Data);
+	if (Result != SQLITE_OK)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Failed to invert changeset: %s", UTF8_TO_TCHAR(sqlite3_errstr(Result)));
+		return false;
+	}
+
+	Inverted.Append(static_cast<const uint8*>(Data), Size);
+	sqlite3_free(Data);
+	return true;
+#else
+	UE_LOG(LogSmoothSqlite, Error, L"Sessions are not available, SmoothSql was built without SMOOTHSQL_WITH_SESSION");
+	return false;
+#endif
+}
+
+void UDbObject::ReportError(int32 ErrorCode)
+{
+	++NumErrors;
+	if (SmoothSql::IsBusyError(ErrorCode))
+	{
+		++NumBusyErrors;
+	}
+}
+
+bool UDbObject::PushSavepoint(const FString& Name)
+{
+	if (DbObjectIsValid(this))
+	{
+		SQLITE_TRY
+		{
+			FDbSavepoint Savepoint;
+			Savepoint.Name = Name.IsEmpty() ? FString::Printf(L"smoothsql_sp_%d", Savepoints.Num()) : Name;
+			Savepoint.Savepoint = MakeUnique<SQLite::Savepoint>(*RawDb, std::string(TCHAR_TO_UTF8(*Savepoint.Name)));
+			Savepoint.ChangeMark = PendingChanges.Num();
+			
+			Savepoints.Add(MoveTemp(Savepoint));
+			return true;
+		}
+		SQLITE_CATCH
+		{
+			Ctx.Log(*FString::Format(L"Push Savepoint \"{0}\"", {Name}));
+		}
+		SQLITE_END
+	}
+
+	return false;
+}
+
+bool UDbObject::ReleaseSavepoint(const FString& Name)
+{
+	return PopSavepoints(FindSavepoint(Name), false);
+}
+
+bool UDbObject::RollbackSavepoint(const FString& Name)
+{
+	return PopSavepoints(FindSavepoint(Name), true);
+}
+
+int32 UDbObject::FindSavepoint(const FString& Name) const
+{
+	if (Name.IsEmpty())
+	{
+		return Savepoints.Num() - 1;
+	}
+
+	for (int32 Idx = Savepoints.Num() - 1; Idx >= 0; --Idx)
+	{
+		if (Savepoints[Idx].Name.Equals(Name, ESearchCase::IgnoreCase))
+		{
+			return Idx;
+		}
+	}
+
+	UE_LOG(LogSmoothSqlite, Warning, L"No open savepoint named \"%s\"", *Name);
+	return INDEX_NONE;
+}
+
+bool UDbObject::PopSavepoints(int32 Index, bool bRollback)
+{
+	if (!DbObjectIsValid(this) || !Savepoints.IsValidIndex(Index))
+	{
+		return false;
+	}
+
+	bool bSuccess = true;
+	while (Savepoints.Num() > Index)
+	{
+		FDbSavepoint Savepoint = Savepoints.Pop();
+		
+		SQLITE_TRY
+		{
+			if (bRollback)
+			{
+				// ROLLBACK TO leaves savepoint open
+				Savepoint.Savepoint->rollback();
+
+				// Rollback hook is not called for ROLLBACK TO, and RELEASE of the outermost savepoint commits
+				PendingChanges.SetNum(FMath::Min(Savepoint.ChangeMark, PendingChanges.Num()));
+				RawDb->exec(std::string("RELEASE SAVEPOINT ") + TCHAR_TO_UTF8(*SmoothSql::QuoteIdentifier(Savepoint.Name)));
+			}
+			else
+			{
+				Savepoint.Savepoint->release();
+			}
+		}
+		SQLITE_CATCH
+		{
+			Ctx.Log(*FString::Format(bRollback ? L"Rollback Savepoint \"{0}\"" : L"Release Savepoint \"{0}\"", {Savepoint.Name}));
+			bSuccess = false;
+		}
+		SQLITE_END
+	}
+
+	return bSuccess;
+}
+
+FDbSavepointScope::FDbSavepointScope(UDbObject* InDb, const FString& InName):
+	Db(InDb)
+{
+	if (InDb)
+	{
+		const int32 PrevDepth = InDb->GetSavepointDepth();
+		Name = InName.IsEmpty() ? FString::Printf(L"smoothsql_scope_%d", PrevDepth) : InName;
+		
+		if (InDb->PushSavepoint(Name))
+		{
+			Depth = PrevDepth;
+		}
+	}
+}
+
+FDbSavepointScope::~FDbSavepointScope()
+{
+	Rollback();
+}
+
+bool FDbSavepointScope::Release()
+{
+	bool bSuccess = false;
+	if (IsValid() && Db.IsValid() && Db->GetSavepointDepth() > Depth)
+	{
+		bSuccess = Db->PopSavepoints(Depth, false);
+	}
+
+	Depth = INDEX_NONE;
+	return bSuccess;
+}
+
+bool FDbSavepointScope::Rollback()
+{
+	bool bSuccess = false;
+	if (IsValid() && Db.IsValid() && Db->GetSavepointDepth() > Depth)
+	{
+		bSuccess = Db->PopSavepoints(Depth, true);
+	}
+
+	Depth = INDEX_NONE;
+	return bSuccess;
+}
+
+void UDbObject::MakeBackup()
+{
+	if (DbObjectIsValid(this))
+	{
+		SQLITE_TRY
+		{
+			// Obtain path to project dir
+			const auto GameDir = FPaths::ConvertRelativePathToFull( FPaths::ProjectDir() );
+			const auto DBName = DbParams.DBName + FString("-backup-") + FDateTime::Now().ToString(L"dmY-his");
+			const auto Folder = DbParams.Folder;
+			
+			RawDb->backup(TCHAR_TO_ANSI(*FPaths::Combine(GameDir, Folder, "Backups", DBName)), SQLite::Database::BackupType::Save);
+
+			Ctx.LogMsg(L"Performed Database Backup {0}/{1}/Backups/{2}", {GameDir, Folder, DBName});
+		}
+		SQLITE_CATCH
 		{
 			Ctx.Log(L"Db Backup");
 		}
@@ -262,6 +2431,206 @@ void UDbObject::MakeBackup()
 	}
 }
 
+bool UDbObject::EnableGroupCommit(const FDbGroupCommitSettings& Settings)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return false;
+	}
+
+	if (DbOpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::Memory))
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Group commit needs second connection, in-memory database \"%s\" can't be shared", *DbParams.DBName);
+		return false;
+	}
+
+	SQLITE_TRY
+	{
+		// Writer gets its own connection so batches never interleave with work on this one
+		const int32 WriterFlags = (DbOpenFlags & ~SQLITE_GET_FLAG(EDbOpenFlags::ReadOnly)) | SQLITE_GET_FLAG(EDbOpenFlags::ReadWrite);
+		FSqliteDBConnectionParms WriterParams = DbParams;
+		WriterParams.BusyTimeout = FMath::Max(Settings.BusyTimeoutMs, 0);
+		GroupWriter = MakeUnique<FDbGroupCommitWriter>(OpenRawDb(WriterParams, WriterFlags), Settings, DbParams.DBName);
+
+		Ctx.LogMsg(L"Enabled group commit, db: \"{0}\"", {DbParams.DBName});
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		Ctx.Log(L"Opening Group Commit Connection");
+	}
+	SQLITE_END
+
+	return false;
+}
+
+void UDbObject::DisableGroupCommit()
+{
+	GroupWriter.Reset();
+}
+
+TFuture<FDbWriteResult> UDbObject::SubmitWrite(FDbGroupCommitWriter::FWriteOp Op)
+{
+	if (GroupWriter.IsValid())
+	{
+		return GroupWriter->Submit(MoveTemp(Op));
+	}
+
+	if (IsInGameThread())
+	{
+		return MakeFulfilledPromise<FDbWriteResult>(ExecuteWrite(Op)).GetFuture();
+	}
+
+	// No writer, the main connection and its hooks belong to the game thread
+	TSharedRef<TPromise<FDbWriteResult>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<FDbWriteResult>, ESPMode::ThreadSafe>();
+	TFuture<FDbWriteResult> Future = Promise->GetFuture();
+	AsyncTask(ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr<UDbObject>(this), Op = MoveTemp(Op), Promise]()
+	{
+		UDbObject* Self = WeakThis.Get();
+		Promise->SetValue(Self ? Self->ExecuteWrite(Op) : FDbWriteResult());
+	});
+	return Future;
+}
+
+FDbWriteResult UDbObject::ExecuteWrite(const FDbGroupCommitWriter::FWriteOp& Op)
+{
+	check(IsInGameThread());
+
+	FDbWriteResult Result;
+	if (DbObjectIsValid(this))
+	{
+		SQLITE_TRY
+		{
+			Result.Changes = Op(*RawDb);
+			Result.bSuccess = true;
+		}
+		SQLITE_CATCH
+		{
+			ReportError(Ctx.ErrorCode);
+			Ctx.Log(L"Db Write");
+		}
+		SQLITE_END
+	}
+
+	return Result;
+}
+
+TFuture<FDbWriteResult> UDbObject::SubmitWrite(const FString& SQL)
+{
+	return SubmitWrite([cSQL = std::string(TCHAR_TO_UTF8(*SQL))](SQLite::Database& Database)
+	{
+		return Database.exec(cSQL);
+	});
+}
+
+void UDbObject::SubmitGroupWrite(const FString& SQL, const FDbWriteCompleted& OnCompleted)
+{
+	SubmitWrite(SQL).Next([OnCompleted](const FDbWriteResult& Result)
+	{
+		if (!OnCompleted.IsBound())
+			return;
+
+		// Blueprint callback must run on the game thread
+		AsyncTask(ENamedThreads::GameThread, [OnCompleted, Result]()
+		{
+			OnCompleted.ExecuteIfBound(Result.bSuccess, Result.Changes);
+		});
+	});
+}
+
+void UDbObject::EnableWriteBehind(const FDbWriteBehindSettings& Settings)
+{
+	if (!DbObjectIsValid(this))
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Tried to access NULL DbObject!")
+		return;
+	}
+
+	WriteBehindSettings = Settings;
+	if (!WriteBehind.IsValid())
+	{
+		WriteBehind = MakeUnique<FDbWriteBehindQueue>();
+
+		WriteBehindExitHandle = FCoreDelegates::OnPreExit.AddWeakLambda(this, [this]() { FlushWriteBehind(); });
+		WriteBehindErrorHandle = FCoreDelegates::OnHandleSystemError.AddWeakLambda(this, [this]() { FlushWriteBehind(); });
+	}
+
+	if (WriteBehindTicker.IsValid())
+	{
+		FDbCoreTicker::GetCoreTicker().RemoveTicker(WriteBehindTicker);
+	}
+	WriteBehindTicker = FDbCoreTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDbObject::TickWriteBehind), Settings.FlushIntervalSeconds);
+}
+
+void UDbObject::DisableWriteBehind()
+{
+	if (!WriteBehind.IsValid())
+	{
+		return;
+	}
+
+	FlushWriteBehind();
+	
+	FDbCoreTicker::GetCoreTicker().RemoveTicker(WriteBehindTicker);
+	WriteBehindTicker.Reset();
+
+	FCoreDelegates::OnPreExit.Remove(WriteBehindExitHandle);
+	FCoreDelegates::OnHandleSystemError.Remove(WriteBehindErrorHandle);
+
+	WriteBehind.Reset();
+}
+
+bool UDbObject::Upsert(const FString& Table, const FString& KeyColumn, const FSqliteValue& Key, const TMap<FString, FSqliteValue>& Values)
+{
+	if (!WriteBehind.IsValid())
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Upsert into \"%s\" needs write-behind to be enabled", *Table);
+		return false;
+	}
+
+	if (WriteBehind->Upsert(Table, KeyColumn, Key, Values) >= WriteBehindSettings.MaxPendingRows && IsInGameThread())
+	{
+		FlushWriteBehind();
+	}
+
+	return true;
+}
+
+bool UDbObject::FlushWriteBehind()
+{
+	if (WriteBehind.IsValid() && DbObjectIsValid(this))
+	{
+		return WriteBehind->Flush(*RawDb, DbParams.DBName);
+	}
+
+	return false;
+}
+
+int32 UDbObject::GetNumPendingUpserts() const
+{
+	return WriteBehind.IsValid() ? WriteBehind->GetNumPendingRows() : 0;
+}
+
+bool UDbObject::TickWriteBehind(float DeltaTime)
+{
+	FlushWriteBehind();
+	return true;
+}
+
+bool UDbObject::Cancel()
+{
+	if (DbObjectIsValid(this) && InterruptState.IsValid() && InterruptState->ActiveScopes > 0)
+	{
+		InterruptState->Reason = EDbInterruptReason::Cancelled;
+		InterruptState->bCancelRequested = true;
+		sqlite3_interrupt(RawDb->getHandle());
+		return true;
+	}
+
+	return false;
+}
+
 bool UDbObject::IsBusy() const
 {
 	if (DbObjectIsValid(this))
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbResultCache.h"
+
+#include "SmoothSql.h"
+#include "sqlite3.h"
+#include "SQLiteCpp/Database.h"
+#include "SQLiteCpp/Statement.h"
+
+FDbResultCache::FDbResultCache(const FDbResultCacheSettings& InSettings):
+	Settings(InSettings)
+{
+	Settings.MaxEntries = FMath::Max(Settings.MaxEntries, 1);
+	Settings.MaxRowsPerEntry = FMath::Max(Settings.MaxRowsPerEntry, 1);
+}
+
+FDbResultCache::~FDbResultCache() = default;
+
+FDbResultCache::FRows FDbResultCache::Query(SQLite::Database& Db, const FString& SQL, const TArray<FSqliteValue>& Params, FDbConnectionStats& Stats)
+{
+	CheckDataVersion(Db);
+
+	FKey Key{SQL, Params};
+	if (FEntry* Entry = Entries.Find(Key))
+	{
+		++Stats.CacheHits;
+
+		Lru.RemoveNode(Entry->Lru);
+		Lru.AddHead(MoveTemp(Key));
+		Entry->Lru = Lru.GetHead();
+
+		return Entry->Rows;
+	}
+
+	++Stats.CacheMisses;
+
+	FPrepared& Query = Prepare(Db, SQL);
+	SQLite::Statement& Stmt = *Query.Stmt;
+
+	Stmt.reset();
+	Stmt.clearBindings();
+	for (int32 Idx = 0; Idx < Params.Num(); ++Idx)
+	{
+		Params[Idx].BindTo(Stmt, Idx + 1);
+	}
+
+	TSharedRef<TArray<FSqliteRow>, ESPMode::ThreadSafe> Rows = MakeShared<TArray<FSqliteRow>, ESPMode::ThreadSafe>();
+	while (Stmt.executeStep())
+	{
+		Rows->Add(FSqliteRow::FromStatement(Stmt));
+	}
+	Stmt.reset();
+
+	// Uncommitted writes to the tables may still be rolled back
+	const bool bDirty = Query.Tables.ContainsByPredicate([this](const FString& Table)
+	{
+		return WrittenTables.Contains(Table);
+	});
+
+	if (Query.bReadOnly && !bDirty && Rows->Num() <= Settings.MaxRowsPerEntry)
+	{
+		while (Entries.Num() >= Settings.MaxEntries)
+		{
+			Remove(Lru.GetTail()->GetValue());
+		}
+
+		Lru.AddHead(Key);
+		Entries.Add(MoveTemp(Key), FEntry{Rows, &Query.Tables, Lru.GetHead()});
+	}
+
+	return Rows;
+}
+
+void FDbResultCache::OnTableChanged(const FString& Table)
+{
+	bool bAlreadyWritten = false;
+	WrittenTables.Add(Table, &bAlreadyWritten);
+
+	// Results were dropped on the first write in this transaction, nothing reading the table was cached since
+	if (bAlreadyWritten)
+	{
+		return;
+	}
+
+	TArray<FKey> Stale;
+	for (const auto& Entry : Entries)
+	{
+		if (Entry.Value.Tables->Contains(Table))
+		{
+			Stale.Add(Entry.Key);
+		}
+	}
+
+	for (const FKey& Key : Stale)
+	{
+		Remove(Key);
+	}
+}
+
+void FDbResultCache::OnTransactionEnd()
+{
+	WrittenTables.Reset();
+}
+
+void FDbResultCache::Clear()
+{
+	Entries.Reset();
+	Lru.Empty();
+}
+
+int FDbResultCache::Authorizer(void* Tables, int Action, const char* Arg1, const char* Arg2, const char* DbName, const char* Trigger)
+{
+	if (Action == SQLITE_READ && Arg1)
+	{
+		static_cast<TArray<FString>*>(Tables)->AddUnique(UTF8_TO_TCHAR(Arg1));
+	}
+
+	return SQLITE_OK;
+}
+
+FDbResultCache::FPrepared& FDbResultCache::Prepare(SQLite::Database& Db, const FString& SQL)
+{
+	if (TUniquePtr<FPrepared>* Found = Prepared.Find(SQL))
+	{
+		return **Found;
+	}
+
+	TUniquePtr<FPrepared> Query = MakeUnique<FPrepared>();
+
+	sqlite3* Handle = Db.getHandle();
+	sqlite3_set_authorizer(Handle, &FDbResultCache::Authorizer, &Query->Tables);
+	try
+	{
+		Query->Stmt = MakeUnique<SQLite::Statement>(Db, std::string(TCHAR_TO_UTF8(*SQL)));
+	}
+	catch (SQLite::Exception&)
+	{
+		sqlite3_set_authorizer(Handle, nullptr, nullptr);
+		throw;
+	}
+	sqlite3_set_authorizer(Handle, nullptr, nullptr);
+
+	Query->bReadOnly = sqlite3_stmt_readonly(Query->Stmt->getStatementHandle()) != 0;
+	if (!Query->bReadOnly)
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Query \"%s\" writes to the database, its results are not cached", *SQL);
+	}
+
+	return *Prepared.Add(SQL, MoveTemp(Query));
+}
+
+void FDbResultCache::CheckDataVersion(SQLite::Database& Db)
+{
+	if (!DataVersionStmt.IsValid())
+	{
+		DataVersionStmt = MakeUnique<SQLite::Statement>(Db, "PRAGMA data_version");
+	}
+
+	DataVersionStmt->reset();
+	DataVersionStmt->executeStep();
+	const int64 Version = DataVersionStmt->getColumn(0).getInt64();
+	DataVersionStmt->reset();
+
+	// Only changes by other connections move data_version
+	if (Version != DataVersion)
+	{
+		if (DataVersion != -1)
+		{
+			UE_LOG(LogSmoothSqlite, Verbose, L"Database was changed by another connection, dropping %d cached results", Entries.Num());
+		}
+
+		Clear();
+		DataVersion = Version;
+	}
+}
+
+void FDbResultCache::Remove(const FKey& Key)
+{
+	if (FEntry* Entry = Entries.Find(Key))
+	{
+		// Key may live in the node
+		FLruList::TDoubleLinkedListNode* Node = Entry->Lru;
+		Entries.Remove(Key);
+		Lru.RemoveNode(Node);
+	}
+}
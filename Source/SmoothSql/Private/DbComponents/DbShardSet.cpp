@@ -0,0 +1,261 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbShardSet.h"
+
+#include "SmoothSql.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "SQLiteCpp/Database.h"
+#include "SQLiteCpp/Statement.h"
+
+#include <atomic>
+
+bool UDbShardSet::Init(const FDbShardSetParams& InParams, int32 OpenFlags)
+{
+	Params = InParams;
+
+	if (Params.NumShards < 1)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Shard set \"%s\" needs at least one shard", *Params.Database.DBName);
+		return false;
+	}
+
+	if (OpenFlags & SQLITE_GET_FLAG(EDbOpenFlags::Memory))
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Shard set \"%s\" needs writer and reader connections, in-memory shards can't be shared", *Params.Database.DBName);
+		return false;
+	}
+
+	if (Params.Routing == EDbShardRouting::Range)
+	{
+		bool bValidBounds = Params.RangeUpperBounds.Num() == Params.NumShards - 1;
+		for (int32 Idx = 1; Idx < Params.RangeUpperBounds.Num() && bValidBounds; ++Idx)
+		{
+			bValidBounds = Params.RangeUpperBounds[Idx - 1] < Params.RangeUpperBounds[Idx];
+		}
+
+		if (!bValidBounds)
+		{
+			UE_LOG(LogSmoothSqlite, Error, L"Shard set \"%s\" needs %d ascending range bounds", *Params.Database.DBName, Params.NumShards - 1);
+			return false;
+		}
+	}
+
+	const int32 WriterFlags = (OpenFlags & ~SQLITE_GET_FLAG(EDbOpenFlags::ReadOnly)) | SQLITE_GET_FLAG(EDbOpenFlags::ReadWrite);
+	const int32 ReaderFlags = (OpenFlags & ~(SQLITE_GET_FLAG(EDbOpenFlags::ReadWrite) | SQLITE_GET_FLAG(EDbOpenFlags::Create))) | SQLITE_GET_FLAG(EDbOpenFlags::ReadOnly);
+
+	SQLITE_TRY
+	{
+		for (int32 Idx = 0; Idx < Params.NumShards; ++Idx)
+		{
+			FSqliteDBConnectionParms ShardParams = Params.Database;
+			ShardParams.DBName = FString::Printf(L"%s_%d", *Params.Database.DBName, Idx);
+
+			FShardPtr Shard = MakeShared<FShard, ESPMode::ThreadSafe>();
+			Shard->Name = ShardParams.DBName;
+
+			// Writer goes first, it may create the file
+			Shard->Writer = MakeUnique<FDbGroupCommitWriter>(UDbObject::OpenRawDb(ShardParams, WriterFlags), Params.WriterSettings, ShardParams.DBName);
+			Shard->Reader = UDbObject::OpenRawDb(ShardParams, ReaderFlags);
+
+			Shards.Add(MoveTemp(Shard));
+		}
+
+		Ctx.LogMsg(L"Opened shard set \"{0}\" with {1} shards", {Params.Database.DBName, Params.NumShards});
+		return true;
+	}
+	SQLITE_CATCH
+	{
+		Ctx.Log(*FString::Format(L"Opening shard {0} of \"{1}\"", {Shards.Num(), Params.Database.DBName}));
+	}
+	SQLITE_END
+
+	Shards.Empty();
+	return false;
+}
+
+void UDbShardSet::BeginDestroy()
+{
+	Close();
+	Super::BeginDestroy();
+}
+
+void UDbShardSet::Close()
+{
+	// Writers drain their queues when destroyed, queries in flight keep their shards alive
+	for (const FShardPtr& Shard : Shards)
+	{
+		Shard->Writer.Reset();
+	}
+	Shards.Empty();
+}
+
+int32 UDbShardSet::GetShardIndex(const FSqliteValue& Key) const
+{
+	if (Shards.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	if (Params.Routing == EDbShardRouting::Range)
+	{
+		const int64 Value = Key.AsInteger();
+		for (int32 Idx = 0; Idx < Params.RangeUpperBounds.Num(); ++Idx)
+		{
+			if (Value < Params.RangeUpperBounds[Idx])
+			{
+				return Idx;
+			}
+		}
+		return Shards.Num() - 1;
+	}
+
+	return static_cast<int32>(Key.GetHash() % static_cast<uint32>(Shards.Num()));
+}
+
+TFuture<FDbWriteResult> UDbShardSet::SubmitWrite(const FSqliteValue& Key, FDbGroupCommitWriter::FWriteOp Op)
+{
+	const int32 Index = GetShardIndex(Key);
+	if (Index == INDEX_NONE || !Shards[Index]->Writer.IsValid())
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Write to closed shard set \"%s\"", *Params.Database.DBName);
+		return MakeFulfilledPromise<FDbWriteResult>().GetFuture();
+	}
+
+	return Shards[Index]->Writer->Submit(MoveTemp(Op));
+}
+
+TFuture<FDbWriteResult> UDbShardSet::SubmitWrite(const FSqliteValue& Key, const FString& SQL, const TArray<FSqliteValue>& Values)
+{
+	return SubmitWrite(Key, [Query = std::string(TCHAR_TO_UTF8(*SQL)), Values](SQLite::Database& Db)
+	{
+		SQLite::Statement Stmt(Db, Query);
+		for (int32 Idx = 0; Idx < Values.Num(); ++Idx)
+		{
+			Values[Idx].BindTo(Stmt, Idx + 1);
+		}
+		return Stmt.exec();
+	});
+}
+
+void UDbShardSet::K2_SubmitWrite(const FSqliteValue& Key, const FString& SQL, const TArray<FSqliteValue>& Values, const FDbWriteCompleted& OnCompleted)
+{
+	SubmitWrite(Key, SQL, Values).Next([OnCompleted](const FDbWriteResult& Result)
+	{
+		if (!OnCompleted.IsBound())
+			return;
+
+		// Blueprint callback must run on the game thread
+		AsyncTask(ENamedThreads::GameThread, [OnCompleted, Result]()
+		{
+			OnCompleted.ExecuteIfBound(Result.bSuccess, Result.Changes);
+		});
+	});
+}
+
+bool UDbShardSet::QueryShard(FShard& Shard, const std::string& SQL, const TArray<FSqliteValue>& Values, TArray<FSqliteRow>& Rows)
+{
+	FScopeLock Lock(&Shard.ReaderMutex);
+	try
+	{
+		SQLite::Statement Stmt(*Shard.Reader, SQL);
+		for (int32 Idx = 0; Idx < Values.Num(); ++Idx)
+		{
+			Values[Idx].BindTo(Stmt, Idx + 1);
+		}
+
+		while (Stmt.executeStep())
+		{
+			Rows.Add(FSqliteRow::FromStatement(Stmt));
+		}
+		return true;
+	}
+	catch (SQLite::Exception& e)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Query on shard \"%s\" failed: %s", *Shard.Name, UTF8_TO_TCHAR(e.getErrorStr()));
+	}
+
+	return false;
+}
+
+TFuture<UDbShardSet::FQueryResult> UDbShardSet::QueryAll(const FString& SQL, const TArray<FSqliteValue>& Values, const FDbShardMerge& Merge)
+{
+	if (Shards.Num() == 0)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Query on closed shard set \"%s\"", *Params.Database.DBName);
+		return MakeFulfilledPromise<FQueryResult>().GetFuture();
+	}
+
+	return Async(EAsyncExecution::ThreadPool, [ShardList = Shards, Query = std::string(TCHAR_TO_UTF8(*SQL)), Values, Merge]()
+	{
+		TArray<TArray<FSqliteRow>> ShardRows;
+		ShardRows.SetNum(ShardList.Num());
+
+		std::atomic<bool> bSuccess {true};
+		ParallelFor(ShardList.Num(), [&](int32 Idx)
+		{
+			if (!QueryShard(*ShardList[Idx], Query, Values, ShardRows[Idx]))
+			{
+				bSuccess = false;
+			}
+		});
+
+		FQueryResult Result;
+		Result.bSuccess = bSuccess;
+		if (!Result.bSuccess)
+		{
+			return Result;
+		}
+
+		int32 NumRows = 0;
+		for (const TArray<FSqliteRow>& Rows : ShardRows)
+		{
+			NumRows += Rows.Num();
+		}
+
+		Result.Rows.Reserve(NumRows);
+		for (TArray<FSqliteRow>& Rows : ShardRows)
+		{
+			Result.Rows.Append(MoveTemp(Rows));
+		}
+
+		if (Merge.OrderByColumn != INDEX_NONE)
+		{
+			// Stable, so rows with equal keys keep shard order
+			const int32 Column = Merge.OrderByColumn;
+			const bool bDescending = Merge.bDescending;
+			Result.Rows.StableSort([Column, bDescending](const FSqliteRow& A, const FSqliteRow& B)
+			{
+				static const FSqliteValue Null;
+				const FSqliteValue& ValueA = A.Values.IsValidIndex(Column) ? A.Values[Column] : Null;
+				const FSqliteValue& ValueB = B.Values.IsValidIndex(Column) ? B.Values[Column] : Null;
+
+				const int32 Order = ValueA.Compare(ValueB);
+				return bDescending ? Order > 0 : Order < 0;
+			});
+		}
+
+		if (Merge.Limit > 0 && Result.Rows.Num() > Merge.Limit)
+		{
+			Result.Rows.SetNum(Merge.Limit);
+		}
+
+		return Result;
+	});
+}
+
+void UDbShardSet::K2_QueryAll(const FString& SQL, const TArray<FSqliteValue>& Values, const FDbShardMerge& Merge, const FDbShardQueryCompleted& OnCompleted)
+{
+	QueryAll(SQL, Values, Merge).Next([OnCompleted](FQueryResult Result)
+	{
+		if (!OnCompleted.IsBound())
+			return;
+
+		// Blueprint callback must run on the game thread
+		AsyncTask(ENamedThreads::GameThread, [OnCompleted, Result = MoveTemp(Result)]()
+		{
+			OnCompleted.ExecuteIfBound(Result.bSuccess, Result.Rows);
+		});
+	});
+}
@@ -3,22 +3,54 @@
 
 #include "DbComponents/DbStmt.h"
 
+#include "SmoothSql.h"
+#include "sqlite3.h"
 #include "DbComponents/DbObject.h"
+#include "DbComponents/DbTimeSlicedCursor.h"
 
-void UDbStmt::Init(SQLite::Database* Db, const FString& SQL)
+namespace
+{
+	/// Marks statement as running for the duration of a step
+	struct FDbStepGuard
+	{
+		std::atomic<bool>& bStepping;
+		FDbInterruptScope InterruptScope;
+
+		FDbStepGuard(std::atomic<bool>& InStepping, FDbInterruptState* State, float BudgetMs):
+			bStepping(InStepping),
+			InterruptScope(State, BudgetMs)
+		{
+			bStepping = true;
+		}
+
+		~FDbStepGuard()
+		{
+			bStepping = false;
+		}
+	};
+}
+
+void UDbStmt::Init(UDbObject* InOwner, const FString& SQL)
 {
 	bValid = false;
+	Owner = InOwner;
 	SQLITE_TRY
 	{
-		if (Db)
+		if (UDbObject::DbObjectIsValid(Owner))
 		{
 			// Init 
-			RawStmt = MakeUnique<SQLite::Statement>(*Db, std::string(TCHAR_TO_UTF8(*SQL)));
+			RawStmt = MakeUnique<SQLite::Statement>(*Owner->RawDb, std::string(TCHAR_TO_UTF8(*SQL)));
+			InterruptState = Owner->InterruptState;
+			TimeBudgetMs = Owner->DbParams.DefaultStatementTimeBudgetMs;
 			bValid = true;
 		}
 	}
 	SQLITE_CATCH
 	{
+		if (IsValid(Owner))
+		{
+			Owner->ReportError(Ctx.ErrorCode);
+		}
 		Ctx.Log(L"Statement Preparing");
 	}
 	SQLITE_END
@@ -29,12 +61,58 @@ void UDbStmt::Init(SQLite::Database* Db, const FString& SQL)
 	}
 }
 
+void UDbStmt::InitFromRaw(UDbObject* InOwner, TUniquePtr<SQLite::Statement> InStmt)
+{
+	Owner = InOwner;
+	RawStmt = MoveTemp(InStmt);
+	bValid = RawStmt.IsValid() && UDbObject::DbObjectIsValid(Owner);
+
+	if (bValid)
+	{
+		InterruptState = Owner->InterruptState;
+		TimeBudgetMs = Owner->DbParams.DefaultStatementTimeBudgetMs;
+	}
+}
+
 void UDbStmt::Release()
 {
+	if (RawStmt.IsValid())
+	{
+		ReportStatus();
+	}
 	RawStmt.Reset();
+	InterruptState.Reset();
 	bValid = false;
 }
 
+bool UDbStmt::HandleInterrupt(int32 ErrorCode)
+{
+	if (ErrorCode != SQLITE_INTERRUPT)
+	{
+		return false;
+	}
+
+	LastInterrupt = InterruptState.IsValid() && InterruptState->Reason != EDbInterruptReason::None
+		? InterruptState->Reason.load()
+		: EDbInterruptReason::Cancelled;
+
+	// Interrupted statement must be reset before it can be stepped again
+	RawStmt->tryReset();
+
+	UE_LOG(LogSmoothSqlite, Warning, L"Statement \"%s\" was %s", UTF8_TO_TCHAR(RawStmt->getQuery().c_str()),
+		LastInterrupt == EDbInterruptReason::TimedOut ? L"timed out" : L"cancelled");
+	
+	return true;
+}
+
+void UDbStmt::ReportStatus()
+{
+	if (IsValid(Owner) && Owner->IndexAdvisor.IsValid())
+	{
+		Owner->IndexAdvisor->Record(RawStmt->getStatementHandle());
+	}
+}
+
 bool UDbStmt::IsDone() const
 {
 	if (DbStmtIsValid(this))
@@ -49,13 +127,27 @@ bool UDbStmt::Fetch()
 {
 	if (DbStmtIsValid(this))
 	{
+		LastInterrupt = EDbInterruptReason::None;
+		FDbStepGuard Guard(bStepping, InterruptState.Get(), TimeBudgetMs);
 		SQLITE_TRY
 		{
-			return RawStmt->executeStep();
+			const bool bRow = RawStmt->executeStep();
+			if (!bRow)
+			{
+				ReportStatus();
+			}
+			return bRow;
 		}
 		SQLITE_CATCH
 		{
-			Ctx.Log(L"Stmt Step Execution");
+			if (IsValid(Owner))
+			{
+				Owner->ReportError(Ctx.ErrorCode);
+			}
+			if (!HandleInterrupt(Ctx.ErrorCode))
+			{
+				Ctx.Log(L"Stmt Step Execution");
+			}
 		}
 		SQLITE_END
 	}
@@ -67,13 +159,24 @@ int32 UDbStmt::Execute()
 {
 	if (DbStmtIsValid(this))
 	{
+		LastInterrupt = EDbInterruptReason::None;
+		FDbStepGuard Guard(bStepping, InterruptState.Get(), TimeBudgetMs);
 		SQLITE_TRY
 		{
-			return RawStmt->exec();
+			const int32 Changes = RawStmt->exec();
+			ReportStatus();
+			return Changes;
 		}
 		SQLITE_CATCH
 		{
-			Ctx.Log(L"Stmt Execution");
+			if (IsValid(Owner))
+			{
+				Owner->ReportError(Ctx.ErrorCode);
+			}
+			if (!HandleInterrupt(Ctx.ErrorCode))
+			{
+				Ctx.Log(L"Stmt Execution");
+			}
 		}
 		SQLITE_END
 	}
@@ -87,6 +190,7 @@ void UDbStmt::Reset()
 	{
 		SQLITE_TRY
 		{
+			ReportStatus();
 			RawStmt->reset();
 		}
 		SQLITE_CATCH
@@ -119,6 +223,54 @@ void UDbStmt::Close()
 	ConditionalBeginDestroy();
 }
 
+void UDbStmt::SetTimeBudget(float Milliseconds)
+{
+	TimeBudgetMs = FMath::Max(Milliseconds, 0.f);
+}
+
+bool UDbStmt::Cancel()
+{
+	if (bStepping && UDbObject::DbObjectIsValid(Owner))
+	{
+		return Owner->Cancel();
+	}
+
+	return false;
+}
+
+UDbTimeSlicedCursor* UDbStmt::OpenTimeSlicedCursor(int32 BudgetMicroseconds, int32 MaxRowsPerTick, int32 MaxBufferedRows)
+{
+	if (DbStmtIsValid(this))
+	{
+		if (auto Cursor = NewObject<UDbTimeSlicedCursor>(this))
+		{
+			Cursor->Init(this, BudgetMicroseconds, MaxRowsPerTick, MaxBufferedRows);
+			Cursor->Start();
+			return Cursor;
+		}
+	}
+
+	return nullptr;
+}
+
+bool UDbStmt::FetchInto(const UScriptStruct* Struct, void* Data)
+{
+	if (!Struct || !Data || !Fetch())
+	{
+		return false;
+	}
+
+	sqlite3_stmt* Stmt = RawStmt->getStatementHandle();
+	if (RowStruct.Get() != Struct)
+	{
+		SmoothSql::BuildStructBindings(Struct, Stmt, RowBindings);
+		RowStruct = Struct;
+	}
+
+	SmoothSql::ReadRow(RowBindings, Data, Stmt);
+	return true;
+}
+
 SQLite::Statement* UDbStmt::Raw() const
 {
 	if (DbStmtIsValid(this))
@@ -0,0 +1,449 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbStreamingExporter.h"
+
+#include "SmoothSql.h"
+#include "HAL/FileManager.h"
+#include "Serialization/MemoryWriter.h"
+#include "sqlite3.h"
+
+namespace SmoothSql
+{
+	namespace Export
+	{
+		/// Output buffer of fixed capacity in front of file writer
+		class FBufferedWriter
+		{
+		public:
+
+			FBufferedWriter(FArchive& InFile, int32 InCapacity)
+				: File(InFile)
+				, Capacity(InCapacity)
+			{
+				Buffer.Reserve(Capacity);
+			}
+
+			void Write(const void* Data, int32 Size)
+			{
+				if (Buffer.Num() + Size > Capacity)
+				{
+					Flush();
+				}
+
+				if (Size > Capacity)
+				{
+					File.Serialize(const_cast<void*>(Data), Size);
+					Written += Size;
+					return;
+				}
+				Buffer.Append(static_cast<const uint8*>(Data), Size);
+			}
+
+			void Write(ANSICHAR Char)
+			{
+				if (Buffer.Num() == Capacity)
+				{
+					Flush();
+				}
+				Buffer.Add(static_cast<uint8>(Char));
+			}
+
+			void Write(const ANSICHAR* Text)
+			{
+				Write(Text, FCStringAnsi::Strlen(Text));
+			}
+
+			void WriteHex(const uint8* Data, int32 Size)
+			{
+				static const ANSICHAR Digits[] = "0123456789abcdef";
+				for (int32 Idx = 0; Idx < Size; ++Idx)
+				{
+					Write(Digits[Data[Idx] >> 4]);
+					Write(Digits[Data[Idx] & 0xF]);
+				}
+			}
+
+			void Flush()
+			{
+				if (Buffer.Num() > 0)
+				{
+					File.Serialize(Buffer.GetData(), Buffer.Num());
+					Written += Buffer.Num();
+					Buffer.Reset();
+				}
+			}
+
+			int64 GetBytes() const { return Written + Buffer.Num(); }
+
+		private:
+
+			FArchive& File;
+			int32 Capacity;
+			TArray<uint8> Buffer;
+			int64 Written = 0;
+		};
+
+		void WriteCsvText(FBufferedWriter& Out, const ANSICHAR* Text, int32 Size)
+		{
+			bool bQuote = false;
+			for (int32 Idx = 0; Idx < Size && !bQuote; ++Idx)
+			{
+				bQuote = Text[Idx] == ',' || Text[Idx] == '"' || Text[Idx] == '\n' || Text[Idx] == '\r';
+			}
+
+			if (!bQuote)
+			{
+				Out.Write(Text, Size);
+				return;
+			}
+
+			Out.Write('"');
+			int32 Start = 0;
+			for (int32 Idx = 0; Idx < Size; ++Idx)
+			{
+				if (Text[Idx] == '"')
+				{
+					// Quote is doubled
+					Out.Write(Text + Start, Idx - Start + 1);
+					Start = Idx;
+				}
+			}
+			Out.Write(Text + Start, Size - Start);
+			Out.Write('"');
+		}
+
+		void WriteJsonText(FBufferedWriter& Out, const ANSICHAR* Text, int32 Size)
+		{
+			static const ANSICHAR Digits[] = "0123456789abcdef";
+
+			Out.Write('"');
+			int32 Start = 0;
+			for (int32 Idx = 0; Idx < Size; ++Idx)
+			{
+				const uint8 Char = static_cast<uint8>(Text[Idx]);
+				if (Char >= 0x20 && Char != '"' && Char != '\\')
+				{
+					continue;
+				}
+
+				Out.Write(Text + Start, Idx - Start);
+				Start = Idx + 1;
+
+				switch (Char)
+				{
+				case '"':	Out.Write("\\\""); break;
+				case '\\':	Out.Write("\\\\"); break;
+				case '\n':	Out.Write("\\n"); break;
+				case '\r':	Out.Write("\\r"); break;
+				case '\t':	Out.Write("\\t"); break;
+				default:
+					Out.Write("\\u00");
+					Out.Write(Digits[Char >> 4]);
+					Out.Write(Digits[Char & 0xF]);
+					break;
+				}
+			}
+			Out.Write(Text + Start, Size - Start);
+			Out.Write('"');
+		}
+
+		void WriteCsvRow(FBufferedWriter& Out, sqlite3_stmt* Stmt, int32 NumColumns)
+		{
+			for (int32 Column = 0; Column < NumColumns; ++Column)
+			{
+				if (Column > 0)
+				{
+					Out.Write(',');
+				}
+
+				switch (sqlite3_column_type(Stmt, Column))
+				{
+				case SQLITE_NULL:
+					break;
+				case SQLITE_BLOB:
+					Out.WriteHex(static_cast<const uint8*>(sqlite3_column_blob(Stmt, Column)), sqlite3_column_bytes(Stmt, Column));
+					break;
+				default:
+				{
+					// Numbers are formatted by sqlite
+					const ANSICHAR* Text = reinterpret_cast<const ANSICHAR*>(sqlite3_column_text(Stmt, Column));
+					WriteCsvText(Out, Text, sqlite3_column_bytes(Stmt, Column));
+					break;
+				}
+				}
+			}
+			Out.Write('\n');
+		}
+
+		void WriteJsonRow(FBufferedWriter& Out, sqlite3_stmt* Stmt, const TArray<TArray<ANSICHAR>>& Keys)
+		{
+			Out.Write('{');
+			for (int32 Column = 0; Column < Keys.Num(); ++Column)
+			{
+				// Key is escaped once, with comma and colon
+				Out.Write(Keys[Column].GetData(), Keys[Column].Num());
+
+				switch (sqlite3_column_type(Stmt, Column))
+				{
+				case SQLITE_NULL:
+					Out.Write("null");
+					break;
+				case SQLITE_INTEGER:
+					Out.Write(reinterpret_cast<const ANSICHAR*>(sqlite3_column_text(Stmt, Column)), sqlite3_column_bytes(Stmt, Column));
+					break;
+				case SQLITE_FLOAT:
+					if (FMath::IsFinite(sqlite3_column_double(Stmt, Column)))
+						Out.Write(reinterpret_cast<const ANSICHAR*>(sqlite3_column_text(Stmt, Column)), sqlite3_column_bytes(Stmt, Column));
+					else
+						Out.Write("null");
+					break;
+				case SQLITE_TEXT:
+					WriteJsonText(Out, reinterpret_cast<const ANSICHAR*>(sqlite3_column_text(Stmt, Column)), sqlite3_column_bytes(Stmt, Column));
+					break;
+				case SQLITE_BLOB:
+					Out.Write('"');
+					Out.WriteHex(static_cast<const uint8*>(sqlite3_column_blob(Stmt, Column)), sqlite3_column_bytes(Stmt, Column));
+					Out.Write('"');
+					break;
+				default:
+					break;
+				}
+			}
+			Out.Write("}\n");
+		}
+
+		/// Values of current row group, one buffer per column
+		class FColumnarGroup
+		{
+		public:
+
+			explicit FColumnarGroup(int32 NumColumns)
+			{
+				Columns.SetNum(NumColumns);
+			}
+
+			void AddRow(sqlite3_stmt* Stmt)
+			{
+				for (int32 Column = 0; Column < Columns.Num(); ++Column)
+				{
+					TArray<uint8>& Values = Columns[Column];
+					const int32 Type = sqlite3_column_type(Stmt, Column);
+					Values.Add(static_cast<uint8>(Type == SQLITE_NULL ? 0 : Type));
+
+					switch (Type)
+					{
+					case SQLITE_INTEGER:
+					{
+						const int64 Value = sqlite3_column_int64(Stmt, Column);
+						Append(Values, &Value, sizeof(Value));
+						break;
+					}
+					case SQLITE_FLOAT:
+					{
+						const double Value = sqlite3_column_double(Stmt, Column);
+						Append(Values, &Value, sizeof(Value));
+						break;
+					}
+					case SQLITE_TEXT:
+					case SQLITE_BLOB:
+					{
+						const void* Data = Type == SQLITE_TEXT ? static_cast<const void*>(sqlite3_column_text(Stmt, Column)) : sqlite3_column_blob(Stmt, Column);
+						const uint32 Size = static_cast<uint32>(sqlite3_column_bytes(Stmt, Column));
+						Append(Values, &Size, sizeof(Size));
+						Append(Values, Data, Size);
+						break;
+					}
+					default:
+						break;
+					}
+				}
+				++NumRows;
+			}
+
+			/// Write group and start a new one, buffers keep their memory
+			void Flush(FBufferedWriter& Out)
+			{
+				if (NumRows == 0)
+				{
+					return;
+				}
+
+				Out.Write(&NumRows, sizeof(NumRows));
+				for (TArray<uint8>& Values : Columns)
+				{
+					const uint32 Size = static_cast<uint32>(Values.Num());
+					Out.Write(&Size, sizeof(Size));
+					Out.Write(Values.GetData(), Values.Num());
+					Values.Reset();
+				}
+				NumRows = 0;
+				NumBytes = 0;
+			}
+
+			uint32 GetNumRows() const { return NumRows; }
+			int64 GetNumBytes() const { return NumBytes; }
+
+		private:
+
+			void Append(TArray<uint8>& Values, const void* Data, int32 Size)
+			{
+				Values.Append(static_cast<const uint8*>(Data), Size);
+				NumBytes += Size;
+			}
+
+			TArray<TArray<uint8>> Columns;
+			uint32 NumRows = 0;
+			int64 NumBytes = 0;
+		};
+	}
+}
+
+FDbStreamingExporter::FDbStreamingExporter(const FDbExportSettings& InSettings)
+	: Settings(InSettings)
+{
+	Settings.BufferKilobytes = FMath::Max(4, Settings.BufferKilobytes);
+	Settings.RowsPerGroup = FMath::Max(1, Settings.RowsPerGroup);
+	Settings.ProgressInterval = FMath::Max(1, Settings.ProgressInterval);
+}
+
+FDbExportResult FDbStreamingExporter::Export(sqlite3_stmt* Stmt, const FString& Path, const FProgress& OnProgress)
+{
+	namespace Export = SmoothSql::Export;
+
+	const double StartTime = FPlatformTime::Seconds();
+	FDbExportResult Result;
+
+	TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*Path));
+	if (!File)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Export failed, can't create \"%s\"", *Path);
+		return Result;
+	}
+
+	const int32 BufferSize = Settings.BufferKilobytes * 1024;
+	Export::FBufferedWriter Out(*File, BufferSize);
+
+	const int32 NumColumns = sqlite3_column_count(Stmt);
+	TArray<TArray<ANSICHAR>> JsonKeys;
+	TUniquePtr<Export::FColumnarGroup> Group;
+
+	switch (Settings.Format)
+	{
+	case EDbExportFormat::Csv:
+		if (Settings.bHeader)
+		{
+			for (int32 Column = 0; Column < NumColumns; ++Column)
+			{
+				if (Column > 0)
+				{
+					Out.Write(',');
+				}
+				const ANSICHAR* Name = sqlite3_column_name(Stmt, Column);
+				Export::WriteCsvText(Out, Name, FCStringAnsi::Strlen(Name));
+			}
+			Out.Write('\n');
+		}
+		break;
+
+	case EDbExportFormat::NdJson:
+	{
+		// Keys are the same on every row, escape them once
+		for (int32 Column = 0; Column < NumColumns; ++Column)
+		{
+			TArray<uint8> Key;
+			FMemoryWriter KeyWriter(Key);
+			Export::FBufferedWriter KeyOut(KeyWriter, 256);
+			if (Column > 0)
+			{
+				KeyOut.Write(',');
+			}
+			const ANSICHAR* Name = sqlite3_column_name(Stmt, Column);
+			Export::WriteJsonText(KeyOut, Name, FCStringAnsi::Strlen(Name));
+			KeyOut.Write(':');
+			KeyOut.Flush();
+			JsonKeys.Emplace(reinterpret_cast<const ANSICHAR*>(Key.GetData()), Key.Num());
+		}
+		break;
+	}
+
+	case EDbExportFormat::Columnar:
+	{
+		const uint32 Version = 1;
+		const uint32 Count = static_cast<uint32>(NumColumns);
+		Out.Write("SQLC", 4);
+		Out.Write(&Version, sizeof(Version));
+		Out.Write(&Count, sizeof(Count));
+		for (int32 Column = 0; Column < NumColumns; ++Column)
+		{
+			const ANSICHAR* Name = sqlite3_column_name(Stmt, Column);
+			const uint32 Size = FCStringAnsi::Strlen(Name);
+			Out.Write(&Size, sizeof(Size));
+			Out.Write(Name, Size);
+		}
+		Group = MakeUnique<Export::FColumnarGroup>(NumColumns);
+		break;
+	}
+	}
+
+	int Step = SQLITE_ROW;
+	while (!bCancelled && (Step = sqlite3_step(Stmt)) == SQLITE_ROW)
+	{
+		switch (Settings.Format)
+		{
+		case EDbExportFormat::Csv:
+			Export::WriteCsvRow(Out, Stmt, NumColumns);
+			break;
+		case EDbExportFormat::NdJson:
+			Export::WriteJsonRow(Out, Stmt, JsonKeys);
+			break;
+		case EDbExportFormat::Columnar:
+			Group->AddRow(Stmt);
+			if (Group->GetNumRows() >= static_cast<uint32>(Settings.RowsPerGroup) || Group->GetNumBytes() >= BufferSize)
+			{
+				Group->Flush(Out);
+			}
+			break;
+		}
+
+		if (++Result.Rows % Settings.ProgressInterval == 0 && OnProgress)
+		{
+			OnProgress(Result.Rows, Out.GetBytes());
+		}
+	}
+
+	if (Group)
+	{
+		Group->Flush(Out);
+		const uint32 End = 0;
+		Out.Write(&End, sizeof(End));
+	}
+	Out.Flush();
+
+	Result.bSuccess = !bCancelled && Step == SQLITE_DONE && File->Close();
+	Result.Bytes = Out.GetBytes();
+	Result.Seconds = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+
+	if (bCancelled)
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Export to \"%s\" was cancelled after %lld rows", *Path, Result.Rows);
+	}
+	else if (Step != SQLITE_DONE)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Export to \"%s\" failed after %lld rows: %s", *Path, Result.Rows, UTF8_TO_TCHAR(sqlite3_errmsg(sqlite3_db_handle(Stmt))));
+	}
+	else if (!Result.bSuccess)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Export to \"%s\" failed, file can't be written", *Path);
+	}
+	else
+	{
+		UE_LOG(LogSmoothSqlite, Log, L"Exported %lld rows (%lld bytes) to \"%s\" in %.2f s", Result.Rows, Result.Bytes, *Path, Result.Seconds);
+	}
+
+	if (OnProgress)
+	{
+		OnProgress(Result.Rows, Result.Bytes);
+	}
+	return Result;
+}
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbTimeSlicedCursor.h"
+
+#include "DbComponents/DbStmt.h"
+
+void UDbTimeSlicedCursor::Init(UDbStmt* InStmt, int32 InBudgetMicroseconds, int32 InMaxRowsPerTick, int32 InMaxBufferedRows)
+{
+	Stmt = InStmt;
+	BudgetMicroseconds = FMath::Max(InBudgetMicroseconds, 1);
+	MaxRowsPerTick = FMath::Max(InMaxRowsPerTick, 0);
+	MaxBufferedRows = FMath::Max(InMaxBufferedRows, 0);
+	bFinished = false;
+	ReadIndex = 0;
+}
+
+bool UDbTimeSlicedCursor::Tick(float DeltaTime)
+{
+	if (!UDbStmt::DbStmtIsValid(Stmt))
+	{
+		Finish(EDbInterruptReason::None);
+		return false;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const uint64 BudgetCycles = static_cast<uint64>(BudgetMicroseconds / (FPlatformTime::GetSecondsPerCycle64() * 1000000.0));
+
+	int32 Produced = 0;
+	while (!bFinished)
+	{
+		if (MaxRowsPerTick > 0 && Produced >= MaxRowsPerTick)
+			break;
+
+		if (MaxBufferedRows > 0 && GetNumBufferedRows() >= MaxBufferedRows)
+			break;
+
+		if (Stmt->Fetch())
+		{
+			Rows.Add(FSqliteRow::FromStatement(*Stmt->Raw()));
+			++Produced;
+		}
+		else
+		{
+			bFinished = true;
+		}
+
+		if (FPlatformTime::Cycles64() - StartCycles >= BudgetCycles)
+			break;
+	}
+
+	if (Produced > 0)
+	{
+		OnRowsReady.Broadcast(this);
+	}
+
+	if (bFinished)
+	{
+		Finish(Stmt->GetInterruptReason());
+		return false;
+	}
+
+	return true;
+}
+
+void UDbTimeSlicedCursor::Finish(EDbInterruptReason Reason)
+{
+	bFinished = true;
+	TickerHandle.Reset();
+
+	OnFinished.Broadcast(this, Reason);
+}
+
+void UDbTimeSlicedCursor::Start()
+{
+	if (!bFinished && !TickerHandle.IsValid())
+	{
+		TickerHandle = FDbCoreTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDbTimeSlicedCursor::Tick));
+	}
+}
+
+void UDbTimeSlicedCursor::Stop()
+{
+	if (TickerHandle.IsValid())
+	{
+		FDbCoreTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+}
+
+bool UDbTimeSlicedCursor::PopRow(FSqliteRow& Row)
+{
+	if (ReadIndex >= Rows.Num())
+	{
+		return false;
+	}
+
+	Row = MoveTemp(Rows[ReadIndex++]);
+
+	// Compact lazily so popping stays O(1)
+	if (ReadIndex == Rows.Num())
+	{
+		Rows.Reset();
+		ReadIndex = 0;
+	}
+	else if (ReadIndex > 64 && ReadIndex * 2 > Rows.Num())
+	{
+		Rows.RemoveAt(0, ReadIndex, false);
+		ReadIndex = 0;
+	}
+
+	return true;
+}
+
+void UDbTimeSlicedCursor::PopRows(TArray<FSqliteRow>& OutRows)
+{
+	if (ReadIndex > 0)
+	{
+		Rows.RemoveAt(0, ReadIndex, false);
+		ReadIndex = 0;
+	}
+
+	OutRows = MoveTemp(Rows);
+	Rows.Reset();
+}
+
+void UDbTimeSlicedCursor::BeginDestroy()
+{
+	Stop();
+	Super::BeginDestroy();
+}
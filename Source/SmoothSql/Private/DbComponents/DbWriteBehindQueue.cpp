@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DbComponents/DbWriteBehindQueue.h"
+
+#include "SmoothSql.h"
+#include "SmoothSqliteUtils.h"
+#include "SQLiteCpp/Database.h"
+#include "SQLiteCpp/Statement.h"
+
+int32 FDbWriteBehindQueue::Upsert(const FString& Table, const FString& KeyColumn, const FSqliteValue& Key, const TMap<FString, FSqliteValue>& Values)
+{
+	FScopeLock Lock(&Mutex);
+
+	TMap<FString, FSqliteValue>& Columns = Pending.FindOrAdd(FRowKey{Table, KeyColumn, Key});
+	for (const auto& Value : Values)
+	{
+		Columns.Add(Value.Key, Value.Value);
+	}
+
+	return Pending.Num();
+}
+
+bool FDbWriteBehindQueue::Flush(SQLite::Database& Db, const FString& DbName)
+{
+	FPendingRows Rows;
+	{
+		FScopeLock Lock(&Mutex);
+		Rows = MoveTemp(Pending);
+		Pending.Reset();
+	}
+
+	if (Rows.Num() == 0)
+	{
+		return true;
+	}
+
+	try
+	{
+		SmoothSql::FScopedSavepoint Savepoint(Db, L"smoothsql_write_behind");
+
+		// Rows with the same table and column set share one prepared statement
+		TMap<FString, TUniquePtr<SQLite::Statement>> Statements;
+		TArray<FString> ColumnNames;
+
+		for (const auto& Row : Rows)
+		{
+			Row.Value.GenerateKeyArray(ColumnNames);
+			ColumnNames.Sort();
+
+			const FString Signature = Row.Key.Table + L"|" + Row.Key.KeyColumn + L"|" + FString::Join(ColumnNames, L",");
+
+			TUniquePtr<SQLite::Statement>& Stmt = Statements.FindOrAdd(Signature);
+			if (!Stmt.IsValid())
+			{
+				const FString QuotedKey = SmoothSql::QuoteIdentifier(Row.Key.KeyColumn);
+
+				FString Columns = QuotedKey;
+				FString Params = L"?";
+				FString Updates;
+				for (const FString& Column : ColumnNames)
+				{
+					const FString Quoted = SmoothSql::QuoteIdentifier(Column);
+					Columns += L", " + Quoted;
+					Params += L", ?";
+					Updates += (Updates.IsEmpty() ? L"" : L", ") + Quoted + L" = excluded." + Quoted;
+				}
+
+				const FString SQL = FString::Printf(L"INSERT INTO %s (%s) VALUES (%s) ON CONFLICT(%s) DO %s",
+					*SmoothSql::QuoteIdentifier(Row.Key.Table), *Columns, *Params, *QuotedKey,
+					Updates.IsEmpty() ? L"NOTHING" : *(L"UPDATE SET " + Updates));
+
+				Stmt = MakeUnique<SQLite::Statement>(Db, std::string(TCHAR_TO_UTF8(*SQL)));
+			}
+			else
+			{
+				Stmt->reset();
+			}
+
+			Row.Key.Key.BindTo(*Stmt, 1);
+			for (int32 Idx = 0; Idx < ColumnNames.Num(); ++Idx)
+			{
+				Row.Value.FindChecked(ColumnNames[Idx]).BindTo(*Stmt, Idx + 2);
+			}
+			Stmt->exec();
+		}
+
+		// Statements must be finalized before savepoint is released
+		Statements.Empty();
+		Savepoint.Release();
+
+		UE_LOG(LogSmoothSqlite, Verbose, L"Flushed %d buffered rows to \"%s\"", Rows.Num(), *DbName);
+		return true;
+	}
+	catch (SQLite::Exception& e)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Failed to flush %d buffered rows to \"%s\": %s", Rows.Num(), *DbName, UTF8_TO_TCHAR(e.getErrorStr()));
+	}
+
+	// Put rows back, values upserted while flushing are newer and win
+	FScopeLock Lock(&Mutex);
+	for (auto& Row : Rows)
+	{
+		TMap<FString, FSqliteValue>& Columns = Pending.FindOrAdd(Row.Key);
+		for (auto& Value : Row.Value)
+		{
+			if (!Columns.Contains(Value.Key))
+			{
+				Columns.Add(Value.Key, MoveTemp(Value.Value));
+			}
+		}
+	}
+
+	return false;
+}
+
+int32 FDbWriteBehindQueue::GetNumPendingRows() const
+{
+	FScopeLock Lock(&Mutex);
+	return Pending.Num();
+}
@@ -22,5 +22,9 @@ public:
 	// Parameters that are used when connection is being opened 'in place'
 	UPROPERTY(Config, EditAnywhere, Category="General")
 	FSqliteDBConnectionParms DefaultConnectionParams;
+
+	// Warm-up used by connections opened asynchronously
+	UPROPERTY(Config, EditAnywhere, Category="General")
+	FDbWarmupParams DefaultWarmup;
 	
 };
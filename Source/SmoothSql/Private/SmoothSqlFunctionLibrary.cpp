@@ -6,6 +6,9 @@
 #include "SmoothSql.h"
 #include "DbComponents/DbObject.h"
 #include "DbComponents/DbStmt.h"
+#include "DbComponents/DbShardSet.h"
+#include "Data/DbVectorFunctions.h"
+#include "SmoothSqliteUtils.h"
 #include "SQLiteCpp/Exception.h"
 
 
@@ -24,6 +27,12 @@ namespace details
 	}
 
 	/// Defined templates
+	template<>
+	decltype(auto) GetFromColumn<bool>(const SQLite::Column& Col)
+	{
+		return Col.getInt64() != 0;
+	}
+	
 	template<>
 	decltype(auto) GetFromColumn<int32>(const SQLite::Column& Col)
 	{
@@ -39,7 +48,8 @@ namespace details
 	template<>
 	decltype(auto) GetFromColumn<FString>(const SQLite::Column& Col)
 	{
-		return FString( UTF8_TO_TCHAR(Col.getString().c_str()));
+		const char* Text = Col.getText();
+		return SmoothSql::Utf8ToString(Text, Col.getBytes());
 	}
 
 	template<>
@@ -51,7 +61,8 @@ namespace details
 	template<>
 	decltype(auto) GetFromColumn<FName>(const SQLite::Column& Col)
 	{
-		return FName(Col.getText());
+		const char* Text = Col.getText();
+		return SmoothSql::Utf8ToName(Text, Col.getBytes());
 	}
 
 	
@@ -145,16 +156,17 @@ namespace details
 {
 	/// Specialize method for correct binding value to query param
 	template<class T>
-	void BindQueryParam(const std::string& Param, const T& Value, SQLite::Statement& Statement)
+	void BindQueryParam(const char* Param, const T& Value, SQLite::Statement& Statement)
 	{
 		Statement.bind(Param, Value);
 	}
 	
 	/// Defined templates
 	template<>
-	void BindQueryParam(const std::string& Param, const FString& Value, SQLite::Statement& Statement)
+	void BindQueryParam(const char* Param, const FString& Value, SQLite::Statement& Statement)
 	{
-		Statement.bind(Param,  std::string(TCHAR_TO_UTF8(*Value)));
+		const FTCHARToUTF8 Converted(*Value);
+		Statement.bind(Param, Converted.Get());
 	}
 	///
 
@@ -192,9 +204,14 @@ void Bind(const FString& Param, const T& Value, UDbStmt* Statement)
 	{
 		if (!Statement->DbStmtIsValid()) return;
 
-		const std::string ParamName = std::string(TCHAR_TO_UTF8(*Param));
-			
-		details::BindQueryParam(":" + ParamName, Value, *Statement->Raw());
+		// ":" prefixed name, short names stay on the stack
+		const FTCHARToUTF8 Converted(*Param);
+		TArray<ANSICHAR, TInlineAllocator<64>> ParamName;
+		ParamName.Add(':');
+		ParamName.Append(Converted.Get(), Converted.Length());
+		ParamName.Add('\0');
+
+		details::BindQueryParam(ParamName.GetData(), Value, *Statement->Raw());
 	}
 	catch (SQLite::Exception& e)
 	{
@@ -203,6 +220,50 @@ void Bind(const FString& Param, const T& Value, UDbStmt* Statement)
 	}
 }
 
+/// Bind query param by 1-based index
+template <class T>
+UDbStmt* BindIdx(int32 Index, const T& Value, UDbStmt* Statement)
+{
+	if (!UDbStmt::DbStmtIsValid(Statement))
+	{
+		details::Log("Invalid Statement");
+		return Statement;
+	}
+	
+	try
+	{
+		Statement->Raw()->bind(Index, Value);
+	}
+	catch (SQLite::Exception& e)
+	{
+		details::Log(e, Value, FString::Printf(L"#%d", Index));
+	}
+
+	return Statement;
+}
+
+template <>
+UDbStmt* BindIdx(int32 Index, const FString& Value, UDbStmt* Statement)
+{
+	if (!UDbStmt::DbStmtIsValid(Statement))
+	{
+		details::Log("Invalid Statement");
+		return Statement;
+	}
+	
+	try
+	{
+		const FTCHARToUTF8 Converted(*Value);
+		Statement->Raw()->bind(Index, Converted.Get());
+	}
+	catch (SQLite::Exception& e)
+	{
+		details::Log(e, Value, FString::Printf(L"#%d", Index));
+	}
+
+	return Statement;
+}
+
 #define K2_BIND_IMPL(Type, Name)\
 void USmoothSqlFunctionLibrary::K2_BindQueryParam_##Name##(UDbStmt* Target, const FString& Param, Type Value) \
 { \
@@ -239,6 +300,41 @@ void USmoothSqlFunctionLibrary::K2_BindQueryParam_Name(UDbStmt* Target, const FS
 }
 
 #undef K2_BIND_IMPL
+
+UDbStmt* USmoothSqlFunctionLibrary::K2_BindQueryParamIdx_Bool(UDbStmt* Target, int32 Index, bool Value)
+{
+	return BindIdx<int32>(Index, Value ? 1 : 0, Target);
+}
+
+UDbStmt* USmoothSqlFunctionLibrary::K2_BindQueryParamIdx_Int(UDbStmt* Target, int32 Index, int32 Value)
+{
+	return BindIdx(Index, Value, Target);
+}
+
+UDbStmt* USmoothSqlFunctionLibrary::K2_BindQueryParamIdx_Int64(UDbStmt* Target, int32 Index, int64 Value)
+{
+	return BindIdx(Index, Value, Target);
+}
+
+UDbStmt* USmoothSqlFunctionLibrary::K2_BindQueryParamIdx_Float(UDbStmt* Target, int32 Index, float Value)
+{
+	return BindIdx(Index, Value, Target);
+}
+
+UDbStmt* USmoothSqlFunctionLibrary::K2_BindQueryParamIdx_String(UDbStmt* Target, int32 Index, const FString& Value)
+{
+	return BindIdx(Index, Value, Target);
+}
+
+UDbStmt* USmoothSqlFunctionLibrary::K2_BindQueryParamIdx_Text(UDbStmt* Target, int32 Index, const FText& Value)
+{
+	return BindIdx(Index, Value.ToString(), Target);
+}
+
+UDbStmt* USmoothSqlFunctionLibrary::K2_BindQueryParamIdx_Name(UDbStmt* Target, int32 Index, const FName& Value)
+{
+	return BindIdx(Index, Value.ToString(), Target);
+}
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -258,6 +354,7 @@ void USmoothSqlFunctionLibrary::K2_BindQueryParam_Name(UDbStmt* Target, const FS
 	}
 
 
+	DB_STMT_GETTER_IMPL(bool, Bool)
 	DB_STMT_GETTER_IMPL(int32, Int)
 	DB_STMT_GETTER_IMPL(int64, Int64)
 	DB_STMT_GETTER_IMPL(float, Float)
@@ -294,6 +391,130 @@ bool USmoothSqlFunctionLibrary::IsValid_Column(FSqliteColumn& Column)
 
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Get value of materialized row, invalid index reads as NULL
+static const FSqliteValue& GetRowValue(const FSqliteRow& Row, int32 ColumnIdx)
+{
+	static const FSqliteValue NullValue;
+	
+	if (Row.Values.IsValidIndex(ColumnIdx))
+	{
+		return Row.Values[ColumnIdx];
+	}
+
+	details::Log(FString::Printf(L"No such column: %d", ColumnIdx));
+	return NullValue;
+}
+
+int32 USmoothSqlFunctionLibrary::GetInt_Row(const FSqliteRow& Row, int32 ColumnIdx)
+{
+	return static_cast<int32>(GetRowValue(Row, ColumnIdx).AsInteger());
+}
+
+int64 USmoothSqlFunctionLibrary::GetInt64_Row(const FSqliteRow& Row, int32 ColumnIdx)
+{
+	return GetRowValue(Row, ColumnIdx).AsInteger();
+}
+
+float USmoothSqlFunctionLibrary::GetFloat_Row(const FSqliteRow& Row, int32 ColumnIdx)
+{
+	return static_cast<float>(GetRowValue(Row, ColumnIdx).AsFloat());
+}
+
+FString USmoothSqlFunctionLibrary::GetString_Row(const FSqliteRow& Row, int32 ColumnIdx)
+{
+	return GetRowValue(Row, ColumnIdx).AsString();
+}
+
+FName USmoothSqlFunctionLibrary::GetName_Row(const FSqliteRow& Row, int32 ColumnIdx)
+{
+	return FName(*GetRowValue(Row, ColumnIdx).AsString());
+}
+
+bool USmoothSqlFunctionLibrary::IsNull_Row(const FSqliteRow& Row, int32 ColumnIdx)
+{
+	return GetRowValue(Row, ColumnIdx).IsNull();
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_Int(int32 Value)
+{
+	return MakeSqliteValue_Int64(Value);
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_Int64(int64 Value)
+{
+	FSqliteValue Result;
+	Result.Type = EDbValueType::Integer;
+	Result.Integer = Value;
+	return Result;
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_Float(float Value)
+{
+	FSqliteValue Result;
+	Result.Type = EDbValueType::Float;
+	Result.Float = Value;
+	return Result;
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_String(const FString& Value)
+{
+	FSqliteValue Result;
+	Result.Type = EDbValueType::Text;
+	Result.Text = Value;
+	return Result;
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_Name(FName Value)
+{
+	return MakeSqliteValue_String(Value.ToString());
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_Null()
+{
+	return FSqliteValue();
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_Vector(const FVector& Value)
+{
+	FSqliteValue Result;
+	Result.Type = EDbValueType::Blob;
+	Result.Blob = SmoothSql::EncodeVector(Value);
+	return Result;
+}
+
+FSqliteValue USmoothSqlFunctionLibrary::MakeSqliteValue_Rotator(const FRotator& Value)
+{
+	FSqliteValue Result;
+	Result.Type = EDbValueType::Blob;
+	Result.Blob = SmoothSql::EncodeQuat(Value.Quaternion());
+	return Result;
+}
+
+bool USmoothSqlFunctionLibrary::SqliteValueToVector(const FSqliteValue& Value, FVector& Vector)
+{
+	Vector = FVector::ZeroVector;
+	return Value.Type == EDbValueType::Blob && SmoothSql::DecodeVector(Value.Blob.GetData(), Value.Blob.Num(), Vector);
+}
+
+bool USmoothSqlFunctionLibrary::SqliteValueToRotator(const FSqliteValue& Value, FRotator& Rotator)
+{
+	FQuat Quat;
+	if (Value.Type == EDbValueType::Blob && SmoothSql::DecodeQuat(Value.Blob.GetData(), Value.Blob.Num(), Quat))
+	{
+		Rotator = Quat.Rotator();
+		return true;
+	}
+
+	Rotator = FRotator::ZeroRotator;
+	return false;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+
 UDbStmt* USmoothSqlFunctionLibrary::K2_StepStatement(UDbStmt* Target, bool& Success)
 {
 	if (!Target)
@@ -311,6 +532,68 @@ UDbStmt* USmoothSqlFunctionLibrary::K2_StepStatement(UDbStmt* Target, bool& Succ
 	return Target;
 }
 
+UDbStmt* USmoothSqlFunctionLibrary::K2_StepStatementIntoStruct(UDbStmt* Target, int32& Row, bool& Success)
+{
+	// Never called, CustomThunk
+	check(0);
+	return nullptr;
+}
+
+UDbStmt* USmoothSqlFunctionLibrary::StepStatementIntoStruct(UDbStmt* Target, const UScriptStruct* RowStruct, void* Row, bool& Success)
+{
+	Success = false;
+	
+	if (!Target)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Null statement while K2_StepStatementIntoStruct!");
+		return nullptr;
+	}
+
+	if (!RowStruct || !Row)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"No row struct while K2_StepStatementIntoStruct!");
+		return Target;
+	}
+	
+	if (UDbStmt::DbStmtIsValid(Target))
+	{
+		Success = Target->FetchInto(RowStruct, Row);
+	}
+
+	return Target;
+}
+
+UDbObject* USmoothSqlFunctionLibrary::K2_BeginScopedTransaction(UDbObject* Target, EDbTransactionFlags Behavior, bool& Success)
+{
+	if (!UDbObject::DbObjectIsValid(Target))
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Null connection while K2_BeginScopedTransaction!");
+		Success = false;
+		return Target;
+	}
+
+	Success = Target->StartDbTransaction(Behavior);
+	return Target;
+}
+
+bool USmoothSqlFunctionLibrary::K2_EndScopedTransaction(UDbObject* Target)
+{
+	if (!UDbObject::DbObjectIsValid(Target) || !Target->DbTransactIsValid())
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"No transaction to end in K2_EndScopedTransaction!");
+		return false;
+	}
+
+	if (Target->HasTransactionErrors())
+	{
+		UE_LOG(LogSmoothSqlite, Warning, L"Rolling back scoped transaction, statements failed inside the scope");
+		Target->RollbackDbTransaction();
+		return false;
+	}
+
+	return Target->CommitDbTransaction();
+}
+
 UDbObject* USmoothSqlFunctionLibrary::OpenDbConnection(int32 OpenFlags)
 {
 	if (auto Obj = NewObject<UDbObject>())
@@ -322,6 +605,21 @@ UDbObject* USmoothSqlFunctionLibrary::OpenDbConnection(int32 OpenFlags)
 	return nullptr;
 }
 
+UDbShardSet* USmoothSqlFunctionLibrary::OpenShardSet(const FDbShardSetParams& Params, int32 OpenFlags)
+{
+	if (auto Obj = NewObject<UDbShardSet>())
+	{
+		if (Obj->Init(Params, OpenFlags))
+		{
+			return Obj;
+		}
+
+		Obj->MarkPendingKill();
+	}
+
+	return nullptr;
+}
+
 bool USmoothSqlFunctionLibrary::IsValid_DbConnection(UDbObject* Object)
 {
 	return UDbObject::DbObjectIsValid(Object);
@@ -3,9 +3,167 @@
 
 #include "SmoothSqliteUtils.h"
 
+#include "SmoothSql.h"
+
 #pragma push_macro("check")
 #undef check
 
 #include "SQLiteCpp/Database.h"
+#include "SQLiteCpp/Statement.h"
+#include "sqlite3.h"
 
 #pragma pop_macro("check")
+
+
+FString SmoothSql::QuoteIdentifier(const FString& Identifier)
+{
+	return FString(L"\"") + Identifier.Replace(L"\"", L"\"\"") + L"\"";
+}
+
+FString SmoothSql::QuoteLiteral(const FString& Literal)
+{
+	return FString(L"'") + Literal.Replace(L"'", L"''") + L"'";
+}
+
+namespace
+{
+	bool IsAscii(const ANSICHAR* Text, int32 Len)
+	{
+		for (int32 Idx = 0; Idx < Len; ++Idx)
+		{
+			if (static_cast<uint8>(Text[Idx]) >= 0x80)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+FString SmoothSql::Utf8ToString(const ANSICHAR* Text, int32 Len)
+{
+	if (!Text || Len <= 0)
+	{
+		return FString();
+	}
+
+	// ASCII is widened straight into the string buffer
+	if (IsAscii(Text, Len))
+	{
+		return FString(Len, Text);
+	}
+
+	const FUTF8ToTCHAR Converted(Text, Len);
+	return FString(Converted.Length(), Converted.Get());
+}
+
+FName SmoothSql::Utf8ToName(const ANSICHAR* Text, int32 Len)
+{
+	if (!Text || Len <= 0)
+	{
+		return NAME_None;
+	}
+
+	if (IsAscii(Text, Len))
+	{
+		return FName(Len, Text);
+	}
+
+	const FUTF8ToTCHAR Converted(Text, Len);
+	return FName(Converted.Length(), Converted.Get());
+}
+
+bool SmoothSql::IsBusyError(int32 ErrorCode)
+{
+	// Extended codes keep primary code in the low byte
+	const int32 Primary = ErrorCode & 0xff;
+	return Primary == SQLITE_BUSY || Primary == SQLITE_LOCKED;
+}
+
+EDbValueType SmoothSql::GetDeclaredTypeAffinity(const FString& DeclaredType)
+{
+	if (DeclaredType.IsEmpty())
+		return EDbValueType::Null;
+
+	if (DeclaredType.Contains(L"INT"))
+		return EDbValueType::Integer;
+
+	if (DeclaredType.Contains(L"CHAR") || DeclaredType.Contains(L"CLOB") || DeclaredType.Contains(L"TEXT"))
+		return EDbValueType::Text;
+
+	if (DeclaredType.Contains(L"BLOB"))
+		return EDbValueType::Blob;
+
+	// REAL and NUMERIC affinity
+	return EDbValueType::Float;
+}
+
+bool SmoothSql::DescribeQuery(const FString& DbPath, const FString& SQL, FDbQueryDescription& OutDescription, FString& OutError)
+{
+	OutDescription = FDbQueryDescription();
+	OutError.Reset();
+	
+	try
+	{
+		SQLite::Database Db(std::string(TCHAR_TO_UTF8(*DbPath)), SQLite::OPEN_READONLY);
+		SQLite::Statement Stmt(Db, std::string(TCHAR_TO_UTF8(*SQL)));
+
+		for (int32 Idx = 0; Idx < Stmt.getColumnCount(); ++Idx)
+		{
+			FDbQueryColumn& Column = OutDescription.Columns.AddDefaulted_GetRef();
+			Column.Name = UTF8_TO_TCHAR(Stmt.getColumnName(Idx));
+
+			// Expressions have no declared type
+			const char* DeclaredType = sqlite3_column_decltype(Stmt.getStatementHandle(), Idx);
+			Column.DeclaredType = DeclaredType ? UTF8_TO_TCHAR(DeclaredType) : L"";
+			Column.Type = GetDeclaredTypeAffinity(Column.DeclaredType);
+		}
+
+		for (int32 Idx = 1; Idx <= Stmt.getBindParameterCount(); ++Idx)
+		{
+			// Name keeps its prefix (:, @ or $), anonymous parameters have no name
+			const char* Name = sqlite3_bind_parameter_name(Stmt.getStatementHandle(), Idx);
+			OutDescription.Params.Add(Name ? FString(UTF8_TO_TCHAR(Name + 1)) : FString());
+		}
+
+		return true;
+	}
+	catch (SQLite::Exception& e)
+	{
+		OutError = UTF8_TO_TCHAR(e.getErrorStr());
+	}
+
+	return false;
+}
+
+SmoothSql::FScopedSavepoint::FScopedSavepoint(SQLite::Database& InDb, const FString& InName):
+	Db(InDb),
+	Name(QuoteIdentifier(InName))
+{
+	Db.exec(std::string("SAVEPOINT ") + TCHAR_TO_UTF8(*Name));
+}
+
+SmoothSql::FScopedSavepoint::~FScopedSavepoint()
+{
+	if (bReleased)
+	{
+		return;
+	}
+
+	// ROLLBACK TO keeps savepoint on the stack, RELEASE ends transaction it began
+	try
+	{
+		Db.exec(std::string("ROLLBACK TO SAVEPOINT ") + TCHAR_TO_UTF8(*Name));
+		Db.exec(std::string("RELEASE SAVEPOINT ") + TCHAR_TO_UTF8(*Name));
+	}
+	catch (SQLite::Exception& e)
+	{
+		UE_LOG(LogSmoothSqlite, Error, L"Failed to roll back savepoint %s: %s", *Name, UTF8_TO_TCHAR(e.getErrorStr()));
+	}
+}
+
+void SmoothSql::FScopedSavepoint::Release()
+{
+	Db.exec(std::string("RELEASE SAVEPOINT ") + TCHAR_TO_UTF8(*Name));
+	bReleased = true;
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "OpenDbConnectionAsync.generated.h"
+
+class UDbObject;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDbConnectionOpenedPin, UDbObject*, Connection);
+
+/**
+ * Opens connection and runs warm-up on worker thread so map loads don't hitch
+ */
+UCLASS()
+class SMOOTHSQL_API UOpenDbConnectionAsync : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+	void OnOpened(UDbObject* Connection);
+
+public:
+
+	/// Connection is ready to use
+	UPROPERTY(BlueprintAssignable)
+	FDbConnectionOpenedPin Opened;
+
+	/// Database could not be opened
+	UPROPERTY(BlueprintAssignable)
+	FDbConnectionOpenedPin Failed;
+
+	/**
+	 * @brief Open connection asynchronously
+	 * @param OpenFlags Bitmask of EDbOpenFlags
+	 * @param bUseDefaultWarmup Use warm-up from Database Settings instead of Warmup param
+	 */
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", AdvancedDisplay = "Warmup"), Category = "SmoothSqlite|Connection")
+	static UOpenDbConnectionAsync* OpenDbConnectionAsync(UObject* WorldContextObject, UPARAM(meta = (Bitmask, BitmaskEnum="EDbOpenFlags")) int32 OpenFlags, bool bUseDefaultWarmup, const FDbWarmupParams& Warmup);
+
+	virtual void Activate() override;
+
+private:
+
+	int32 OpenFlags;				///< EDbOpenFlags bitmask
+	bool bUseDefaultWarmup;			///< Ignore Warmup and use settings
+	FDbWarmupParams Warmup;			///< Warm-up to run before connection is handed back
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+
+struct sqlite3_stmt;
+struct sqlite3_context;
+
+namespace SmoothSql
+{
+	/// Struct member filled from result column
+	struct FDbPropertyBinding
+	{
+		const FProperty* Property;	///< Member of the struct
+		int32 Column;				///< Index of the result column
+	};
+
+	/**
+	 * @brief Can property be read from or written to a column
+	 */
+	bool IsSupportedProperty(const FProperty* Property);
+
+	/**
+	 * @brief Match struct members to result columns by name, case insensitive
+	 *
+	 * Members without matching column or of unsupported type are skipped
+	 */
+	void BuildStructBindings(const UScriptStruct* Struct, sqlite3_stmt* Stmt, TArray<FDbPropertyBinding>& OutBindings);
+
+	/**
+	 * @brief Copy column of current row into property value, NULL resets value
+	 */
+	void ReadColumn(const FProperty* Property, void* ValuePtr, sqlite3_stmt* Stmt, int32 Column);
+
+	/**
+	 * @brief Copy columns of current row into struct
+	 */
+	void ReadRow(const TArray<FDbPropertyBinding>& Bindings, void* StructPtr, sqlite3_stmt* Stmt);
+
+	/**
+	 * @brief Declared SQL type of column holding property
+	 */
+	const TCHAR* GetColumnType(const FProperty* Property);
+
+	/**
+	 * @brief Copy property value into value of matching storage class
+	 */
+	FSqliteValue GetPropertyValue(const FProperty* Property, const void* ValuePtr);
+
+	/**
+	 * @brief Bind text to statement parameter
+	 * @param Param 1-based index of the parameter
+	 */
+	void BindText(sqlite3_stmt* Stmt, int32 Param, const FString& Text);
+
+	/**
+	 * @brief Bind property value to statement parameter
+	 * @param Param 1-based index of the parameter
+	 */
+	void BindProperty(const FProperty* Property, const void* ValuePtr, sqlite3_stmt* Stmt, int32 Param);
+
+	/**
+	 * @brief Set property value as result of SQL function or virtual table column
+	 */
+	void ResultProperty(const FProperty* Property, const void* ValuePtr, sqlite3_context* Context);
+}
@@ -0,0 +1,412 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+#include "SmoothSqliteUtils.h"
+#include "Containers/StringView.h"
+#include "sqlite3.h"
+
+#include <exception>
+#include <utility>
+
+/**
+ * Typed SQL functions
+ *
+ * Arguments are unpacked from sqlite3_value and results packed by TSqlArg/TSqlResult specializations
+ * chosen at compile time, so a C++ function with a plain signature can be called from SQL:
+ *
+ * @code
+ * Db->RegisterScalar<int64(FStringView, double)>(L"score", [](FStringView Name, double Level) { ... });
+ * Db->RegisterAggregate<FMyState>(L"my_sum", [](FMyState& State, int64 Value) { ... }, [](const FMyState& State) { ... });
+ * @endcode
+ */
+namespace SmoothSql
+{
+	/// Unpacks sqlite3_value into T. Storage keeps converted data alive while the function runs
+	template<typename T>
+	struct TSqlArg;
+
+	template<>
+	struct TSqlArg<int32>
+	{
+		using FStorage = int32;
+		static FStorage Read(sqlite3_value* Value) { return sqlite3_value_int(Value); }
+		static int32 Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<int64>
+	{
+		using FStorage = int64;
+		static FStorage Read(sqlite3_value* Value) { return sqlite3_value_int64(Value); }
+		static int64 Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<bool>
+	{
+		using FStorage = bool;
+		static FStorage Read(sqlite3_value* Value) { return sqlite3_value_int(Value) != 0; }
+		static bool Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<double>
+	{
+		using FStorage = double;
+		static FStorage Read(sqlite3_value* Value) { return sqlite3_value_double(Value); }
+		static double Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<float>
+	{
+		using FStorage = float;
+		static FStorage Read(sqlite3_value* Value) { return static_cast<float>(sqlite3_value_double(Value)); }
+		static float Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<FString>
+	{
+		using FStorage = FString;
+		static FStorage Read(sqlite3_value* Value)
+		{
+			const ANSICHAR* Text = reinterpret_cast<const ANSICHAR*>(sqlite3_value_text(Value));
+			return SmoothSql::Utf8ToString(Text, sqlite3_value_bytes(Value));
+		}
+		static const FString& Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<FStringView> : TSqlArg<FString>
+	{
+		static FStringView Get(const FStorage& Storage) { return FStringView(*Storage, Storage.Len()); }
+	};
+
+	template<>
+	struct TSqlArg<FName>
+	{
+		using FStorage = FName;
+		static FStorage Read(sqlite3_value* Value)
+		{
+			const ANSICHAR* Text = reinterpret_cast<const ANSICHAR*>(sqlite3_value_text(Value));
+			return SmoothSql::Utf8ToName(Text, sqlite3_value_bytes(Value));
+		}
+		static FName Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<TArray<uint8>>
+	{
+		using FStorage = TArray<uint8>;
+		static FStorage Read(sqlite3_value* Value)
+		{
+			const uint8* Data = static_cast<const uint8*>(sqlite3_value_blob(Value));
+			return FStorage(Data, sqlite3_value_bytes(Value));
+		}
+		static const TArray<uint8>& Get(const FStorage& Storage) { return Storage; }
+	};
+
+	template<>
+	struct TSqlArg<FSqliteValue>
+	{
+		using FStorage = FSqliteValue;
+		SMOOTHSQL_API static FStorage Read(sqlite3_value* Value);
+		static const FSqliteValue& Get(const FStorage& Storage) { return Storage; }
+	};
+
+	/// Packs T into result of sqlite3_context
+	template<typename T>
+	struct TSqlResult;
+
+	template<>
+	struct TSqlResult<int32>
+	{
+		static void Write(sqlite3_context* Context, int32 Value) { sqlite3_result_int(Context, Value); }
+	};
+
+	template<>
+	struct TSqlResult<int64>
+	{
+		static void Write(sqlite3_context* Context, int64 Value) { sqlite3_result_int64(Context, Value); }
+	};
+
+	template<>
+	struct TSqlResult<bool>
+	{
+		static void Write(sqlite3_context* Context, bool Value) { sqlite3_result_int(Context, Value ? 1 : 0); }
+	};
+
+	template<>
+	struct TSqlResult<double>
+	{
+		static void Write(sqlite3_context* Context, double Value) { sqlite3_result_double(Context, Value); }
+	};
+
+	template<>
+	struct TSqlResult<float>
+	{
+		static void Write(sqlite3_context* Context, float Value) { sqlite3_result_double(Context, Value); }
+	};
+
+	template<>
+	struct TSqlResult<FString>
+	{
+		static void Write(sqlite3_context* Context, const FString& Value)
+		{
+			const FTCHARToUTF8 Converted(*Value);
+			sqlite3_result_text(Context, Converted.Get(), Converted.Length(), SQLITE_TRANSIENT);
+		}
+	};
+
+	template<>
+	struct TSqlResult<FName>
+	{
+		static void Write(sqlite3_context* Context, FName Value) { TSqlResult<FString>::Write(Context, Value.ToString()); }
+	};
+
+	template<>
+	struct TSqlResult<TArray<uint8>>
+	{
+		static void Write(sqlite3_context* Context, const TArray<uint8>& Value)
+		{
+			sqlite3_result_blob(Context, Value.GetData(), Value.Num(), SQLITE_TRANSIENT);
+		}
+	};
+
+	template<>
+	struct TSqlResult<FSqliteValue>
+	{
+		SMOOTHSQL_API static void Write(sqlite3_context* Context, const FSqliteValue& Value);
+	};
+
+	/// Unset optional is NULL
+	template<typename T>
+	struct TSqlResult<TOptional<T>>
+	{
+		static void Write(sqlite3_context* Context, const TOptional<T>& Value)
+		{
+			if (Value.IsSet())
+			{
+				TSqlResult<T>::Write(Context, Value.GetValue());
+			}
+			else
+			{
+				sqlite3_result_null(Context);
+			}
+		}
+	};
+
+	/// Signature of a callable
+	template<typename T>
+	struct TCallableSignature : TCallableSignature<decltype(&T::operator())> {};
+
+	template<typename R, typename... A>
+	struct TCallableSignature<R(*)(A...)> { using Type = R(A...); };
+
+	template<typename C, typename R, typename... A>
+	struct TCallableSignature<R(C::*)(A...)> { using Type = R(A...); };
+
+	template<typename C, typename R, typename... A>
+	struct TCallableSignature<R(C::*)(A...) const> { using Type = R(A...); };
+
+	/// Number of arguments of function type
+	template<typename T>
+	struct TSignatureArity;
+
+	template<typename R, typename... A>
+	struct TSignatureArity<R(A...)> { static constexpr int32 Value = sizeof...(A); };
+
+	/// Everything sqlite3_create_function_v2 needs, App is owned by Destroy
+	struct FDbUserFunction
+	{
+		int32 NumArgs = 0;
+		bool bDeterministic = true;
+		void* App = nullptr;
+		void (*Func)(sqlite3_context*, int, sqlite3_value**) = nullptr;
+		void (*Step)(sqlite3_context*, int, sqlite3_value**) = nullptr;
+		void (*Final)(sqlite3_context*) = nullptr;
+		void (*Destroy)(void*) = nullptr;
+	};
+
+	/**
+	 * @brief Register function on the connection and on every connection opened to the same file afterwards, see UDbObject::OpenRawDb
+	 *
+	 * Takes ownership of Function.App, it is destroyed once the last connection using it drops it.
+	 * Replaces function with the same name and number of arguments, function without callbacks is removed
+	 * @param Owner Functions are forgotten by RemoveSharedFunctions of their owner
+	 * @return SQLite result code of registering on Db
+	 */
+	SMOOTHSQL_API int32 AddSharedFunction(sqlite3* Db, const FString& DbPath, const FString& Name, const FDbUserFunction& Function, const void* Owner);
+
+	/**
+	 * @brief Stop registering functions added by Owner on new connections, open connections keep them
+	 */
+	SMOOTHSQL_API void RemoveSharedFunctions(const void* Owner);
+
+	/**
+	 * @brief Register functions added for database at DbPath on the connection
+	 */
+	SMOOTHSQL_API void CreateSharedFunctions(sqlite3* Db, const FString& DbPath);
+
+	namespace UserFunctions
+	{
+		template<typename T>
+		using TArgOf = TSqlArg<typename TDecay<T>::Type>;
+
+		template<typename T>
+		using TResultOf = TSqlResult<typename TDecay<T>::Type>;
+
+		template<typename TSignature>
+		struct TScalar;
+
+		template<typename R, typename... A>
+		struct TScalar<R(A...)>
+		{
+			using FFunc = TFunction<R(A...)>;
+
+			static void Call(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+			{
+				FFunc& Func = *static_cast<FFunc*>(sqlite3_user_data(Context));
+				Invoke(Func, Context, Args, std::index_sequence_for<A...>());
+			}
+
+			/// Call Func with unpacked arguments, report exceptions as SQL errors
+			template<size_t... I>
+			static void Invoke(FFunc& Func, sqlite3_context* Context, sqlite3_value** Args, std::index_sequence<I...>)
+			{
+				try
+				{
+					const auto Storage = MakeTuple(TArgOf<A>::Read(Args[I])...);
+					TResultOf<R>::Write(Context, Func(TArgOf<A>::Get(Storage.template Get<I>())...));
+				}
+				catch (std::exception& e)
+				{
+					sqlite3_result_error(Context, e.what(), -1);
+				}
+			}
+
+			static void Destroy(void* App)
+			{
+				delete static_cast<FFunc*>(App);
+			}
+		};
+
+		template<typename TState, typename TStepSignature, typename TFinalSignature>
+		struct TAggregate;
+
+		template<typename TState, typename... A, typename R, typename S>
+		struct TAggregate<TState, void(TState&, A...), R(S)>
+		{
+			struct FFuncs
+			{
+				TFunction<void(TState&, A...)> Step;
+				TFunction<R(const TState&)> Final;
+			};
+
+			/// State lives on the heap, aggregate context holds pointer to it
+			static TState* GetState(sqlite3_context* Context, bool bCreate)
+			{
+				TState** State = static_cast<TState**>(sqlite3_aggregate_context(Context, bCreate ? sizeof(TState*) : 0));
+				if (State && !*State && bCreate)
+				{
+					*State = new TState();
+				}
+				return State ? *State : nullptr;
+			}
+
+			static void Step(sqlite3_context* Context, int NumArgs, sqlite3_value** Args)
+			{
+				FFuncs& Funcs = *static_cast<FFuncs*>(sqlite3_user_data(Context));
+				TState* State = GetState(Context, true);
+				if (!State)
+				{
+					sqlite3_result_error_nomem(Context);
+					return;
+				}
+
+				StepInvoke(Funcs, *State, Context, Args, std::index_sequence_for<A...>());
+			}
+
+			template<size_t... I>
+			static void StepInvoke(FFuncs& Funcs, TState& State, sqlite3_context* Context, sqlite3_value** Args, std::index_sequence<I...>)
+			{
+				try
+				{
+					const auto Storage = MakeTuple(TArgOf<A>::Read(Args[I])...);
+					Funcs.Step(State, TArgOf<A>::Get(Storage.template Get<I>())...);
+				}
+				catch (std::exception& e)
+				{
+					sqlite3_result_error(Context, e.what(), -1);
+				}
+			}
+
+			static void Final(sqlite3_context* Context)
+			{
+				FFuncs& Funcs = *static_cast<FFuncs*>(sqlite3_user_data(Context));
+
+				// No rows, finalize default state
+				TState* State = GetState(Context, false);
+				const TState Empty {};
+				try
+				{
+					TResultOf<R>::Write(Context, Funcs.Final(State ? *State : Empty));
+				}
+				catch (std::exception& e)
+				{
+					sqlite3_result_error(Context, e.what(), -1);
+				}
+				delete State;
+			}
+
+			static void Destroy(void* App)
+			{
+				delete static_cast<FFuncs*>(App);
+			}
+		};
+	}
+
+	/**
+	 * @brief Describe scalar function with explicit signature, e.g. int64(FStringView, double)
+	 * @param bDeterministic Same arguments always give the same result, function can be used in indexes
+	 */
+	template<typename TSignature, typename FuncType>
+	FDbUserFunction MakeScalarFunction(FuncType&& Func, bool bDeterministic = true)
+	{
+		using FScalar = UserFunctions::TScalar<TSignature>;
+
+		FDbUserFunction Function;
+		Function.NumArgs = TSignatureArity<TSignature>::Value;
+		Function.bDeterministic = bDeterministic;
+		Function.App = new typename FScalar::FFunc(Forward<FuncType>(Func));
+		Function.Func = &FScalar::Call;
+		Function.Destroy = &FScalar::Destroy;
+		return Function;
+	}
+
+	/**
+	 * @brief Describe aggregate function, argument types are taken from Step
+	 * @param Step void(TState&, Args...), called for every row
+	 * @param Final Result(const TState&), called once, with default constructed state if there were no rows
+	 */
+	template<typename TState, typename StepType, typename FinalType>
+	FDbUserFunction MakeAggregateFunction(StepType&& Step, FinalType&& Final, bool bDeterministic = true)
+	{
+		using FStepSignature = typename TCallableSignature<typename TDecay<StepType>::Type>::Type;
+		using FFinalSignature = typename TCallableSignature<typename TDecay<FinalType>::Type>::Type;
+		using FAggregate = UserFunctions::TAggregate<TState, FStepSignature, FFinalSignature>;
+
+		FDbUserFunction Function;
+		Function.NumArgs = TSignatureArity<FStepSignature>::Value - 1;
+		Function.bDeterministic = bDeterministic;
+		Function.App = new typename FAggregate::FFuncs{ Forward<StepType>(Step), Forward<FinalType>(Final) };
+		Function.Step = &FAggregate::Step;
+		Function.Final = &FAggregate::Final;
+		Function.Destroy = &FAggregate::Destroy;
+		return Function;
+	}
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace SQLite
+{
+	class Database;
+}
+
+/**
+ * SQL functions over vectors and rotations stored as blobs
+ *
+ * Vector is three little-endian 32-bit floats (X, Y, Z), quaternion is four (X, Y, Z, W).
+ * Functions return NULL when an argument is not a blob of the right size.
+ *
+ *   vec(x, y, z), quat(x, y, z, w)		build blobs
+ *   vec_dist(a, b), vec_dot(a, b)		distance and dot product
+ *   box_contains(min, max, point)		1 if point is inside the box, bounds inclusive
+ *   quat_angle(a, b)					angle between rotations, in degrees
+ *   avg_vec(v)							aggregate, average of non-NULL vectors
+ */
+namespace SmoothSql
+{
+	constexpr int32 VectorBlobSize = 3 * sizeof(float);
+	constexpr int32 QuatBlobSize = 4 * sizeof(float);
+
+	SMOOTHSQL_API TArray<uint8> EncodeVector(const FVector& Vector);
+	SMOOTHSQL_API TArray<uint8> EncodeQuat(const FQuat& Quat);
+
+	/**
+	 * @return False if Data is not an encoded vector
+	 */
+	SMOOTHSQL_API bool DecodeVector(const uint8* Data, int32 Size, FVector& Vector);
+
+	/**
+	 * @return False if Data is not an encoded quaternion
+	 */
+	SMOOTHSQL_API bool DecodeQuat(const uint8* Data, int32 Size, FQuat& Quat);
+
+	/**
+	 * @brief Register vector functions on the connection
+	 */
+	SMOOTHSQL_API void RegisterVectorFunctions(SQLite::Database& Db);
+}
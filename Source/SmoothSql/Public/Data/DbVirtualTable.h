@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDataTable;
+struct sqlite3;
+
+/**
+ * Read-only virtual tables over rows that live in engine memory
+ *
+ * Columns are the supported members of the row struct, named as authored, and DataTables get RowName as the first column.
+ * Rows are read in place when SQL asks for a column, nothing is copied into the database.
+ * Equality on the key column (RowName, or the column given at registration) is handled by the table:
+ * a DataTable finds the row by name, an array compares the key member without converting other columns.
+ *
+ * Engine data is not guarded, so statements reading these tables must run on the game thread
+ * and rows must not be added or removed while such a statement is stepped.
+ */
+namespace SmoothSql
+{
+	/// Rows exposed to SQL by a virtual table
+	class SMOOTHSQL_API FDbVirtualRows
+	{
+	public:
+		virtual ~FDbVirtualRows() = default;
+
+		/// Struct of every row
+		virtual const UScriptStruct* GetStruct() const = 0;
+
+		/// Rows have names, exposed as RowName column
+		virtual bool HasRowNames() const { return false; }
+
+		/**
+		 * @brief Collect rows at the start of a scan
+		 * @param Names Filled with names of rows if HasRowNames
+		 */
+		virtual void GetRows(TArray<const uint8*>& Rows, TArray<FName>& Names) const = 0;
+
+		/**
+		 * @brief Row with the name, sources with row names only
+		 */
+		virtual const uint8* FindRow(FName Name) const { return nullptr; }
+	};
+
+	/// Elements of TArray of structs, array must outlive the virtual table
+	class SMOOTHSQL_API FDbStructArrayRows : public FDbVirtualRows
+	{
+	public:
+		FDbStructArrayRows(const UScriptStruct* InStruct, const FScriptArray* InArray)
+			: Struct(InStruct)
+			, Array(InArray)
+		{}
+
+		template<typename T>
+		static TSharedRef<FDbVirtualRows> Make(const TArray<T>& Array)
+		{
+			// TArray with default allocator has the layout of FScriptArray
+			return MakeShared<FDbStructArrayRows>(T::StaticStruct(), reinterpret_cast<const FScriptArray*>(&Array));
+		}
+
+		virtual const UScriptStruct* GetStruct() const override { return Struct; }
+		virtual void GetRows(TArray<const uint8*>& Rows, TArray<FName>& Names) const override;
+
+	private:
+		const UScriptStruct* Struct;
+		const FScriptArray* Array;
+	};
+
+	/// Rows of DataTable, no rows if table is garbage collected
+	class SMOOTHSQL_API FDbDataTableRows : public FDbVirtualRows
+	{
+	public:
+		explicit FDbDataTableRows(const UDataTable* InTable);
+
+		virtual const UScriptStruct* GetStruct() const override { return Struct; }
+		virtual bool HasRowNames() const override { return true; }
+		virtual void GetRows(TArray<const uint8*>& Rows, TArray<FName>& Names) const override;
+		virtual const uint8* FindRow(FName Name) const override;
+
+	private:
+		TWeakObjectPtr<const UDataTable> Table;
+		const UScriptStruct* Struct;
+	};
+
+	/// Virtual table waiting to be created by CREATE VIRTUAL TABLE ... USING smoothsql_rows
+	struct FDbVirtualTableSource
+	{
+		TSharedPtr<FDbVirtualRows> Rows;
+		FString KeyColumn;		///< Column handled by equality lookups, RowName if empty and rows have names
+	};
+
+	/// Sources by table name
+	using FDbVirtualTableSources = TMap<FString, FDbVirtualTableSource>;
+
+	/// Name of the module in CREATE VIRTUAL TABLE
+	constexpr const char* VirtualTableModule = "smoothsql_rows";
+
+	/**
+	 * @brief Register module on the connection, tables find their rows in Sources by name
+	 *
+	 * Sources must outlive the connection
+	 * @return sqlite result code
+	 */
+	SMOOTHSQL_API int RegisterVirtualTableModule(sqlite3* Db, const FDbVirtualTableSources* Sources);
+}
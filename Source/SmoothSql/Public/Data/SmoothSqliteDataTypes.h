@@ -6,6 +6,11 @@
 #include "SQLiteCpp/Column.h"
 #include "SmoothSqliteDataTypes.generated.h"
 
+namespace SQLite
+{
+	class Statement;
+}
+
 
 UENUM(meta=(Bitflags))
 enum class EDbOpenFlags : uint8
@@ -39,6 +44,15 @@ enum class EDbTransactionFlags : uint8
 	Exclusive
 };
 
+/// Why the last step of a statement was interrupted
+UENUM(BlueprintType)
+enum class EDbInterruptReason : uint8
+{
+	None,
+	Cancelled,
+	TimedOut
+};
+
 USTRUCT(BlueprintType)
 struct FSqliteDBConnectionParms
 {
@@ -52,9 +66,643 @@ struct FSqliteDBConnectionParms
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="DBConnectionParams")
 	int32 BusyTimeout = 0;
+
+	// Number of SQLite VM instructions between cancel/deadline checks (0 disables the progress handler)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="DBConnectionParams", meta=(ClampMin=0))
+	int32 ProgressHandlerPeriod = 1000;
+
+	// Time budget applied to every step of newly prepared statements, in milliseconds (0 means unlimited)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="DBConnectionParams", meta=(ClampMin=0))
+	float DefaultStatementTimeBudgetMs = 0.f;
+};
+
+/// Database file attached to a connection under its own schema name
+USTRUCT(BlueprintType)
+struct FDbAttachParams
+{
+	GENERATED_BODY()
+
+	// Schema name tables of attached database are qualified with, e.g. save.inventory
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Attach")
+	FString Alias;
+
+	// Location of attached database, only DBName and Folder are used
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Attach")
+	FSqliteDBConnectionParms Database;
+
+	// PRAGMAs applied to the schema once attached, e.g. cache_size = -4000, journal_mode = WAL
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Attach")
+	TMap<FString, FString> Pragmas;
+};
+
+
+
+
+/// Work done on worker thread while connection is opened asynchronously
+USTRUCT(BlueprintType)
+struct FDbWarmupParams
+{
+	GENERATED_BODY()
+
+	// Queries stepped to completion to pull indexes and tables into page cache
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Warmup")
+	TArray<FString> WarmupQueries;
+
+	// Statements prepared up front, first PrepareCached with the same SQL gets them for free
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Warmup")
+	TArray<FString> HotStatements;
+
+	// Run PRAGMA quick_check before handing connection back (slow on big databases)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Warmup")
+	bool bRunQuickCheck = false;
+};
+
+/// Retrying of transactions that failed with SQLITE_BUSY or SQLITE_LOCKED
+USTRUCT(BlueprintType)
+struct SMOOTHSQL_API FDbRetrySettings
+{
+	GENERATED_BODY()
+
+	// Total number of tries, including the first one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Retry", meta=(ClampMin=1))
+	int32 MaxAttempts = 5;
+
+	// Backoff before the first retry, doubled on every next one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Retry", meta=(ClampMin=0))
+	float InitialBackoffMs = 2.f;
+
+	// Upper bound of the backoff
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Retry", meta=(ClampMin=0))
+	float MaxBackoffMs = 250.f;
+
+	/**
+	 * @brief Randomized (full jitter) delay before retry
+	 * @param Retry 0-based number of the retry
+	 */
+	float GetBackoffSeconds(int32 Retry) const;
+};
+
+/// Batching of the group commit writer
+USTRUCT(BlueprintType)
+struct FDbGroupCommitSettings
+{
+	GENERATED_BODY()
+
+	// How long writer waits for other submitters after the first write of a batch arrives
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GroupCommit", meta=(ClampMin=0))
+	int32 WindowMicroseconds = 2000;
+
+	// Batch is committed right away once this many writes are pending
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GroupCommit", meta=(ClampMin=1))
+	int32 MaxWritesPerCommit = 256;
+
+	// Busy timeout of the writer connection in milliseconds, so BEGIN IMMEDIATE waits out writes of other connections
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GroupCommit", meta=(ClampMin=0))
+	int32 BusyTimeoutMs = 1000;
+
+	// Re-running of batch that still found database busy after the busy timeout
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GroupCommit")
+	FDbRetrySettings Retry;
+};
+
+/// How shard set maps shard key to a shard
+UENUM(BlueprintType)
+enum class EDbShardRouting : uint8
+{
+	Hash,			///< Hash of the key modulo number of shards
+	Range			///< First shard whose upper bound is above integer key
+};
+
+/// Files and routing of a shard set
+USTRUCT(BlueprintType)
+struct FDbShardSetParams
+{
+	GENERATED_BODY()
+
+	// Shard i is stored in file DBName_i in Folder
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shards")
+	FSqliteDBConnectionParms Database;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shards", meta=(ClampMin=1))
+	int32 NumShards = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shards")
+	EDbShardRouting Routing = EDbShardRouting::Hash;
+
+	// Exclusive upper bounds of keys of shards 0..NumShards-2 in ascending order, last shard takes the rest (Range routing)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shards")
+	TArray<int64> RangeUpperBounds;
+
+	// Batching of per-shard writers
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Shards")
+	FDbGroupCommitSettings WriterSettings;
+};
+
+/// How rows of all shards are combined
+USTRUCT(BlueprintType)
+struct FDbShardMerge
+{
+	GENERATED_BODY()
+
+	// Column to sort merged rows by, shard order is kept if INDEX_NONE
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Merge")
+	int32 OrderByColumn = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Merge")
+	bool bDescending = false;
+
+	// Maximum number of merged rows, 0 means unlimited. Shard queries may use the same ORDER BY and LIMIT to return less
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Merge", meta=(ClampMin=0))
+	int32 Limit = 0;
+};
+
+/// Outcome of a single write submitted to the group commit writer
+USTRUCT(BlueprintType)
+struct FDbWriteResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="WriteResult")
+	bool bSuccess = false;
+
+	UPROPERTY(BlueprintReadOnly, Category="WriteResult")
+	int32 Changes = 0;
+};
+
+/// Flushing of the write-behind queue
+USTRUCT(BlueprintType)
+struct FDbWriteBehindSettings
+{
+	GENERATED_BODY()
+
+	// Buffered upserts are flushed this often
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="WriteBehind", meta=(ClampMin=0))
+	float FlushIntervalSeconds = 1.f;
+
+	// Buffer is flushed right away once this many distinct rows are pending
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="WriteBehind", meta=(ClampMin=1))
+	int32 MaxPendingRows = 1024;
+};
+
+/// Counters of the connection
+USTRUCT(BlueprintType)
+struct FDbConnectionStats
+{
+	GENERATED_BODY()
+
+	// Transactions committed by RunTransactionWithRetry
+	UPROPERTY(BlueprintReadOnly, Category="Stats")
+	int32 TransactionsCommitted = 0;
+
+	// Times a transaction was re-run because database was busy or locked
+	UPROPERTY(BlueprintReadOnly, Category="Stats")
+	int32 TransactionRetries = 0;
+
+	// Transactions given up on
+	UPROPERTY(BlueprintReadOnly, Category="Stats")
+	int32 TransactionFailures = 0;
+
+	// Cached queries answered from the result cache
+	UPROPERTY(BlueprintReadOnly, Category="Stats")
+	int32 CacheHits = 0;
+
+	// Cached queries that had to run
+	UPROPERTY(BlueprintReadOnly, Category="Stats")
+	int32 CacheMisses = 0;
+};
+
+/// Result cache of the connection
+USTRUCT(BlueprintType)
+struct FDbResultCacheSettings
+{
+	GENERATED_BODY()
+
+	// Least recently used results are dropped above this many
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ResultCache", meta=(ClampMin=1))
+	int32 MaxEntries = 256;
+
+	// Results with more rows are not cached
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="ResultCache", meta=(ClampMin=1))
+	int32 MaxRowsPerEntry = 4096;
+};
+
+/// FTS5 index over columns of an existing table
+USTRUCT(BlueprintType)
+struct FDbFullTextIndex
+{
+	GENERATED_BODY()
+
+	// Name of FTS5 table
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	FString Name;
+
+	// Table with the text, index stores only tokens and reads text from here (external content)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	FString ContentTable;
+
+	// Integer primary key of ContentTable, search results are identified by it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	FString ContentRowId = L"rowid";
+
+	// Indexed columns of ContentTable
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	TArray<FString> Columns;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	FString Tokenizer = L"unicode61 remove_diacritics 2";
+
+	// Lengths of prefixes with their own index, speeds up prefix queries (term*)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	TArray<int32> PrefixLengths;
+};
+
+/// Ranking and decoration of full-text search results
+USTRUCT(BlueprintType)
+struct FDbFullTextQuery
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText", meta=(ClampMin=1))
+	int32 Limit = 20;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText", meta=(ClampMin=0))
+	int32 Offset = 0;
+
+	// bm25 weights of indexed columns, 1 for missing ones
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	TArray<float> ColumnWeights;
+
+	// Index of column to make snippet and highlight of, INDEX_NONE to skip them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	int32 TextColumn = INDEX_NONE;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	FString MarkOpen = L"<b>";
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	FString MarkClose = L"</b>";
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText")
+	FString Ellipsis = L"...";
+
+	// Maximum number of tokens in snippet
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FullText", meta=(ClampMin=1, ClampMax=64))
+	int32 SnippetTokens = 16;
+};
+
+/// Row matched by full-text search
+USTRUCT(BlueprintType)
+struct FDbFullTextHit
+{
+	GENERATED_BODY()
+
+	// ContentRowId of the row
+	UPROPERTY(BlueprintReadOnly, Category="FullText")
+	int64 RowId = 0;
+
+	// bm25 score, lower is better
+	UPROPERTY(BlueprintReadOnly, Category="FullText")
+	float Rank = 0.f;
+
+	// Fragment of TextColumn around matches, with marks
+	UPROPERTY(BlueprintReadOnly, Category="FullText")
+	FString Snippet;
+
+	// Whole TextColumn, with marks
+	UPROPERTY(BlueprintReadOnly, Category="FullText")
+	FString Highlight;
+};
+
+/// Kind of row change
+UENUM(BlueprintType)
+enum class EDbChangeOp : uint8
+{
+	Insert,
+	Update,
+	Delete
+};
+
+/// Row changed by committed transaction
+USTRUCT(BlueprintType)
+struct FDbChangeEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="ChangeFeed")
+	FString Table;
+
+	UPROPERTY(BlueprintReadOnly, Category="ChangeFeed")
+	EDbChangeOp Op = EDbChangeOp::Insert;
+
+	UPROPERTY(BlueprintReadOnly, Category="ChangeFeed")
+	int64 RowId = 0;
+};
+
+/// Why a change of changeset could not be applied as is
+UENUM(BlueprintType)
+enum class EDbConflictType : uint8
+{
+	Data,			///< Row exists, but its values differ from the original ones
+	NotFound,		///< Row to update or delete doesn't exist
+	Conflict,		///< Row to insert already exists
+	Constraint,		///< Change violates constraint
+	ForeignKey		///< Applied changeset violates foreign keys
+};
+
+/// What to do with a conflicting change
+UENUM(BlueprintType)
+enum class EDbConflictAction : uint8
+{
+	Omit,			///< Skip the change
+	Replace,		///< Overwrite the row (Data and Conflict only)
+	Abort			///< Roll back whole changeset
+};
+
+/// Change of changeset that conflicts with the database
+USTRUCT(BlueprintType)
+struct FDbChangesetConflict
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Changeset")
+	FString Table;
+
+	UPROPERTY(BlueprintReadOnly, Category="Changeset")
+	EDbChangeOp Op = EDbChangeOp::Insert;
+
+	UPROPERTY(BlueprintReadOnly, Category="Changeset")
+	EDbConflictType Type = EDbConflictType::Data;
+};
+
+/// Table created and filled by bulk import
+USTRUCT(BlueprintType)
+struct FDbImportSettings
+{
+	GENERATED_BODY()
+
+	// Table to create
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Import")
+	FString Table;
+
+	// Column declared PRIMARY KEY, e.g. RowName, rows are keyed by rowid if empty
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Import")
+	FString PrimaryKey;
+
+	// Indexes created once rows are loaded, one per entry, comma separated columns make a composite index
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Import")
+	TArray<FString> Indexes;
+
+	// Drop existing table first, otherwise import fails if it exists
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Import")
+	bool bReplaceTable = false;
+
+	// Rows inserted per transaction, ignored if import runs inside an open transaction
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Import", meta=(ClampMin=1))
+	int32 RowsPerTransaction = 100000;
+
+	// Run with synchronous=OFF, database may be corrupted if power is lost during import
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Import")
+	bool bFastLoad = true;
+};
+
+/// Outcome of bulk import
+USTRUCT(BlueprintType)
+struct FDbImportResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Import")
+	bool bSuccess = false;
+
+	// Rows committed, failed import keeps rows of batches committed before the failure
+	UPROPERTY(BlueprintReadOnly, Category="Import")
+	int64 Rows = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Import")
+	float Seconds = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category="Import")
+	float RowsPerSecond = 0.f;
+};
+
+/// What index advisor tracks
+USTRUCT(BlueprintType)
+struct FDbIndexAdvisorSettings
+{
+	GENERATED_BODY()
+
+	// Statements whose runs stepped through fewer full-scan rows in total are not reported
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="IndexAdvisor", meta=(ClampMin=0))
+	int32 MinFullScanSteps = 1000;
+
+	// Statements tracked at once, new offenders are ignored once full
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="IndexAdvisor", meta=(ClampMin=1))
+	int32 MaxStatements = 256;
+};
+
+/// Index that would help a statement doing full scans
+USTRUCT(BlueprintType)
+struct FDbIndexAdvice
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	FString Table;
+
+	// Columns of the index, equality columns first
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	TArray<FString> Columns;
+
+	// Statement creating the index
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	FString CreateSQL;
+
+	// Statement that needs the index
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	FString Query;
+
+	// Query with parameters of its first tracked run substituted, used by benchmark
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	FString SampleQuery;
+
+	// EXPLAIN QUERY PLAN of Query, one line per step
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	FString Plan;
+
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	int32 Runs = 0;
+
+	// Rows stepped by full scans over all runs
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	int64 FullScanSteps = 0;
+
+	// Automatic indexes built by sqlite over all runs
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	int32 AutoIndexes = 0;
+
+	// Average time of SampleQuery without and with the index, negative if not benchmarked
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	float MillisecondsBefore = -1.f;
+
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	float MillisecondsAfter = -1.f;
+
+	// Query plan picked the index in benchmark
+	UPROPERTY(BlueprintReadOnly, Category="IndexAdvisor")
+	bool bUsedByPlanner = false;
 };
 
+/// Step of schema migration
+USTRUCT(BlueprintType)
+struct FDbMigration
+{
+	GENERATED_BODY()
+
+	// Schema version after this step, versions of a migration list must be unique and above 0
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Migration", meta=(ClampMin=1))
+	int32 Version = 1;
+
+	// Short description, for logs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Migration")
+	FString Name;
+
+	// Statements of the step, must not change once released
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Migration", meta=(MultiLine=true))
+	FString SQL;
+};
+
+/// File format of exported rows
+UENUM(BlueprintType)
+enum class EDbExportFormat : uint8
+{
+	Csv,			///< RFC 4180, header line with column names
+	NdJson,			///< One JSON object per line
+	Columnar		///< Binary row groups stored column by column, see FDbStreamingExporter
+};
+
+/// Streaming export of query rows to file
+USTRUCT(BlueprintType)
+struct FDbExportSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Export")
+	EDbExportFormat Format = EDbExportFormat::Csv;
+
+	// Write line with column names, CSV only
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Export")
+	bool bHeader = true;
+
+	// Memory used to buffer output, rows are written to disk whenever it fills up
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Export", meta=(ClampMin=4))
+	int32 BufferKilobytes = 1024;
+
+	// Maximum rows in one row group, Columnar only
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Export", meta=(ClampMin=1))
+	int32 RowsPerGroup = 65536;
+
+	// Progress is reported every this many rows
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Export", meta=(ClampMin=1))
+	int32 ProgressInterval = 100000;
+};
+
+/// Outcome of streaming export
+USTRUCT(BlueprintType)
+struct FDbExportResult
+{
+	GENERATED_BODY()
 
+	UPROPERTY(BlueprintReadOnly, Category="Export")
+	bool bSuccess = false;
+
+	UPROPERTY(BlueprintReadOnly, Category="Export")
+	int64 Rows = 0;
+
+	// Size of written file
+	UPROPERTY(BlueprintReadOnly, Category="Export")
+	int64 Bytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Export")
+	float Seconds = 0.f;
+};
+
+/// Storage class of materialized value
+UENUM(BlueprintType)
+enum class EDbValueType : uint8
+{
+	Null,
+	Integer,
+	Float,
+	Text,
+	Blob
+};
+
+/// Materialized value of a single column that outlives the statement it was read from
+USTRUCT(BlueprintType)
+struct SMOOTHSQL_API FSqliteValue
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="SqliteValue")
+	EDbValueType Type = EDbValueType::Null;
+
+	UPROPERTY()
+	int64 Integer = 0;
+
+	UPROPERTY()
+	double Float = 0.0;
+
+	UPROPERTY()
+	FString Text;
+
+	UPROPERTY()
+	TArray<uint8> Blob;
+
+	/**
+	 * @brief Copy value of the column of current row
+	 */
+	static FSqliteValue FromColumn(const SQLite::Column& Column);
+
+	/**
+	 * @brief Bind this value to statement parameter
+	 * @param Index 1-based index of the parameter
+	 */
+	void BindTo(SQLite::Statement& Statement, int32 Index) const;
+
+	bool IsNull() const { return Type == EDbValueType::Null; }
+
+	bool operator==(const FSqliteValue& Other) const;
+	bool operator!=(const FSqliteValue& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FSqliteValue& Value) { return Value.GetHash(); }
+	uint32 GetHash() const;
+
+	/**
+	 * @brief Order values like ORDER BY with BINARY collation: NULL, numbers, text, blobs
+	 * @return Negative, zero or positive
+	 */
+	int32 Compare(const FSqliteValue& Other) const;
+
+	/// Conversions follow SQLite rules for the column getters
+	int64 AsInteger() const;
+	double AsFloat() const;
+	FString AsString() const;
+};
+
+/// Materialized row of a result set
+USTRUCT(BlueprintType)
+struct SMOOTHSQL_API FSqliteRow
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="SqliteRow")
+	TArray<FSqliteValue> Values;
+
+	/**
+	 * @brief Copy all columns of current row of the statement
+	 */
+	static FSqliteRow FromStatement(SQLite::Statement& Statement);
+};
 
 
 /// Wrapper over SQLite Column
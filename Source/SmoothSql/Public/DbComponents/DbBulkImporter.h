@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+
+class UDataTable;
+struct sqlite3_stmt;
+
+namespace SQLite
+{
+	class Database;
+	class Statement;
+}
+
+/**
+ * Creates a table and fills it from a DataTable, CSV or JSON file
+ *
+ * Rows go through one prepared INSERT, bound straight from struct members or file bytes,
+ * and are committed in batches of FDbImportSettings::RowsPerTransaction. Indexes are built after the load,
+ * which is much faster than updating them per row. Inside an already open transaction
+ * everything runs in that transaction and nothing is committed.
+ *
+ * Importer runs on the calling thread, connection must not be used by other threads meanwhile.
+ */
+class SMOOTHSQL_API FDbBulkImporter
+{
+public:
+
+	FDbBulkImporter(SQLite::Database& InDb, const FDbImportSettings& InSettings);
+	~FDbBulkImporter();
+
+	/**
+	 * @brief Import rows of DataTable, RowName is the first column and members of row struct follow
+	 */
+	FDbImportResult ImportDataTable(const UDataTable* Table);
+
+	/**
+	 * @brief Import UTF-8 CSV file, first line names the columns
+	 *
+	 * File is streamed, column types are guessed from the first row. Empty fields are NULL
+	 */
+	FDbImportResult ImportCsv(const FString& Path);
+
+	/**
+	 * @brief Import JSON file holding array of objects
+	 *
+	 * Columns are keys of the first object, nested arrays and objects are stored as JSON text
+	 */
+	FDbImportResult ImportJson(const FString& Path);
+
+private:
+
+	/// Column of the created table
+	struct FColumn
+	{
+		FString Name;
+		const TCHAR* Type;
+	};
+
+	/**
+	 * @brief Time import and clean up after it
+	 * @param Body Imports rows, returns false or throws SQLite::Exception on failure
+	 */
+	FDbImportResult Run(TFunctionRef<bool()> Body);
+
+	/**
+	 * @brief Set pragmas, begin transaction, create table and prepare insert
+	 */
+	void Begin(const TArray<FColumn>& Columns);
+
+	/**
+	 * @brief Insert row bound to Stmt, commit if batch is full
+	 */
+	void InsertRow();
+
+	/**
+	 * @brief Commit last batch and create indexes
+	 */
+	void Finish();
+
+	/**
+	 * @brief Roll back uncommitted rows and restore pragmas
+	 */
+	void Cleanup();
+
+	SQLite::Database& Db;
+	FDbImportSettings Settings;
+
+	TUniquePtr<SQLite::Statement> Insert;		///< INSERT with a parameter per column
+	sqlite3_stmt* Stmt = nullptr;				///< Handle of Insert, bound directly
+
+	bool bOwnTransaction = false;				///< Import commits its own batches
+	bool bInTransaction = false;				///< Batch transaction is open
+	int32 OldSynchronous = INDEX_NONE;			///< synchronous before fast load
+	int64 Rows = 0;								///< Rows inserted
+	int64 CommittedRows = 0;					///< Rows of committed batches
+	int32 RowsInBatch = 0;						///< Rows inserted since last commit
+};
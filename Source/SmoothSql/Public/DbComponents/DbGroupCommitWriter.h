@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+
+#include <atomic>
+
+namespace SQLite
+{
+	class Database;
+}
+
+/**
+ * Coalesces writes submitted from any thread into a single transaction
+ *
+ * Writer owns its own connection and thread. After the first write of a batch arrives it waits
+ * FDbGroupCommitSettings::WindowMicroseconds for other submitters, then runs all of them inside one
+ * IMMEDIATE transaction, so the whole batch costs one fsync. Every write runs in its own savepoint,
+ * failing write is rolled back without affecting the rest of the batch.
+ */
+class SMOOTHSQL_API FDbGroupCommitWriter : public FRunnable
+{
+public:
+
+	/// Runs on writer thread inside the batch transaction, returns number of changes, throws SQLite::Exception on failure
+	using FWriteOp = TFunction<int32(SQLite::Database&)>;
+
+	FDbGroupCommitWriter(TUniquePtr<SQLite::Database> InDb, const FDbGroupCommitSettings& InSettings, const FString& InName);
+	virtual ~FDbGroupCommitWriter() override;
+
+	/**
+	 * @brief Queue write, can be called from any thread
+	 * @return Future fulfilled on writer thread once batch containing the write is committed
+	 */
+	TFuture<FDbWriteResult> Submit(FWriteOp Op);
+
+	/**
+	 * @brief Queue SQL to be executed
+	 */
+	TFuture<FDbWriteResult> Submit(const FString& SQL);
+
+	//~ FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+
+	struct FPendingWrite
+	{
+		FWriteOp Op;
+		TPromise<FDbWriteResult> Promise;
+	};
+
+	/**
+	 * @brief Run batch in one transaction and fulfill promises
+	 */
+	void CommitBatch(TArray<FPendingWrite>& Batch);
+
+	TUniquePtr<SQLite::Database> Db;					///< Writer connection
+	FDbGroupCommitSettings Settings;					///< Batching settings
+	FString Name;										///< Name of the database, for logging
+
+	TQueue<FPendingWrite, EQueueMode::Mpsc> Queue;		///< Submitted writes
+	std::atomic<int32> NumPending {0};					///< Number of writes in Queue
+	std::atomic<bool> bStopping {false};				///< Writer should drain queue and exit
+
+	FEvent* WakeEvent;									///< Triggered on submit
+	FRunnableThread* Thread;							///< Writer thread
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+
+struct sqlite3_stmt;
+
+namespace SQLite
+{
+	class Database;
+}
+
+/**
+ * Collects full-scan and automatic index counters of statements and proposes indexes for the worst ones
+ *
+ * Statements report SQLITE_STMTSTATUS_FULLSCAN_STEP and SQLITE_STMTSTATUS_AUTOINDEX when a run ends,
+ * runs that used indexes cost two status reads. Advice is built from EXPLAIN QUERY PLAN of offenders:
+ * automatic indexes are taken as they are, full scans get columns compared in the query text.
+ * Candidates are heuristics, benchmark them before shipping.
+ */
+class SMOOTHSQL_API FDbIndexAdvisor
+{
+public:
+
+	explicit FDbIndexAdvisor(const FDbIndexAdvisorSettings& InSettings);
+
+	/**
+	 * @brief Add counters of finished run of statement and reset them, can be called from any thread
+	 */
+	void Record(sqlite3_stmt* Stmt);
+
+	/**
+	 * @brief Propose indexes for tracked statements, worst first
+	 *
+	 * Throws SQLite::Exception
+	 */
+	void GetAdvice(SQLite::Database& Db, TArray<FDbIndexAdvice>& OutAdvice) const;
+
+	/**
+	 * @brief Time SampleQuery on a copy of the database before and after creating the index
+	 *
+	 * Copy is written to ScratchPath and deleted afterwards, the database itself is not changed.
+	 * Throws SQLite::Exception
+	 * @param DbPath Path Db was opened with, shared SQL functions of it are registered on the copy
+	 * @param Runs Times query is run on each side
+	 */
+	static void Benchmark(SQLite::Database& Db, const FString& DbPath, FDbIndexAdvice& Advice, int32 Runs, const FString& ScratchPath);
+
+	/**
+	 * @brief Forget all statements
+	 */
+	void Reset();
+
+private:
+
+	/// Counters of one statement
+	struct FStatementStats
+	{
+		int32 Runs = 0;
+		int64 FullScanSteps = 0;
+		int32 AutoIndexes = 0;
+		FString SampleQuery;
+	};
+
+	FDbIndexAdvisorSettings Settings;
+
+	TMap<FString, FStatementStats> Statements;		///< Offending statements, by SQL
+	mutable FCriticalSection Mutex;					///< Guards Statements
+};
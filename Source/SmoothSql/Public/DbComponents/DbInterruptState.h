@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+
+#include <atomic>
+
+/**
+ * Cancel and deadline flags of a single connection
+ *
+ * Shared between UDbObject and its statements, polled by the SQLite progress handler
+ * every FSqliteDBConnectionParms::ProgressHandlerPeriod VM instructions
+ */
+struct SMOOTHSQL_API FDbInterruptState
+{
+	std::atomic<bool> bCancelRequested {false};		///< Set by Cancel(), consumed by the progress handler
+	std::atomic<double> Deadline {0.0};				///< FPlatformTime::Seconds() of the running step deadline, 0 if none
+	std::atomic<int32> ActiveScopes {0};			///< Number of steps currently running on the connection
+	std::atomic<EDbInterruptReason> Reason {EDbInterruptReason::None};	///< Why the last step was interrupted
+
+	/**
+	 * @brief Callback for sqlite3_progress_handler
+	 * @return Non zero if running statement should be interrupted
+	 */
+	static int ProgressHandler(void* State);
+};
+
+/**
+ * Arms the deadline of the connection for the duration of a single step
+ */
+struct SMOOTHSQL_API FDbInterruptScope
+{
+	FDbInterruptScope(FDbInterruptState* InState, float BudgetMs);
+	~FDbInterruptScope();
+
+	FDbInterruptScope(const FDbInterruptScope&) = delete;
+	FDbInterruptScope& operator=(const FDbInterruptScope&) = delete;
+
+private:
+	FDbInterruptState* State;
+};
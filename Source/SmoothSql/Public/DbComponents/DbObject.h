@@ -4,12 +4,35 @@
 
 #include "CoreMinimal.h"
 #include "Data/SmoothSqliteDataTypes.h"
+#include "DbComponents/DbInterruptState.h"
+#include "DbComponents/DbGroupCommitWriter.h"
+#include "DbComponents/DbWriteBehindQueue.h"
+#include "DbComponents/DbIndexAdvisor.h"
+#include "DbComponents/DbResultCache.h"
+#include "DbComponents/DbStreamingExporter.h"
+#include "Data/DbUserFunctions.h"
+#include "Data/DbVirtualTable.h"
 #include "SQLiteCpp/Backup.h"
+#include "SQLiteCpp/Savepoint.h"
 #include "SQLiteCpp/Transaction.h"
+#include "Async/Future.h"
 #include "UObject/NoExportTypes.h"
 #include "DbObject.generated.h"
 
 class UDbStmt;
+class UDataTable;
+struct sqlite3_session;
+
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FDbWriteCompleted, bool, bSuccess, int32, Changes);
+DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(bool, FDbTransactionBody, UDbObject*, Connection);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FDbTransactionCompleted, bool, bCommitted);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FDbChangesPublished, UDbObject*, Connection, const TArray<FDbChangeEvent>&, Changes);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FDbChangesPublishedNative, UDbObject*, const TArray<FDbChangeEvent>&);
+DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(EDbConflictAction, FDbConflictHandler, const FDbChangesetConflict&, Conflict);
+DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(FSqliteValue, FDbScalarFunction, const TArray<FSqliteValue>&, Args);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FDbExportProgress, int64, Rows, int64, Bytes);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FDbExportCompleted, const FDbExportResult&, Result);
+
 /**
  * 
  */
@@ -20,13 +43,115 @@ class SMOOTHSQL_API UDbObject : public UObject
 
 	// This object can be created only with this function library
 	friend class USmoothSqlFunctionLibrary;
+	friend class UDbStmt;
+	friend class FDbSavepointScope;
 
 	
 	/**
-	 * @brief Initialize underlying SQLite::Database object
+	 * @brief Initialize underlying SQLite::Database object using default connection params
 	 */
 	void Init(int32 OpenFlags);
 
+	/**
+	 * @brief Initialize underlying SQLite::Database object
+	 */
+	void Init(const FSqliteDBConnectionParms& Params, int32 OpenFlags);
+
+	/**
+	 * @brief Take ownership of already opened database
+	 */
+	void Adopt(TUniquePtr<SQLite::Database> Db, const FSqliteDBConnectionParms& Params, int32 OpenFlags);
+
+	/**
+	 * @brief Record error raised by this connection or its statements
+	 */
+	void ReportError(int32 ErrorCode);
+
+	/**
+	 * @brief Install update, commit and rollback hooks of the connection, once
+	 */
+	void InstallHooks();
+
+	static void UpdateHook(void* Self, int Op, const char* DbName, const char* Table, int64 RowId);
+	static int CommitHook(void* Self);
+	static void RollbackHook(void* Self);
+
+	/**
+	 * @brief Row of table was inserted, updated or deleted through this connection
+	 */
+	void OnRowChanged(int32 Op, const char* Table, int64 RowId);
+
+	/**
+	 * @brief Transaction of this connection was committed or rolled back
+	 */
+	void OnTransactionEnd(bool bCommitted);
+
+	/**
+	 * @brief Sum of SQLITE_FCNTL_DATA_VERSION of main and attached databases
+	 */
+	uint32 GetDataVersion() const;
+
+	/**
+	 * @brief End transaction whose COMMIT was seen by commit hook, if data version shows it succeeded
+	 */
+	void ResolveCommit();
+
+	/**
+	 * @brief Conflict callback of sqlite3changeset_apply, forwards to FConflictHandler
+	 */
+	static int ChangesetConflict(void* Handler, int Type, struct sqlite3_changeset_iter* It);
+
+	/**
+	 * @brief R*Tree geometry callback of smoothsql_sphere(X, Y, Z, Radius), scores entries by distance
+	 */
+	static int SphereQuery(struct sqlite3_rtree_query_info* Info);
+
+	/**
+	 * @brief Find open savepoint by name
+	 * @return Index in Savepoints, INDEX_NONE if not found
+	 */
+	int32 FindSavepoint(const FString& Name) const;
+
+	/**
+	 * @brief Release or rollback savepoints down to Index (inclusive), innermost first
+	 */
+	bool PopSavepoints(int32 Index, bool bRollback);
+
+	/// Outcome of one try of retryable transaction
+	enum class ETransactionAttempt : uint8
+	{
+		Committed,
+		RolledBack,		///< Body returned false
+		Busy,			///< Database was busy or locked, retry may succeed
+		Failed
+	};
+
+	/**
+	 * @brief Run Body once in BEGIN IMMEDIATE transaction, it is rolled back unless committed
+	 */
+	ETransactionAttempt AttemptTransaction(TFunctionRef<bool(UDbObject*)> Body);
+
+	/**
+	 * @brief Core ticker callback running attempt of K2_RunTransactionWithRetry, schedules the next one after backoff if database is busy
+	 * @return False, every attempt is a one-shot ticker
+	 */
+	bool TickTransactionRetry(float DeltaTime, FDbTransactionBody Body, FDbRetrySettings Settings, FDbTransactionCompleted OnCompleted, int32 Attempt);
+
+	/**
+	 * @brief Run write on the main connection, game thread only
+	 */
+	FDbWriteResult ExecuteWrite(const FDbGroupCommitWriter::FWriteOp& Op);
+
+	/**
+	 * @brief Core ticker callback flushing write-behind queue
+	 */
+	bool TickWriteBehind(float DeltaTime);
+
+	/**
+	 * @brief Broadcast changes committed since last tick
+	 */
+	bool TickChangeFeed(float DeltaTime);
+
 	/**
 	 *
 	 */
@@ -34,6 +159,35 @@ class SMOOTHSQL_API UDbObject : public UObject
 	
 public:
 
+	/**
+	 * @brief Full path of database file described by params
+	 */
+	static FString MakeDbPath(const FSqliteDBConnectionParms& Params);
+
+	/**
+	 * @brief Params connections are opened with when none are given, from project settings
+	 */
+	static const FSqliteDBConnectionParms& GetDefaultConnectionParams();
+
+	/**
+	 * @brief Open raw database, throws SQLite::Exception on failure
+	 * @param OpenFlags Bitmask of EDbOpenFlags
+	 */
+	static TUniquePtr<SQLite::Database> OpenRawDb(const FSqliteDBConnectionParms& Params, int32 OpenFlags);
+
+	/**
+	 * @brief Open connection with default params on worker thread
+	 *
+	 * Runs warm-up and prepares hot statements before handing connection back.
+	 * Future is fulfilled on the game thread, with nullptr if opening failed
+	 */
+	static TFuture<UDbObject*> OpenAsync(int32 OpenFlags, const FDbWarmupParams& Warmup);
+
+	/**
+	 * @brief Same as above, using warm-up from default settings
+	 */
+	static TFuture<UDbObject*> OpenAsync(int32 OpenFlags);
+
 	/**
 	 *
 	 */
@@ -58,6 +212,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Get", meta=(DisplayName="Transaction Active"))
 	bool DbTransactIsValid() const { return Transaction.IsValid(); }	
 
+	/**
+	 * @brief Did any statement fail since current transaction was started
+	 */
+	bool HasTransactionErrors() const { return DbTransactIsValid() && NumErrors != TransactionErrorMark; }
+
 	
 	/**
 	 *
@@ -71,12 +230,286 @@ public:
 	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
 	UDbStmt* Prepare(const FString& SQL);
 
+	/**
+	 * @brief Get prepared statement for SQL, reusing the one prepared by previous call
+	 *
+	 * Returned statement is reset and its bindings are cleared
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	UDbStmt* PrepareCached(const FString& SQL);
+
 	/**
 	 *
 	 */
 	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
 	int32 Execute(const FString& SQL);
 
+	/**
+	 * @brief Attach another database file under schema alias, so it can be queried and joined through this connection
+	 *
+	 * Attached databases share the connection, its transactions span all of them. Fails inside a transaction
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool Attach(const FDbAttachParams& Params);
+
+	/**
+	 * @brief Detach database attached under Alias. Fails inside a transaction or while statements on it are running
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool Detach(const FString& Alias);
+
+	/**
+	 * @brief Run PRAGMA Name = Value on a schema ("main" or alias)
+	 * @param Value Integer, keyword (WAL, NORMAL) or quoted literal, pasted into SQL as is
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool SetSchemaPragma(const FString& Schema, const FString& Name, const FString& Value);
+
+	UFUNCTION(BlueprintPure, Category="SmoothSql|Database|Get")
+	const TArray<FDbAttachParams>& GetAttachedDatabases() const { return AttachedDatabases; }
+
+	/**
+	 * @brief Is sqlite built with FTS5
+	 */
+	UFUNCTION(BlueprintPure, Category="SmoothSql|Database|Get")
+	static bool IsFullTextAvailable();
+
+	/**
+	 * @brief Create FTS5 index over content table, with triggers keeping it in sync, and fill it
+	 *
+	 * Does nothing if index already exists
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool CreateFullTextIndex(const FDbFullTextIndex& Index);
+
+	/**
+	 * @brief Drop FTS5 index and its triggers, content table is kept
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool DropFullTextIndex(const FString& Index);
+
+	/**
+	 * @brief Find rows matching FTS5 query, best first
+	 * @param Match FTS5 query, e.g. "dragon* NOT bone"
+	 * @return False if query failed
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(AutoCreateRefTerm="Options"))
+	bool SearchFullText(const FString& Index, const FString& Match, const FDbFullTextQuery& Options, TArray<FDbFullTextHit>& Hits);
+
+	/**
+	 * @brief Merge b-tree segments of FTS5 index on the group commit writer (on the game thread if not enabled), see SubmitWrite
+	 * @param MergePages Pages merged per step until nothing is left to merge, full optimize if 0
+	 */
+	TFuture<FDbWriteResult> MergeFullTextIndex(const FString& Index, int32 MergePages = 0);
+
+	/**
+	 * @brief Merge b-tree segments of FTS5 index on the group commit writer (in place if not enabled)
+	 * @param MergePages Pages merged per step until nothing is left to merge, full optimize if 0
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(DisplayName="Merge Full Text Index", AutoCreateRefTerm="OnCompleted"))
+	void K2_MergeFullTextIndex(const FString& Index, int32 MergePages, const FDbWriteCompleted& OnCompleted);
+
+	/**
+	 * @brief Register SQL function described by SmoothSql::MakeScalarFunction or MakeAggregateFunction
+	 *
+	 * Replaces function with the same name and number of arguments. Connections opened to the same file
+	 * afterwards (group commit writer, async readers, OpenAsync) get the function too until this connection is closed,
+	 * so register functions used by indexes before enabling group commit. Functions may be called on those connections' threads
+	 */
+	bool RegisterFunction(const FString& Name, const SmoothSql::FDbUserFunction& Function);
+
+	/**
+	 * @brief Register C++ callable as scalar SQL function
+	 * @tparam TSignature Signature seen by SQL, e.g. int64(FStringView, double)
+	 * @param bDeterministic Same arguments always give the same result, function can be used in indexes
+	 */
+	template<typename TSignature, typename FuncType>
+	bool RegisterScalar(const FString& Name, FuncType&& Func, bool bDeterministic = true)
+	{
+		return RegisterFunction(Name, SmoothSql::MakeScalarFunction<TSignature>(Forward<FuncType>(Func), bDeterministic));
+	}
+
+	/**
+	 * @brief Register C++ callables as aggregate SQL function, argument types are taken from Step
+	 * @param Step void(TState&, Args...), called for every row
+	 * @param Final Result(const TState&), called once per group
+	 */
+	template<typename TState, typename StepType, typename FinalType>
+	bool RegisterAggregate(const FString& Name, StepType&& Step, FinalType&& Final, bool bDeterministic = true)
+	{
+		return RegisterFunction(Name, SmoothSql::MakeAggregateFunction<TState>(Forward<StepType>(Step), Forward<FinalType>(Final), bDeterministic));
+	}
+
+	/**
+	 * @brief Register Blueprint delegate as scalar SQL function
+	 *
+	 * Arguments and result are boxed, so this is much slower than C++ functions. Queries calling it must run on the game thread.
+	 * Function is registered on this connection only, so it can't be used by indexes written through other connections
+	 * @param NumArgs Number of arguments, -1 for any
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(DisplayName="Register Scalar Function"))
+	bool K2_RegisterScalarFunction(const FString& Name, int32 NumArgs, const FDbScalarFunction& Function, bool bDeterministic = false);
+
+	/**
+	 * @brief Remove SQL function registered with the same name and number of arguments
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool UnregisterFunction(const FString& Name, int32 NumArgs);
+
+	/**
+	 * @brief Expose rows in engine memory as read-only table in temp schema, see SmoothSql::FDbVirtualRows
+	 *
+	 * Replaces table with the same name. Queries on it must run on the game thread and are not seen by the result cache
+	 * @param KeyColumn Column looked up natively on equality, RowName of rows with names if empty
+	 */
+	bool RegisterVirtualTable(const FString& Name, const TSharedRef<SmoothSql::FDbVirtualRows>& Rows, const FString& KeyColumn = FString());
+
+	/**
+	 * @brief Expose array of USTRUCTs as read-only table, array must outlive the table
+	 */
+	template<typename T>
+	bool RegisterStructArray(const FString& Name, const TArray<T>& Array, const FString& KeyColumn = FString())
+	{
+		return RegisterVirtualTable(Name, SmoothSql::FDbStructArrayRows::Make(Array), KeyColumn);
+	}
+
+	/**
+	 * @brief Expose DataTable as read-only table, RowName is the first column and lookups by it don't scan
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool RegisterDataTable(const FString& Name, const UDataTable* Table);
+
+	/**
+	 * @brief Drop table registered with RegisterVirtualTable or RegisterDataTable
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool UnregisterVirtualTable(const FString& Name);
+
+	/**
+	 * @brief Bring schema to the latest version of Migrations
+	 *
+	 * Version is kept in PRAGMA user_version, so up to date database costs one pragma read.
+	 * Missing steps run in version order inside one IMMEDIATE transaction, with their checksums
+	 * recorded in smoothsql_migrations. Checksums of already applied steps are checked before migrating;
+	 * bVerifyChecksums checks them on every call, which is useful in development.
+	 * @return False if any step failed (nothing is applied then) or applied step was changed
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool Migrate(const TArray<FDbMigration>& Migrations, bool bVerifyChecksums = false);
+
+	/**
+	 * @brief Schema version set by Migrate, 0 if never migrated
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Get")
+	int32 GetSchemaVersion();
+
+	/**
+	 * @brief Track full scans of statements prepared through UDbStmt, see FDbIndexAdvisor
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void EnableIndexAdvisor(const FDbIndexAdvisorSettings& Settings);
+
+	/**
+	 * @brief Stop tracking and forget collected statements
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void DisableIndexAdvisor();
+
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Get")
+	bool IsIndexAdvisorEnabled() const;
+
+	/**
+	 * @brief Indexes proposed for statements tracked so far, worst offenders first
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Get")
+	bool GetIndexAdvice(TArray<FDbIndexAdvice>& OutAdvice);
+
+	/**
+	 * @brief Fill timings of advice by running its query on a scratch copy of the database, not available in shipping builds
+	 *
+	 * Copy is as large as the database and the query runs 2 * Runs times, call it from tools, not gameplay.
+	 * User functions are not registered on the copy.
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool BenchmarkIndexAdvice(UPARAM(ref) FDbIndexAdvice& Advice, int32 Runs = 5);
+
+	/**
+	 * @brief Create table from row struct of DataTable and copy its rows, see FDbBulkImporter
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	FDbImportResult ImportDataTable(const FDbImportSettings& Settings, const UDataTable* Table);
+
+	/**
+	 * @brief Create table from header of UTF-8 CSV file and stream its rows in
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	FDbImportResult ImportCsv(const FDbImportSettings& Settings, const FString& Path);
+
+	/**
+	 * @brief Create table from keys of the first object of JSON array file and copy all objects
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	FDbImportResult ImportJson(const FDbImportSettings& Settings, const FString& Path);
+
+	/**
+	 * @brief Write rows of query to file on worker thread, see FDbStreamingExporter
+	 *
+	 * Query runs on its own read-only connection, so it sees committed data of the main database only
+	 * @param OnProgress Called on the worker thread
+	 * @param OutExporter Set to exporter running the query, call Cancel on it to stop the export early
+	 */
+	TFuture<FDbExportResult> ExportQuery(const FString& SQL, const TArray<FSqliteValue>& Values, const FString& Path,
+		const FDbExportSettings& Settings, FDbStreamingExporter::FProgress OnProgress = FDbStreamingExporter::FProgress(),
+		TSharedPtr<FDbStreamingExporter, ESPMode::ThreadSafe>* OutExporter = nullptr);
+
+	/**
+	 * @brief Write rows of query to file on worker thread, callbacks are called on the game thread
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(DisplayName="Export Query", AutoCreateRefTerm="Values,OnProgress,OnCompleted"))
+	void K2_ExportQuery(const FString& SQL, const TArray<FSqliteValue>& Values, const FString& Path,
+		const FDbExportSettings& Settings, const FDbExportProgress& OnProgress, const FDbExportCompleted& OnCompleted);
+
+	/**
+	 * @brief Is sqlite built with R*Tree
+	 */
+	UFUNCTION(BlueprintPure, Category="SmoothSql|Database|Get")
+	static bool IsSpatialIndexAvailable();
+
+	/**
+	 * @brief Create 3D R*Tree index (id, min_x, max_x, min_y, max_y, min_z, max_z) if it doesn't exist
+	 *
+	 * Coordinates are stored as 32-bit floats rounded outwards, so box queries may return entries slightly outside
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool CreateSpatialIndex(const FString& Index);
+
+	/**
+	 * @brief Insert or move entry of spatial index
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool SetSpatialBounds(const FString& Index, int64 Id, const FBox& Bounds);
+
+	/**
+	 * @brief Insert or move point entry of spatial index
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool SetSpatialPoint(const FString& Index, int64 Id, const FVector& Location);
+
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool RemoveSpatialEntry(const FString& Index, int64 Id);
+
+	/**
+	 * @brief Find entries overlapping box
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool QuerySpatialBox(const FString& Index, const FBox& Box, TArray<int64>& Ids);
+
+	/**
+	 * @brief Find entries overlapping sphere, nearest first
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool QuerySpatialSphere(const FString& Index, const FVector& Center, float Radius, TArray<int64>& Ids);
+
 	/**
 	 *
 	 */
@@ -90,17 +523,181 @@ public:
 	bool StartDbTransaction(EDbTransactionFlags Flags = EDbTransactionFlags::Deferred);
 
 	/**
+	 * @brief Commit transaction, keeping changes of open savepoints
 	 *
+	 * Without StartDbTransaction, commits transaction opened by the outermost savepoint
 	 */
 	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
 	bool CommitDbTransaction();
 
 	/**
-	 *
+	 * @brief Roll back transaction and all open savepoints, including transaction opened by the outermost savepoint
 	 */
 	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
 	void RollbackDbTransaction();
 
+	/**
+	 * @brief Cache results of read-only queries run by QueryCached
+	 *
+	 * Results are dropped when tables they read are written through this connection, or when any other connection writes
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void EnableResultCache(const FDbResultCacheSettings& Settings);
+
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void DisableResultCache();
+
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void ClearResultCache();
+
+	/**
+	 * @brief Run query, or get its rows from the result cache if they are still valid
+	 * @param Params Values of parameters, by index
+	 * @return Rows, null if query failed
+	 */
+	FDbResultCache::FRows QueryCached(const FString& SQL, const TArray<FSqliteValue>& Params);
+
+	/**
+	 * @brief Run query, or get its rows from the result cache if they are still valid
+	 * @param Params Values of parameters, by index
+	 * @return False if query failed
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(DisplayName="Query Cached", AutoCreateRefTerm="Params"))
+	bool K2_QueryCached(const FString& SQL, const TArray<FSqliteValue>& Params, TArray<FSqliteRow>& Rows);
+
+	/**
+	 * @brief Publish rows changed through this connection
+	 *
+	 * Changes are buffered per transaction and dropped if it rolls back. Committed changes are broadcast
+	 * once per frame on the game thread, in commit order. Changes of WITHOUT ROWID tables are not reported.
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void EnableChangeFeed();
+
+	/**
+	 * @brief Stop publishing changes, changes not yet broadcast are dropped
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void DisableChangeFeed();
+
+	UFUNCTION(BlueprintPure, Category="SmoothSql|Database|Get")
+	bool IsChangeFeedEnabled() const { return bChangeFeedEnabled; }
+
+	/**
+	 * @brief Changes committed since last frame (if change feed is enabled)
+	 */
+	UPROPERTY(BlueprintAssignable, Category="SmoothSql|Database")
+	FDbChangesPublished OnChangesPublished;
+
+	FDbChangesPublishedNative OnChangesPublishedNative;
+
+	/**
+	 * @brief Start recording changes of tables, for changesets
+	 *
+	 * Only tables with a PRIMARY KEY are recorded. Requires sqlite built with the session extension (SMOOTHSQL_WITH_SESSION)
+	 * @param Tables Tables to record, all tables if empty
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(AutoCreateRefTerm="Tables"))
+	bool BeginSession(const TArray<FString>& Tables);
+
+	/**
+	 * @brief Stop recording changes, changes not taken as changeset are lost
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void EndSession();
+
+	UFUNCTION(BlueprintPure, Category="SmoothSql|Database|Get")
+	bool IsSessionActive() const { return Session != nullptr; }
+
+	/**
+	 * @brief Serialize changes recorded since BeginSession
+	 *
+	 * Patchsets are smaller, they don't carry original values of updated and deleted rows,
+	 * so they can't be inverted and conflicts on them are detected by primary key only
+	 * @param bPatchset Make patchset instead of changeset
+	 * @param bReset Start recording anew, so next changeset holds only later changes
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool MakeChangeset(TArray<uint8>& Changeset, bool bPatchset = false, bool bReset = true);
+
+	/// Decides what to do with conflicting change
+	using FConflictHandler = TFunctionRef<EDbConflictAction(const FDbChangesetConflict&)>;
+
+	/**
+	 * @brief Apply changeset or patchset to this connection, in a single savepoint
+	 * @return False if changeset is invalid or was aborted, nothing is applied then
+	 */
+	bool ApplyChangeset(const TArray<uint8>& Changeset, FConflictHandler OnConflict);
+
+	/**
+	 * @brief Apply changeset or patchset to this connection, in a single savepoint
+	 * @param OnConflict Called for each conflicting change, conflicting changes are omitted if not bound
+	 * @return False if changeset is invalid or was aborted, nothing is applied then
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(DisplayName="Apply Changeset", AutoCreateRefTerm="OnConflict"))
+	bool K2_ApplyChangeset(const TArray<uint8>& Changeset, const FDbConflictHandler& OnConflict);
+
+	/**
+	 * @brief Make changeset that undoes Changeset
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	static bool InvertChangeset(const TArray<uint8>& Changeset, TArray<uint8>& Inverted);
+
+	/// Runs inside the transaction, returns false to roll it back, may throw SQLite::Exception
+	using FTransactionBody = TFunctionRef<bool(UDbObject*)>;
+
+	/**
+	 * @brief Run Body in a BEGIN IMMEDIATE transaction, re-running it if database is busy or locked
+	 *
+	 * Transaction is retried when Body, BEGIN or COMMIT fails with SQLITE_BUSY or SQLITE_LOCKED,
+	 * sleeping with exponential backoff and full jitter in between. Body must be safe to run more than once.
+	 * Cannot be nested in another transaction. Backoff blocks the calling thread, use K2_RunTransactionWithRetry on the game thread.
+	 * @return True if transaction was committed
+	 */
+	bool RunTransactionWithRetry(FTransactionBody Body, const FDbRetrySettings& Settings = FDbRetrySettings());
+
+	/**
+	 * @brief Run Body in a transaction, re-running it if database is busy or locked
+	 *
+	 * First attempt runs immediately, retries run on later ticks after backoff, so the game thread is never put to sleep
+	 * @param OnCompleted Called with true if transaction was committed
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(DisplayName="Run Transaction With Retry", AutoCreateRefTerm="OnCompleted"))
+	void K2_RunTransactionWithRetry(const FDbTransactionBody& Body, const FDbRetrySettings& Settings, const FDbTransactionCompleted& OnCompleted);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Database|Get")
+	const FDbConnectionStats& GetStats() const { return Stats; }
+
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void ResetStats() { Stats = FDbConnectionStats(); }
+
+	/**
+	 * @brief Open nested savepoint, starts transaction if there is none
+	 * @param Name Name of the savepoint, generated if empty
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool PushSavepoint(const FString& Name);
+
+	/**
+	 * @brief Keep changes made since savepoint and close it together with savepoints opened after it
+	 * @param Name Name of the savepoint, innermost if empty
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool ReleaseSavepoint(const FString& Name);
+
+	/**
+	 * @brief Undo changes made since savepoint and close it together with savepoints opened after it
+	 * @param Name Name of the savepoint, innermost if empty
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool RollbackSavepoint(const FString& Name);
+
+	/**
+	 * @brief Number of open savepoints
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Database|Get")
+	int32 GetSavepointDepth() const { return Savepoints.Num(); }
+
 	/**
 	 *
 	 */
@@ -108,6 +705,88 @@ public:
 	void MakeBackup();
 
 
+	/**
+	 * @brief Start group commit writer on a second connection to the same file
+	 *
+	 * Writes submitted within a short window are committed in one transaction with one fsync.
+	 * WAL journal mode is recommended, otherwise readers of this connection wait while batch commits
+	 * @return True if writer was started
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool EnableGroupCommit(const FDbGroupCommitSettings& Settings);
+
+	/**
+	 * @brief Commit pending writes and stop group commit writer
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void DisableGroupCommit();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Database|Get")
+	bool IsGroupCommitEnabled() const { return GroupWriter.IsValid(); }
+
+	/**
+	 * @brief Queue write to group commit writer, can be called from any thread
+	 *
+	 * Without writer the write runs on this connection, in place on the game thread
+	 * and marshalled to the game thread from other threads
+	 * @return Future fulfilled once write is committed (on writer thread, or game thread without writer)
+	 */
+	TFuture<FDbWriteResult> SubmitWrite(FDbGroupCommitWriter::FWriteOp Op);
+
+	/**
+	 * @brief Same as above, executes SQL
+	 */
+	TFuture<FDbWriteResult> SubmitWrite(const FString& SQL);
+
+	/**
+	 * @brief Queue SQL to group commit writer, OnCompleted is called on the game thread once committed
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action", meta=(AutoCreateRefTerm="OnCompleted"))
+	void SubmitGroupWrite(const FString& SQL, const FDbWriteCompleted& OnCompleted);
+
+	/**
+	 * @brief Start buffering upserts in memory
+	 *
+	 * Buffer is flushed periodically, when it grows past MaxPendingRows, on FlushWriteBehind, on Close and on engine exit
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void EnableWriteBehind(const FDbWriteBehindSettings& Settings);
+
+	/**
+	 * @brief Flush buffered upserts and stop buffering
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	void DisableWriteBehind();
+
+	/**
+	 * @brief Buffer upsert of a row, later upserts of the same row overwrite earlier values
+	 *
+	 * Key column must have a UNIQUE or PRIMARY KEY constraint
+	 * @return False if write-behind is not enabled
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool Upsert(const FString& Table, const FString& KeyColumn, const FSqliteValue& Key, const TMap<FString, FSqliteValue>& Values);
+
+	/**
+	 * @brief Write buffered upserts now, in one transaction
+	 * @return True if buffer was written
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool FlushWriteBehind();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Database|Get")
+	int32 GetNumPendingUpserts() const;
+
+	/**
+	 * @brief Interrupt statement that is currently running on this connection
+	 *
+	 * Safe to call from any thread. Interrupted statement reports EDbInterruptReason::Cancelled
+	 * @return True if there was a running statement to interrupt
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Action")
+	bool Cancel();
+
+
 	UFUNCTION(BlueprintCallable, Category="SmoothSql|Database|Get")
 	bool IsBusy() const;
 	
@@ -123,7 +802,105 @@ private:
 
 	bool bValid;						///< Can this object be used safely
 	FSqliteDBConnectionParms DbParams;	///< Parameters of wrapped db
+	int32 DbOpenFlags;					///< EDbOpenFlags db was opened with
 	
 	TUniquePtr<SQLite::Database> RawDb;				///< Raw SQLite database object
 	TUniquePtr<SQLite::Transaction> Transaction;	///< Current transaction (if any)
+
+	/// Open savepoint
+	struct FDbSavepoint
+	{
+		FString Name;
+		TUniquePtr<SQLite::Savepoint> Savepoint;
+		int32 ChangeMark = 0;						///< Changes buffered when savepoint was opened
+	};
+
+	TArray<FDbSavepoint> Savepoints;				///< Open savepoints, innermost last
+
+	FDbConnectionStats Stats;						///< Counters
+	int32 NumErrors = 0;							///< Errors reported so far
+	int32 NumBusyErrors = 0;						///< SQLITE_BUSY and SQLITE_LOCKED errors reported so far
+	int32 TransactionErrorMark = 0;					///< NumErrors when current transaction was started
+
+	bool bHooksInstalled = false;					///< Are update/commit/rollback hooks installed
+	bool bCommitPending = false;					///< Commit hook was called, commit not confirmed yet
+	uint32 CommitDataVersion = 0;					///< Data version when commit hook was called
+	int32 NumRowChanges = 0;						///< Update hook calls in current transaction
+	int32 TotalChangesMark = 0;						///< sqlite3_total_changes at the end of last transaction
+	std::string LastChangedTable;					///< Table of last update hook call, to skip repeated notifications
+	FString LastChangedTableName;					///< LastChangedTable converted
+
+	bool bChangeFeedEnabled = false;				///< Are changes buffered and published
+	TArray<FDbChangeEvent> PendingChanges;			///< Changes of current transaction
+	TArray<FDbChangeEvent> CommittedChanges;		///< Changes waiting for the next tick
+	FCriticalSection ChangeFeedMutex;				///< Guards CommittedChanges, transactions may commit on worker threads
+	FDbTickerHandle ChangeFeedTicker;				///< Per-frame broadcast
+
+	bool bSpatialFunctionsRegistered = false;		///< Is smoothsql_sphere registered on the connection
+
+	bool bVirtualTableModuleRegistered = false;					///< Is smoothsql_rows registered on the connection
+	SmoothSql::FDbVirtualTableSources VirtualTableSources;		///< Rows of virtual tables, by table name
+
+	TArray<FDbAttachParams> AttachedDatabases;		///< Attached databases, in attach order
+
+	sqlite3_session* Session = nullptr;				///< Change recording session (if any)
+	TArray<FString> SessionTables;					///< Tables recorded by Session, all if empty
+
+	TUniquePtr<FDbResultCache> ResultCache;			///< Result cache (if enabled)
+
+	TUniquePtr<FDbIndexAdvisor> IndexAdvisor;		///< Full scan tracking (if enabled)
+
+	TSharedPtr<FDbInterruptState, ESPMode::ThreadSafe> InterruptState;	///< Cancel/deadline flags polled by the progress handler
+
+	UPROPERTY()
+	TMap<FString, UDbStmt*> CachedStatements;	///< Statements reused by PrepareCached, keyed by SQL
+
+	TUniquePtr<FDbGroupCommitWriter> GroupWriter;	///< Group commit writer (if enabled)
+
+	TUniquePtr<FDbWriteBehindQueue> WriteBehind;	///< Buffered upserts (if enabled)
+	FDbWriteBehindSettings WriteBehindSettings;		///< Flushing of WriteBehind
+	FDbTickerHandle WriteBehindTicker;				///< Periodic flush
+	FDelegateHandle WriteBehindExitHandle;			///< Flush on engine exit
+	FDelegateHandle WriteBehindErrorHandle;			///< Best effort flush on crash
+};
+
+/**
+ * Savepoint scope, rolls back if not released before going out of scope
+ *
+ * @code
+ * FDbSavepointScope Scope(Db, L"inventory");
+ * Db->Execute(...);
+ * Scope.Release();
+ * @endcode
+ */
+class SMOOTHSQL_API FDbSavepointScope
+{
+public:
+
+	FDbSavepointScope(UDbObject* InDb, const FString& InName = FString());
+	~FDbSavepointScope();
+
+	FDbSavepointScope(const FDbSavepointScope&) = delete;
+	FDbSavepointScope& operator=(const FDbSavepointScope&) = delete;
+
+	/**
+	 * @brief Was savepoint opened
+	 */
+	bool IsValid() const { return Depth != INDEX_NONE; }
+
+	/**
+	 * @brief Keep changes made in this scope
+	 */
+	bool Release();
+
+	/**
+	 * @brief Undo changes made in this scope
+	 */
+	bool Rollback();
+
+private:
+
+	TWeakObjectPtr<UDbObject> Db;		///< Connection
+	FString Name;						///< Name of the savepoint
+	int32 Depth = INDEX_NONE;			///< Savepoint depth when opened, INDEX_NONE if closed
 };
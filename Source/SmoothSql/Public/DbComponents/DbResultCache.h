@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+#include "Containers/List.h"
+
+namespace SQLite
+{
+	class Database;
+	class Statement;
+}
+
+/**
+ * Materialized rows of read-only queries, keyed by SQL and bound parameters
+ *
+ * Tables read by a query are collected with the authorizer when it is prepared. Connection reports
+ * tables written through it (update hook) and transaction ends (commit/rollback hooks), results that
+ * read a written table are dropped. Writes by other connections are noticed by PRAGMA data_version
+ * and drop the whole cache. Must be used on the thread that owns the connection.
+ */
+class SMOOTHSQL_API FDbResultCache
+{
+public:
+
+	using FRows = TSharedPtr<const TArray<FSqliteRow>, ESPMode::ThreadSafe>;
+
+	explicit FDbResultCache(const FDbResultCacheSettings& InSettings);
+	~FDbResultCache();
+
+	/**
+	 * @brief Get rows of the query, running it if there is no valid cached result
+	 *
+	 * Throws SQLite::Exception if query fails
+	 * @param Params Values of parameters, by index
+	 */
+	FRows Query(SQLite::Database& Db, const FString& SQL, const TArray<FSqliteValue>& Params, FDbConnectionStats& Stats);
+
+	/**
+	 * @brief Row of the table was written in current transaction
+	 */
+	void OnTableChanged(const FString& Table);
+
+	/**
+	 * @brief Current transaction was committed or rolled back
+	 */
+	void OnTransactionEnd();
+
+	/**
+	 * @brief Drop all results
+	 */
+	void Clear();
+
+	int32 Num() const { return Entries.Num(); }
+
+private:
+
+	struct FKey
+	{
+		FString SQL;
+		TArray<FSqliteValue> Params;
+
+		bool operator==(const FKey& Other) const
+		{
+			return SQL.Equals(Other.SQL, ESearchCase::CaseSensitive) && Params == Other.Params;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			uint32 Hash = FCrc::StrCrc32(*Key.SQL);
+			for (const FSqliteValue& Param : Key.Params)
+			{
+				Hash = HashCombine(Hash, GetTypeHash(Param));
+			}
+			return Hash;
+		}
+	};
+
+	using FLruList = TDoubleLinkedList<FKey>;
+
+	struct FEntry
+	{
+		FRows Rows;								///< Materialized result
+		const TArray<FString>* Tables;			///< Tables read by the query, owned by FPrepared
+		FLruList::TDoubleLinkedListNode* Lru;	///< Position in the LRU list
+	};
+
+	struct FPrepared
+	{
+		TUniquePtr<SQLite::Statement> Stmt;		///< Prepared query
+		TArray<FString> Tables;					///< Tables read by the query
+		bool bReadOnly;							///< Only read-only queries are cached
+	};
+
+	/**
+	 * @brief Collects tables read by statement being prepared
+	 */
+	static int Authorizer(void* Tables, int Action, const char* Arg1, const char* Arg2, const char* DbName, const char* Trigger);
+
+	/**
+	 * @brief Get or prepare statement of SQL
+	 */
+	FPrepared& Prepare(SQLite::Database& Db, const FString& SQL);
+
+	/**
+	 * @brief Drop everything if another connection changed the database
+	 */
+	void CheckDataVersion(SQLite::Database& Db);
+
+	void Remove(const FKey& Key);
+
+	FDbResultCacheSettings Settings;
+
+	TMap<FKey, FEntry> Entries;						///< Cached results
+	FLruList Lru;									///< Keys of Entries, most recently used first
+	TMap<FString, TUniquePtr<FPrepared>> Prepared;	///< Statements by SQL
+	TSet<FString> WrittenTables;					///< Tables written in current transaction
+
+	TUniquePtr<SQLite::Statement> DataVersionStmt;	///< PRAGMA data_version
+	int64 DataVersion = -1;							///< Data version results were read at
+};
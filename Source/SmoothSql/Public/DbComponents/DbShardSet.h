@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+#include "DbComponents/DbGroupCommitWriter.h"
+#include "DbComponents/DbObject.h"
+#include "Async/Future.h"
+#include "UObject/NoExportTypes.h"
+#include "DbShardSet.generated.h"
+
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FDbShardQueryCompleted, bool, bSuccess, const TArray<FSqliteRow>&, Rows);
+
+/**
+ * Database files with the same schema, rows are spread over them by shard key
+ *
+ * Every shard has its own group commit writer, so writes to different shards commit in parallel
+ * instead of waiting for one file lock. Reads fan out to all shards on worker threads, each shard
+ * has its own read connection, and rows are merged once every shard is done.
+ */
+UCLASS(BlueprintType)
+class SMOOTHSQL_API UDbShardSet : public UObject
+{
+	GENERATED_BODY()
+
+	// This object can be created only with this function library
+	friend class USmoothSqlFunctionLibrary;
+
+	/// Files and connections of one shard, shared with tasks running on it
+	struct FShard
+	{
+		FString Name;									///< File name, for logging
+		TUniquePtr<FDbGroupCommitWriter> Writer;		///< Writes of the shard
+		TUniquePtr<SQLite::Database> Reader;			///< Read-only connection used by fan-out queries
+		FCriticalSection ReaderMutex;					///< Reader runs one query at a time
+	};
+
+	using FShardPtr = TSharedPtr<FShard, ESPMode::ThreadSafe>;
+
+	/**
+	 * @brief Open writer and reader of every shard
+	 */
+	bool Init(const FDbShardSetParams& InParams, int32 OpenFlags);
+
+	/**
+	 * @brief Run query on the reader of the shard, runs on worker thread
+	 */
+	static bool QueryShard(FShard& Shard, const std::string& SQL, const TArray<FSqliteValue>& Values, TArray<FSqliteRow>& Rows);
+
+public:
+
+	/// Merged rows of a fan-out query
+	struct FQueryResult
+	{
+		bool bSuccess = false;		///< False if query failed on any shard
+		TArray<FSqliteRow> Rows;
+	};
+
+	virtual void BeginDestroy() override;
+
+	/**
+	 * @brief Flush writers and close all shards
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Shards|Action")
+	void Close();
+
+	UFUNCTION(BlueprintPure, Category="SmoothSql|Shards|Get")
+	int32 GetNumShards() const { return Shards.Num(); }
+
+	/**
+	 * @brief Shard owning the key
+	 *
+	 * Hash routing depends on the storage class, the same key must always be passed with the same type
+	 */
+	UFUNCTION(BlueprintPure, Category="SmoothSql|Shards|Get")
+	int32 GetShardIndex(const FSqliteValue& Key) const;
+
+	/**
+	 * @brief Queue write to the writer of the shard owning the key
+	 */
+	TFuture<FDbWriteResult> SubmitWrite(const FSqliteValue& Key, FDbGroupCommitWriter::FWriteOp Op);
+
+	/**
+	 * @brief Same as above, executes SQL with Values bound to parameters by index
+	 */
+	TFuture<FDbWriteResult> SubmitWrite(const FSqliteValue& Key, const FString& SQL, const TArray<FSqliteValue>& Values);
+
+	/**
+	 * @brief Queue SQL to the shard owning the key, OnCompleted is called on the game thread once committed
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Shards|Action", meta=(DisplayName="Submit Write", AutoCreateRefTerm="Values,OnCompleted"))
+	void K2_SubmitWrite(const FSqliteValue& Key, const FString& SQL, const TArray<FSqliteValue>& Values, const FDbWriteCompleted& OnCompleted);
+
+	/**
+	 * @brief Run query on all shards in parallel and merge their rows
+	 *
+	 * Sees writes committed by shard writers, not the ones still queued
+	 */
+	TFuture<FQueryResult> QueryAll(const FString& SQL, const TArray<FSqliteValue>& Values, const FDbShardMerge& Merge);
+
+	/**
+	 * @brief Run query on all shards in parallel, OnCompleted is called on the game thread with merged rows
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Shards|Action", meta=(DisplayName="Query All Shards", AutoCreateRefTerm="Values,Merge"))
+	void K2_QueryAll(const FString& SQL, const TArray<FSqliteValue>& Values, const FDbShardMerge& Merge, const FDbShardQueryCompleted& OnCompleted);
+
+private:
+
+	FDbShardSetParams Params;		///< Files and routing
+
+	TArray<FShardPtr> Shards;		///< Open shards, by index
+};
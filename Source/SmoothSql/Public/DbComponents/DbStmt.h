@@ -6,6 +6,9 @@
 #include "SQLiteCpp/Column.h"
 #include "UObject/NoExportTypes.h"
 #include "SQLiteCpp/Statement.h"
+#include "Data/SmoothSqliteDataTypes.h"
+#include "Data/DbStructBinding.h"
+#include <atomic>
 #include "DbStmt.generated.h"
 
 
@@ -15,6 +18,10 @@ namespace SQLite
 	class Database;
 }
 
+class UDbObject;
+class UDbTimeSlicedCursor;
+struct FDbInterruptState;
+
 /**
  * 
  */
@@ -28,9 +35,25 @@ class SMOOTHSQL_API UDbStmt : public UObject
 
 
 	/**
-	 * @brief 
+	 * @brief Prepare statement on given connection
+	 */
+	void Init(UDbObject* InOwner, const FString& SQL);
+
+	/**
+	 * @brief Wrap statement that was already prepared on owner's connection
+	 */
+	void InitFromRaw(UDbObject* InOwner, TUniquePtr<SQLite::Statement> InStmt);
+
+	/**
+	 * @brief Check if step failed because it was interrupted and remember why
+	 * @return True if error was an interruption
+	 */
+	bool HandleInterrupt(int32 ErrorCode);
+
+	/**
+	 * @brief Hand run counters to index advisor of owner, if it is enabled
 	 */
-	void Init(class SQLite::Database* Db, const FString& SQL);
+	void ReportStatus();
 
 	/**
 	 *
@@ -85,6 +108,47 @@ public:
 	UFUNCTION(BlueprintCallable, Category="SmoothSql|Statement|Action")
 	void Close();
 
+	/**
+	 * @brief Limit how long a single Fetch/Execute of this statement may run
+	 * @param Milliseconds Budget per step, 0 means unlimited
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Statement|Action")
+	void SetTimeBudget(float Milliseconds);
+
+	/**
+	 * @brief Interrupt this statement if it is currently running
+	 *
+	 * Safe to call from any thread
+	 * @return True if statement was running
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Statement|Action")
+	bool Cancel();
+
+	/**
+	 * @brief Why the last Fetch/Execute was interrupted (None if it was not)
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Statement|Get")
+	EDbInterruptReason GetInterruptReason() const { return LastInterrupt; }
+
+	/**
+	 * @brief Create cursor that steps this statement on the game thread in time slices
+	 *
+	 * Cursor is started right away, rows are buffered until popped
+	 * @param BudgetMicroseconds Time spent stepping per tick
+	 * @param MaxRowsPerTick Upper bound of rows produced per tick (0 for unlimited), makes slicing independent of timing
+	 * @param MaxBufferedRows Stepping pauses while this many rows are waiting (0 for unlimited)
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Statement|Action")
+	UDbTimeSlicedCursor* OpenTimeSlicedCursor(int32 BudgetMicroseconds = 500, int32 MaxRowsPerTick = 0, int32 MaxBufferedRows = 0);
+
+	/**
+	 * @brief Step and copy columns of the new row into members of struct with the same names
+	 *
+	 * Member to column mapping is built on first call and reused while Struct stays the same
+	 * @return True if there was a row
+	 */
+	bool FetchInto(const UScriptStruct* Struct, void* Data);
+
 	/**
 	 *
 	 */
@@ -109,4 +173,16 @@ private:
 
 	bool bValid;	///< Is statement valid
 	TUniquePtr<SQLite::Statement> RawStmt;		///< Raw SQLite Statement object
+
+	UPROPERTY()
+	UDbObject* Owner;	///< Connection this statement was prepared on
+
+	TSharedPtr<FDbInterruptState, ESPMode::ThreadSafe> InterruptState;	///< Cancel/deadline flags of owning connection
+	
+	float TimeBudgetMs = 0.f;								///< Time budget of a single step
+	std::atomic<bool> bStepping {false};					///< Is step of this statement running now
+	EDbInterruptReason LastInterrupt = EDbInterruptReason::None;	///< Why last step was interrupted
+
+	TWeakObjectPtr<const UScriptStruct> RowStruct;				///< Struct RowBindings were built for
+	TArray<SmoothSql::FDbPropertyBinding> RowBindings;			///< Members filled by FetchInto
 };
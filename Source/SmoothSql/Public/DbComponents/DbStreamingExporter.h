@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+
+#include <atomic>
+
+struct sqlite3_stmt;
+
+/**
+ * Steps a statement and writes its rows to a file as they come
+ *
+ * Values are copied from sqlite3_column_text/blob straight into a fixed output buffer,
+ * so memory stays at FDbExportSettings::BufferKilobytes no matter how many rows are exported.
+ * Text is written as UTF-8 and blobs as hex strings in CSV and NDJSON.
+ *
+ * Columnar layout, all numbers little-endian:
+ *   "SQLC", uint32 version (1), uint32 column count, column names as uint32 length + UTF-8 bytes
+ *   row groups: uint32 row count, then for every column uint32 byte size + values of all rows of the group
+ *   value: uint8 storage class (0 null, 1 integer, 2 float, 3 text, 4 blob), then int64, double or uint32 length + bytes
+ *   file ends with row group of 0 rows
+ * Column byte sizes let readers skip columns they don't need.
+ */
+class SMOOTHSQL_API FDbStreamingExporter
+{
+public:
+
+	/// Called on the exporting thread every ProgressInterval rows
+	using FProgress = TFunction<void(int64 Rows, int64 Bytes)>;
+
+	explicit FDbStreamingExporter(const FDbExportSettings& InSettings);
+
+	/**
+	 * @brief Step statement to the end and write all rows to file, runs on the calling thread
+	 */
+	FDbExportResult Export(sqlite3_stmt* Stmt, const FString& Path, const FProgress& OnProgress = FProgress());
+
+	/**
+	 * @brief Stop export at the next row, can be called from any thread
+	 */
+	void Cancel() { bCancelled = true; }
+
+private:
+
+	FDbExportSettings Settings;
+	std::atomic<bool> bCancelled {false};
+};
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SmoothSql.h"
+#include "Data/SmoothSqliteDataTypes.h"
+#include "UObject/NoExportTypes.h"
+#include "DbTimeSlicedCursor.generated.h"
+
+class UDbStmt;
+class UDbTimeSlicedCursor;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDbCursorRowsReady, UDbTimeSlicedCursor*, Cursor);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FDbCursorFinished, UDbTimeSlicedCursor*, Cursor, EDbInterruptReason, Reason);
+
+/**
+ * Steps statement on the game thread for at most given budget per tick
+ *
+ * Produced rows are buffered until consumer pops them, stepping resumes on the next core ticker tick
+ */
+UCLASS(BlueprintType)
+class SMOOTHSQL_API UDbTimeSlicedCursor : public UObject
+{
+	GENERATED_BODY()
+
+	friend class UDbStmt;
+
+	/**
+	 * @brief Bind cursor to statement
+	 */
+	void Init(UDbStmt* InStmt, int32 InBudgetMicroseconds, int32 InMaxRowsPerTick, int32 InMaxBufferedRows);
+
+	/**
+	 * @brief Core ticker callback, steps statement until budget is exhausted
+	 * @return False when cursor should be removed from ticker
+	 */
+	bool Tick(float DeltaTime);
+
+	/**
+	 *
+	 */
+	void Finish(EDbInterruptReason Reason);
+
+public:
+
+	/**
+	 * @brief Start (or resume) stepping on core ticker
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Cursor|Action")
+	void Start();
+
+	/**
+	 * @brief Pause stepping, buffered rows are kept
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Cursor|Action")
+	void Stop();
+
+	/**
+	 * @brief Pop the oldest buffered row
+	 * @return False if buffer is empty
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Cursor|Action")
+	bool PopRow(FSqliteRow& Row);
+
+	/**
+	 * @brief Move all buffered rows out of the cursor
+	 */
+	UFUNCTION(BlueprintCallable, Category="SmoothSql|Cursor|Action")
+	void PopRows(TArray<FSqliteRow>& OutRows);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Cursor|Get")
+	int32 GetNumBufferedRows() const { return Rows.Num() - ReadIndex; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Cursor|Get")
+	bool IsFinished() const { return bFinished; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="SmoothSql|Cursor|Get")
+	bool IsRunning() const { return TickerHandle.IsValid(); }
+
+	/// Fired after a tick that produced at least one row
+	UPROPERTY(BlueprintAssignable)
+	FDbCursorRowsReady OnRowsReady;
+
+	/// Fired once statement is done or was interrupted
+	UPROPERTY(BlueprintAssignable)
+	FDbCursorFinished OnFinished;
+
+	/**
+	 *
+	 */
+	virtual void BeginDestroy() override;
+
+private:
+
+	UPROPERTY()
+	UDbStmt* Stmt;					///< Statement being stepped
+
+	int32 BudgetMicroseconds;		///< Time budget per tick
+	int32 MaxRowsPerTick;			///< Upper bound of rows per tick, 0 for unlimited
+	int32 MaxBufferedRows;			///< Stepping pauses while this many rows wait to be popped, 0 for unlimited
+	bool bFinished;					///< Statement produced all rows
+
+	TArray<FSqliteRow> Rows;		///< Buffered rows
+	int32 ReadIndex;				///< First row that was not popped yet
+
+	FDbTickerHandle TickerHandle;	///< Handle of core ticker delegate
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
+
+namespace SQLite
+{
+	class Database;
+}
+
+/**
+ * Buffers upserts in memory, later upserts of the same row overwrite earlier ones
+ *
+ * Flush writes one INSERT ... ON CONFLICT DO UPDATE per buffered row inside a single savepoint,
+ * so it joins the outer transaction if there is one. Key column must have a UNIQUE or PRIMARY KEY constraint.
+ * Upsert can be called from any thread, Flush must run on the thread that owns the connection.
+ */
+class SMOOTHSQL_API FDbWriteBehindQueue
+{
+public:
+
+	/**
+	 * @brief Buffer column values of the row identified by Key
+	 *
+	 * Columns not mentioned keep values buffered by previous upserts of the same row
+	 * @return Number of rows pending after this upsert
+	 */
+	int32 Upsert(const FString& Table, const FString& KeyColumn, const FSqliteValue& Key, const TMap<FString, FSqliteValue>& Values);
+
+	/**
+	 * @brief Write all buffered rows, rows stay buffered if writing fails
+	 * @return True if buffer was written
+	 */
+	bool Flush(SQLite::Database& Db, const FString& DbName);
+
+	int32 GetNumPendingRows() const;
+
+private:
+
+	/// Row identity
+	struct FRowKey
+	{
+		FString Table;
+		FString KeyColumn;
+		FSqliteValue Key;
+
+		bool operator==(const FRowKey& Other) const
+		{
+			return Key == Other.Key && Table == Other.Table && KeyColumn == Other.KeyColumn;
+		}
+
+		friend uint32 GetTypeHash(const FRowKey& RowKey)
+		{
+			return HashCombine(HashCombine(GetTypeHash(RowKey.Table), GetTypeHash(RowKey.KeyColumn)), GetTypeHash(RowKey.Key));
+		}
+	};
+
+	using FPendingRows = TMap<FRowKey, TMap<FString, FSqliteValue>>;
+
+	mutable FCriticalSection Mutex;		///< Guards Pending
+	FPendingRows Pending;				///< Buffered column values per row
+};
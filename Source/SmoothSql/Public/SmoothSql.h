@@ -3,11 +3,23 @@
 #pragma once
 
 #include "Modules/ModuleManager.h"
+#include "Containers/Ticker.h"
+#include "Runtime/Launch/Resources/Version.h"
 
 
 DECLARE_LOG_CATEGORY_EXTERN(LogSmoothSqlite, Display, Display);
 
 
+/// Core ticker was split into thread-safe FTSTicker in UE5
+#if ENGINE_MAJOR_VERSION >= 5
+using FDbCoreTicker = FTSTicker;
+using FDbTickerHandle = FTSTicker::FDelegateHandle;
+#else
+using FDbCoreTicker = FTicker;
+using FDbTickerHandle = FDelegateHandle;
+#endif
+
+
 
 #ifdef SQLITE_TRY
 #undef SQLITE_TRY
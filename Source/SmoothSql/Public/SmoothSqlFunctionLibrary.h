@@ -10,6 +10,7 @@
 
 class UDbObject;
 class UDbStmt;
+class UDbShardSet;
 
 
 UCLASS()
@@ -37,6 +38,30 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
 	static void K2_BindQueryParam_Name(UDbStmt*  Target, const FString& Param, const FName& Value);
 
+	
+	/// Binds by 1-based parameter index, used by typed query node
+	
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
+	static UDbStmt* K2_BindQueryParamIdx_Bool(UDbStmt* Target, int32 Index, bool Value);
+	
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
+	static UDbStmt* K2_BindQueryParamIdx_Int(UDbStmt* Target, int32 Index, int32 Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
+	static UDbStmt* K2_BindQueryParamIdx_Int64(UDbStmt* Target, int32 Index, int64 Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
+	static UDbStmt* K2_BindQueryParamIdx_Float(UDbStmt* Target, int32 Index, float Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
+	static UDbStmt* K2_BindQueryParamIdx_String(UDbStmt* Target, int32 Index, const FString& Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
+	static UDbStmt* K2_BindQueryParamIdx_Text(UDbStmt* Target, int32 Index, const FText& Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
+	static UDbStmt* K2_BindQueryParamIdx_Name(UDbStmt* Target, int32 Index, const FName& Value);
+
 
 	/// Statement Getters
 	
@@ -46,6 +71,13 @@ public:
 	static Type Get##Name##_Stmt_Str(UDbStmt* Target, const FString& ColumnName);
 
 	
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get Bool (Using Index)")) 
+	static bool GetBool_Stmt_Idx(UDbStmt* Target, int32 ColumnIdx);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get Bool (Using Name)")) 
+	static bool GetBool_Stmt_Str(UDbStmt* Target, const FString& ColumnName);
+	
+	
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get Int (Using Index)")) 
 	static int32 GetInt_Stmt_Idx(UDbStmt* Target, int32 ColumnIdx);
 
@@ -108,10 +140,115 @@ public:
 	static bool IsValid_Column(UPARAM(ref) FSqliteColumn& Column);
 
 #undef DB_COL_GETTER
+
+	/// Row getters
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get Int (Row)"))
+	static int32 GetInt_Row(const FSqliteRow& Row, int32 ColumnIdx);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get Int64 (Row)"))
+	static int64 GetInt64_Row(const FSqliteRow& Row, int32 ColumnIdx);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get Float (Row)"))
+	static float GetFloat_Row(const FSqliteRow& Row, int32 ColumnIdx);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get String (Row)"))
+	static FString GetString_Row(const FSqliteRow& Row, int32 ColumnIdx);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Get Name (Row)"))
+	static FName GetName_Row(const FSqliteRow& Row, int32 ColumnIdx);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Query", meta=(DisplayName="Is Null (Row)"))
+	static bool IsNull_Row(const FSqliteRow& Row, int32 ColumnIdx);
+
+	/// Value makers
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (Int)"))
+	static FSqliteValue MakeSqliteValue_Int(int32 Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (Int64)"))
+	static FSqliteValue MakeSqliteValue_Int64(int64 Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (Float)"))
+	static FSqliteValue MakeSqliteValue_Float(float Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (String)"))
+	static FSqliteValue MakeSqliteValue_String(const FString& Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (Name)"))
+	static FSqliteValue MakeSqliteValue_Name(FName Value);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (Null)"))
+	static FSqliteValue MakeSqliteValue_Null();
+
+	/**
+	 * Vector blob understood by vec_* SQL functions
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (Vector)"))
+	static FSqliteValue MakeSqliteValue_Vector(const FVector& Value);
+
+	/**
+	 * Quaternion blob understood by quat_* SQL functions
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value", meta=(DisplayName="Make Sqlite Value (Rotator)"))
+	static FSqliteValue MakeSqliteValue_Rotator(const FRotator& Value);
+
+	/**
+	 * @return False if value is not a vector blob
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value")
+	static bool SqliteValueToVector(const FSqliteValue& Value, FVector& Vector);
+
+	/**
+	 * @return False if value is not a quaternion blob
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "SmoothSqlite|Value")
+	static bool SqliteValueToRotator(const FSqliteValue& Value, FRotator& Rotator);
 	
 	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind")
 	static UDbStmt* K2_StepStatement(UDbStmt* Target, bool& Success);
 
+	/**
+	 * @brief Step statement and copy the row into struct, used by ForEach Query Row node
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, BlueprintInternalUseOnly, Category="SmoothSqlite|Bind", meta=(CustomStructureParam="Row"))
+	static UDbStmt* K2_StepStatementIntoStruct(UDbStmt* Target, UPARAM(ref) int32& Row, bool& Success);
+
+	static UDbStmt* StepStatementIntoStruct(UDbStmt* Target, const UScriptStruct* RowStruct, void* Row, bool& Success);
+
+	DECLARE_FUNCTION(execK2_StepStatementIntoStruct)
+	{
+		P_GET_OBJECT(UDbStmt, Target);
+
+		// Wildcard struct
+		Stack.MostRecentPropertyAddress = nullptr;
+		Stack.MostRecentProperty = nullptr;
+		Stack.StepCompiledIn<FStructProperty>(nullptr);
+		void* RowPtr = Stack.MostRecentPropertyAddress;
+		const FStructProperty* RowProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+
+		P_GET_UBOOL_REF(Success);
+		P_FINISH;
+
+		P_NATIVE_BEGIN;
+		*static_cast<UDbStmt**>(RESULT_PARAM) = StepStatementIntoStruct(Target, RowProperty ? RowProperty->Struct : nullptr, RowPtr, Success);
+		P_NATIVE_END;
+	}
+
+	/**
+	 * @brief Start transaction of Scoped Transaction node
+	 * @return Target
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Transaction")
+	static UDbObject* K2_BeginScopedTransaction(UDbObject* Target, EDbTransactionFlags Behavior, bool& Success);
+
+	/**
+	 * @brief Finish transaction of Scoped Transaction node, rolls back if any statement failed inside the scope
+	 * @return True if transaction was committed
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category="SmoothSqlite|Transaction")
+	static bool K2_EndScopedTransaction(UDbObject* Target);
+
 
 
 	
@@ -126,6 +263,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SmoothSqlite|Connection")
 	static UDbObject* OpenDbConnection(UPARAM(meta = (Bitmask, BitmaskEnum="EDbOpenFlags")) int32 OpenFlags = 2);
 
+	/**
+	 * Opens writer and reader connections to every shard of the set
+	 * @return Shard set, null if any shard failed to open
+	 */
+	UFUNCTION(BlueprintCallable, Category = "SmoothSqlite|Connection")
+	static UDbShardSet* OpenShardSet(const FDbShardSetParams& Params, UPARAM(meta = (Bitmask, BitmaskEnum="EDbOpenFlags")) int32 OpenFlags = 6);
+
 	/**
 	 *
 	 */
@@ -3,8 +3,98 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Data/SmoothSqliteDataTypes.h"
 
 struct FDatabaseDelegates
 {
 	
 };
+
+/// Result column of prepared query
+struct FDbQueryColumn
+{
+	FString Name;				///< Column name or alias
+	FString DeclaredType;		///< Type from the table definition, empty for expressions
+	EDbValueType Type;			///< Type derived from DeclaredType with SQLite affinity rules, Null if unknown
+};
+
+/// Shape of prepared query
+struct FDbQueryDescription
+{
+	TArray<FDbQueryColumn> Columns;		///< Result columns
+	TArray<FString> Params;				///< Parameter names without prefix, empty for anonymous parameters
+};
+
+namespace SQLite
+{
+	class Database;
+}
+
+namespace SmoothSql
+{
+	/**
+	 * @brief Quote table or column name so it can be spliced into SQL
+	 */
+	SMOOTHSQL_API FString QuoteIdentifier(const FString& Identifier);
+
+	/**
+	 * @brief Quote string literal so it can be spliced into SQL where parameters are not allowed
+	 */
+	SMOOTHSQL_API FString QuoteLiteral(const FString& Literal);
+
+	/**
+	 * @brief Decode UTF-8 text of column or value into string, allocating only the string
+	 * @param Len Bytes of text, without terminator
+	 */
+	SMOOTHSQL_API FString Utf8ToString(const ANSICHAR* Text, int32 Len);
+
+	/**
+	 * @brief Same as above for names, ASCII text goes straight to name table
+	 */
+	SMOOTHSQL_API FName Utf8ToName(const ANSICHAR* Text, int32 Len);
+
+	/**
+	 * @brief Is error caused by another connection holding a lock, so retrying may succeed
+	 */
+	SMOOTHSQL_API bool IsBusyError(int32 ErrorCode);
+
+	/**
+	 * @brief Type of column values given declared type of the column, see SQLite "Determination Of Column Affinity"
+	 * @return Null if type is empty
+	 */
+	SMOOTHSQL_API EDbValueType GetDeclaredTypeAffinity(const FString& DeclaredType);
+
+	/**
+	 * @brief Prepare SQL against read-only database and describe its columns and parameters, without running it
+	 * @return False if database can't be opened or SQL doesn't compile, OutError holds SQLite message
+	 */
+	SMOOTHSQL_API bool DescribeQuery(const FString& DbPath, const FString& SQL, FDbQueryDescription& OutDescription, FString& OutError);
+
+	/**
+	 * @brief Savepoint that is rolled back and released when it goes out of scope unreleased
+	 *
+	 * SQLite::Savepoint only rolls back, which leaves the transaction it began open on the connection
+	 */
+	class SMOOTHSQL_API FScopedSavepoint
+	{
+	public:
+		/**
+		 * @brief Begin savepoint, throws SQLite::Exception
+		 */
+		FScopedSavepoint(SQLite::Database& InDb, const FString& InName);
+		~FScopedSavepoint();
+
+		FScopedSavepoint(const FScopedSavepoint&) = delete;
+		FScopedSavepoint& operator=(const FScopedSavepoint&) = delete;
+
+		/**
+		 * @brief Release savepoint, throws SQLite::Exception and stays unreleased if RELEASE fails
+		 */
+		void Release();
+
+	private:
+		SQLite::Database& Db;
+		FString Name;			///< Quoted savepoint name
+		bool bReleased = false;
+	};
+}
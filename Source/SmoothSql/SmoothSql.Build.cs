@@ -8,6 +8,19 @@ public class SmoothSql : ModuleRules
 	{
 		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
 		bEnableExceptions = true;
+
+		// Changesets need sqlite built with SQLITE_ENABLE_SESSION and SQLITE_ENABLE_PREUPDATE_HOOK
+		bool bWithSession = false;
+		PublicDefinitions.Add("SMOOTHSQL_WITH_SESSION=" + (bWithSession ? "1" : "0"));
+		if (bWithSession)
+		{
+			PublicDefinitions.Add("SQLITE_ENABLE_SESSION=1");
+			PublicDefinitions.Add("SQLITE_ENABLE_PREUPDATE_HOOK=1");
+		}
+
+		// Sphere queries use geometry callback, it needs sqlite built with SQLITE_ENABLE_RTREE
+		bool bWithRTree = false;
+		PublicDefinitions.Add("SMOOTHSQL_WITH_RTREE=" + (bWithRTree ? "1" : "0"));
 		
 		PublicIncludePaths.AddRange(
 			new string[] {
@@ -38,6 +51,7 @@ public class SmoothSql : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
+				"Json"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
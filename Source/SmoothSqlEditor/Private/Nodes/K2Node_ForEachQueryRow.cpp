@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Nodes/K2Node_ForEachQueryRow.h"
+
+#include "BlueprintActionDatabaseRegistrar.h"
+#include "BlueprintNodeSpawner.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_ExecutionSequence.h"
+#include "K2Node_IfThenElse.h"
+#include "K2Node_TemporaryVariable.h"
+#include "KismetCompiler.h"
+#include "SmoothSqlFunctionLibrary.h"
+#include "DbComponents/DbStmt.h"
+
+namespace ForEachQueryRow
+{
+	static const FName InnerLoopName = "Body";
+	static const FName RowPinName = "Row";
+}
+
+UEdGraphPin* UK2Node_ForEachQueryRow::GetTargetPin() const
+{
+	return FindPinChecked(L"Target");
+}
+
+UEdGraphPin* UK2Node_ForEachQueryRow::GetLoopPin() const
+{
+	return FindPinChecked(ForEachQueryRow::InnerLoopName);
+}
+
+UEdGraphPin* UK2Node_ForEachQueryRow::GetRowPin() const
+{
+	return FindPin(ForEachQueryRow::RowPinName);
+}
+
+UEdGraphPin* UK2Node_ForEachQueryRow::GetCompletedPin() const
+{
+	return FindPinChecked(UEdGraphSchema_K2::PN_Completed);
+}
+
+void UK2Node_ForEachQueryRow::MovePinLinksOrCopyDefaults(FKismetCompilerContext& CompilerContext,
+                                                         UEdGraphPin* Source, UEdGraphPin* Dest)
+{
+	if (Source->LinkedTo.Num( ) > 0)
+	{
+		CompilerContext.MovePinLinksToIntermediate( *Source, *Dest );
+	}
+	else
+	{
+		Dest->DefaultObject = Source->DefaultObject;
+		Dest->DefaultValue = Source->DefaultValue;
+		Dest->DefaultTextValue = Source->DefaultTextValue;
+	}
+}
+
+void UK2Node_ForEachQueryRow::AllocateDefaultPins()
+{
+	Super::AllocateDefaultPins();
+
+	using GS = UEdGraphSchema_K2;
+	
+	CreatePin(EGPD_Input, GS::PC_Exec, GS::PN_Execute);
+	CreatePin(EGPD_Input, GS::PC_Object, UDbStmt::StaticClass(), "Target");
+	CreatePin(EGPD_Output, GS::PC_Exec, ForEachQueryRow::InnerLoopName);
+	if (RowStruct)
+	{
+		CreatePin(EGPD_Output, GS::PC_Struct, RowStruct, ForEachQueryRow::RowPinName);
+	}
+	CreatePin(EGPD_Output, GS::PC_Object, UDbStmt::StaticClass(), "Statement");
+	CreatePin(EGPD_Output, GS::PC_Exec, GS::PN_Completed);
+}
+
+void UK2Node_ForEachQueryRow::GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const
+{
+	// actions get registered under specific object-keys; the idea is that 
+	// actions might have to be updated (or deleted) if their object-key is  
+	// mutated (or removed)... here we use the node's class (so if the node 
+	// type disappears, then the action should go with it)
+	UClass* ActionKey = GetClass();
+	// to keep from needlessly instantiating a UBlueprintNodeSpawner, first   
+	// check to make sure that the registrar is looking for actions of this type
+	// (could be regenerating actions for a specific asset, and therefore the 
+	// registrar would only accept actions corresponding to that asset)
+	if (ActionRegistrar.IsOpenForRegistration(ActionKey))
+	{
+		UBlueprintNodeSpawner* NodeSpawner = UBlueprintNodeSpawner::Create(GetClass());
+		check(NodeSpawner != nullptr);
+
+		ActionRegistrar.AddBlueprintAction(ActionKey, NodeSpawner);
+	}
+}
+
+FText UK2Node_ForEachQueryRow::GetNodeTitle(ENodeTitleType::Type Title) const
+{
+	if (RowStruct)
+	{
+		return FText::FromString(FString::Printf(L"ForEach Query Row (%s)", *RowStruct->GetDisplayNameText().ToString()));
+	}
+	
+	return FText::FromString("ForEach Query Row");
+}
+
+bool UK2Node_ForEachQueryRow::IsNodePure() const
+{
+	return false;
+}
+
+FSlateIcon UK2Node_ForEachQueryRow::GetIconAndTint(FLinearColor& OutColor) const
+{
+	static FSlateIcon Icon("EditorStyle", "GraphEditor.Macro.Loop_16x");
+	return Icon;
+}
+
+FText UK2Node_ForEachQueryRow::GetMenuCategory() const
+{
+	return FText::FromString("SmoothSqlite|Statement");
+}
+
+FLinearColor UK2Node_ForEachQueryRow::GetNodeTitleColor() const
+{
+	return FColor(106, 90, 205);
+}
+
+void UK2Node_ForEachQueryRow::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UK2Node_ForEachQueryRow, RowStruct))
+	{
+		ReconstructNode();
+	}
+
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+
+void UK2Node_ForEachQueryRow::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
+{
+	Super::ExpandNode(CompilerContext, SourceGraph);
+	
+	if (GetTargetPin()->LinkedTo.Num() == 0)
+	{
+		CompilerContext.MessageLog.Error(L"@@ Must have connected Statement to it", GetTargetPin());
+		BreakAllNodeLinks();
+		return;
+	}
+
+	UEdGraphPin* RowPin = GetRowPin();
+	if (!RowStruct || !RowPin)
+	{
+		CompilerContext.MessageLog.Error(L"@@ Row Struct must be set", this);
+		BreakAllNodeLinks();
+		return;
+	}
+	
+	const UEdGraphSchema_K2* Schema = CompilerContext.GetSchema();
+
+	// Local row variable, filled by the step
+	UK2Node_TemporaryVariable* Row = CompilerContext.SpawnIntermediateNode<UK2Node_TemporaryVariable>(this, SourceGraph);
+	Row->VariableType.PinCategory = UEdGraphSchema_K2::PC_Struct;
+	Row->VariableType.PinSubCategoryObject = RowStruct;
+	Row->AllocateDefaultPins();
+	
+	UK2Node_IfThenElse* Branch = CompilerContext.SpawnIntermediateNode<UK2Node_IfThenElse>(this, SourceGraph);
+	Branch->AllocateDefaultPins();
+	
+	UK2Node_ExecutionSequence* Sequence = CompilerContext.SpawnIntermediateNode<UK2Node_ExecutionSequence>(this, SourceGraph);
+	Sequence->AllocateDefaultPins();
+	
+	UK2Node_CallFunction* Step = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph); 
+	Step->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_StepStatementIntoStruct), USmoothSqlFunctionLibrary::StaticClass());
+	Step->AllocateDefaultPins();
+
+	// Wildcard row pin takes type of the variable
+	UEdGraphPin* StepRowPin = Step->FindPinChecked(ForEachQueryRow::RowPinName);
+	StepRowPin->PinType = Row->GetVariablePin()->PinType;
+	StepRowPin->PinType.bIsReference = true;
+	
+	bool bConnected = Schema->TryCreateConnection(Row->GetVariablePin(), StepRowPin);
+	bConnected &= Schema->TryCreateConnection(Step->GetThenPin(), Branch->GetExecPin());
+	bConnected &= Schema->TryCreateConnection(Step->FindPinChecked(L"Success"), Branch->GetConditionPin());
+	bConnected &= Schema->TryCreateConnection(Branch->GetThenPin(), Sequence->GetExecPin());
+	bConnected &= Schema->TryCreateConnection(Sequence->GetThenPinGivenIndex(1), Step->GetExecPin());
+	if (!bConnected)
+	{
+		CompilerContext.MessageLog.Error(L"@@ Internal connection failed", this);
+		BreakAllNodeLinks();
+		return;
+	}
+	
+	MovePinLinksOrCopyDefaults(CompilerContext, GetExecPin(), Step->GetExecPin());
+	MovePinLinksOrCopyDefaults(CompilerContext, GetLoopPin(), Sequence->GetThenPinGivenIndex(0));
+	MovePinLinksOrCopyDefaults(CompilerContext, GetCompletedPin(), Branch->GetElsePin());
+	MovePinLinksOrCopyDefaults(CompilerContext, GetTargetPin(), Step->FindPinChecked(L"Target"));
+	MovePinLinksOrCopyDefaults(CompilerContext, FindPinChecked(L"Statement"), Step->GetReturnValuePin());
+	MovePinLinksOrCopyDefaults(CompilerContext, RowPin, Row->GetVariablePin());
+	
+	BreakAllNodeLinks();
+}
+
+FText UK2Node_ForEachQueryRow::GetTooltipText() const
+{
+	return FText::FromString("Iterate over query results, reading each row into Row Struct.\nMembers are filled from columns with the same names.");
+}
@@ -5,27 +5,22 @@
 
 #include "BlueprintActionDatabaseRegistrar.h"
 #include "BlueprintNodeSpawner.h"
-#include "K2Node_AssignmentStatement.h"
 #include "K2Node_CallFunction.h"
 #include "K2Node_ExecutionSequence.h"
 #include "K2Node_IfThenElse.h"
-#include "K2Node_TemporaryVariable.h"
-#include "K2Node_VariableSet.h"
 #include "KismetCompiler.h"
 #include "SmoothSqlFunctionLibrary.h"
 #include "Data/SmoothSqliteDataTypes.h"
 #include "DbComponents/DbObject.h"
-#include "Kismet/KismetMathLibrary.h"
-#include "Kismet/KismetSystemLibrary.h"
 
 static FName TargetPinName = L"Connection";
-static FName CreateNewConnectionPinName = L"Create New Connection";
-static FName DbConnectionParmsPinName = L"Connection Params";
+static FName BehaviorPinName = L"Behavior";
 static FName DbConnectionOutPinName = L"Scoped Connection";
 static FName ScopeExitPinName = L"Scope Completed";
+static FName FailedPinName = L"Failed";
 
 
-void MovePinLinksOrCopyDefaults(FKismetCompilerContext& CompilerContext, UEdGraphPin* Source,
+static void MovePinLinksOrCopyDefaults(FKismetCompilerContext& CompilerContext, UEdGraphPin* Source,
 	UEdGraphPin* Dest)
 {
 	if (Source->LinkedTo.Num( ) > 0)
@@ -41,19 +36,14 @@ void MovePinLinksOrCopyDefaults(FKismetCompilerContext& CompilerContext, UEdGrap
 }
 
 
-UEdGraphPin* UK2Node_ScopedTransaction::GetConditionCreatePin() const
-{
-	return FindPinChecked(CreateNewConnectionPinName);
-}
-
-UEdGraphPin* UK2Node_ScopedTransaction::GetInnerDbHandlePin() const
+UEdGraphPin* UK2Node_ScopedTransaction::GetDbHandlePin() const
 {
-	return FindPinChecked(DbConnectionOutPinName);
+	return FindPinChecked(TargetPinName);
 }
 
-UEdGraphPin* UK2Node_ScopedTransaction::GetConnectionParamsPin() const
+UEdGraphPin* UK2Node_ScopedTransaction::GetBehaviorPin() const
 {
-	return FindPin(DbConnectionParmsPinName);
+	return FindPinChecked(BehaviorPinName);
 }
 
 UEdGraphPin* UK2Node_ScopedTransaction::GetThenPin() const
@@ -61,9 +51,9 @@ UEdGraphPin* UK2Node_ScopedTransaction::GetThenPin() const
 	return FindPinChecked(UEdGraphSchema_K2::PN_Then);
 }
 
-UEdGraphPin* UK2Node_ScopedTransaction::GetDbHandlePin() const
+UEdGraphPin* UK2Node_ScopedTransaction::GetInnerDbHandlePin() const
 {
-	return FindPinChecked(TargetPinName);
+	return FindPinChecked(DbConnectionOutPinName);
 }
 
 UEdGraphPin* UK2Node_ScopedTransaction::GetScopeExitPin() const
@@ -71,31 +61,9 @@ UEdGraphPin* UK2Node_ScopedTransaction::GetScopeExitPin() const
 	return FindPinChecked(ScopeExitPinName);
 }
 
-void UK2Node_ScopedTransaction::UpdateConnectionPin()
+UEdGraphPin* UK2Node_ScopedTransaction::GetFailedPin() const
 {
-	// if (!GetConditionCreatePin()->HasAnyConnections() && GetConditionCreatePin()->DefaultValue == "true")
-	// {
-	// 	CreatePin(EGPD_Input, UEdGraphSchema_K2::PC_Struct, FSqliteDBConnectionParms::StaticStruct(), DbConnectionParmsPinName);
-	//
-	// 	if (const auto TargetPin = FindPin(TargetPinName))
-	// 	{
-	// 		RemovePin(TargetPin);	
-	// 	}
-	// }
-	// else
-	// {
-	// 	CreatePin(EGPD_Input, UEdGraphSchema_K2::PC_Struct, FDbConnectionHandle::StaticStruct(), TargetPinName);
-	// 	
-	// 	if (const auto ParamsPin = FindPin(DbConnectionParmsPinName))
-	// 	{
-	// 		RemovePin(ParamsPin);	
-	// 	}
-	// }
-	//
-	// if (auto Graph = GetGraph())
-	// {
-	// 	Graph->NotifyGraphChanged();
-	// }
+	return FindPinChecked(FailedPinName);
 }
 
 void UK2Node_ScopedTransaction::AllocateDefaultPins()
@@ -103,11 +71,15 @@ void UK2Node_ScopedTransaction::AllocateDefaultPins()
 	using GS = UEdGraphSchema_K2;
 
 	CreatePin(EGPD_Input, GS::PC_Exec, GS::PN_Execute);
-	// CreatePin(EGPD_Input, GS::PC_Boolean, CreateNewConnectionPinName);
-	CreatePin(EGPD_Input, GS::PC_Struct, FSqliteDBConnectionParms::StaticStruct(), DbConnectionParmsPinName);
-	CreatePin(EGPD_Output, GS::PC_Exec, GS::PN_Then);
+	CreatePin(EGPD_Input, GS::PC_Object, UDbObject::StaticClass(), TargetPinName);
+	
+	UEdGraphPin* BehaviorPin = CreatePin(EGPD_Input, GS::PC_Byte, StaticEnum<EDbTransactionFlags>(), BehaviorPinName);
+	BehaviorPin->DefaultValue = StaticEnum<EDbTransactionFlags>()->GetNameStringByValue(static_cast<int64>(EDbTransactionFlags::Deferred));
+	
+	CreatePin(EGPD_Output, GS::PC_Exec, GS::PN_Then)->PinFriendlyName = FText::FromString(L"Body");
 	CreatePin(EGPD_Output, GS::PC_Object, UDbObject::StaticClass(), DbConnectionOutPinName);
 	CreatePin(EGPD_Output, GS::PC_Exec, ScopeExitPinName);
+	CreatePin(EGPD_Output, GS::PC_Exec, FailedPinName);
 }
 
 FText UK2Node_ScopedTransaction::GetNodeTitle(ENodeTitleType::Type Title) const
@@ -122,7 +94,7 @@ bool UK2Node_ScopedTransaction::IsNodePure() const
 
 FText UK2Node_ScopedTransaction::GetTooltipText() const
 {
-	return Super::GetTooltipText();
+	return FText::FromString(L"Run Body in one transaction of the connection.\nTransaction is committed after Body, or rolled back if any statement failed inside it.");
 }
 
 FLinearColor UK2Node_ScopedTransaction::GetNodeTitleColor() const
@@ -132,39 +104,12 @@ FLinearColor UK2Node_ScopedTransaction::GetNodeTitleColor() const
 
 FText UK2Node_ScopedTransaction::GetKeywords() const
 {
-	return Super::GetKeywords();
+	return FText::FromString(L"Transaction Commit Rollback");
 }
 
 FText UK2Node_ScopedTransaction::GetMenuCategory() const
 {
-	return Super::GetMenuCategory();
-}
-
-void UK2Node_ScopedTransaction::ReconstructNode()
-{
-	Super::ReconstructNode();
-
-	// UpdateConnectionPin();
-}
-
-void UK2Node_ScopedTransaction::PinDefaultValueChanged(UEdGraphPin* Pin)
-{
-	Super::PinDefaultValueChanged(Pin);
-
-	// if (Pin == GetConditionCreatePin())
-	// {
-	// 	UpdateConnectionPin();
-	// }
-}
-
-void UK2Node_ScopedTransaction::PinConnectionListChanged(UEdGraphPin* Pin)
-{
-	Super::PinConnectionListChanged(Pin);
-	
-// 	if (Pin == GetConditionCreatePin())
-// 	{
-// 		UpdateConnectionPin();
-// 	}
+	return FText::FromString("SmoothSqlite|Transaction");
 }
 
 void UK2Node_ScopedTransaction::GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const
@@ -190,83 +135,59 @@ void UK2Node_ScopedTransaction::GetMenuActions(FBlueprintActionDatabaseRegistrar
 void UK2Node_ScopedTransaction::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
 {
 	Super::ExpandNode(CompilerContext, SourceGraph);
+
+	if (GetDbHandlePin()->LinkedTo.Num() == 0)
+	{
+		CompilerContext.MessageLog.Error(L"@@ Must have connected Connection to it", GetDbHandlePin());
+		BreakAllNodeLinks();
+		return;
+	}
 	
-	auto Schema = CompilerContext.GetSchema();
-	
-	UK2Node_ExecutionSequence* Sequence = CompilerContext.SpawnIntermediateNode<UK2Node_ExecutionSequence>(this, SourceGraph);
-	Sequence->AllocateDefaultPins();
+	const UEdGraphSchema_K2* Schema = CompilerContext.GetSchema();
+
+	// Begin -> Branch(Success) -> Sequence: [0] Body, [1] End -> Branch(Committed) -> Completed
+	// Failing Begin or End leads to Failed
 	
 	UK2Node_CallFunction* CallBeginFunction = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-	CallBeginFunction->FunctionReference.SetExternalMember(L"BeginTransaction", USmoothSqlFunctionLibrary::StaticClass());
+	CallBeginFunction->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BeginScopedTransaction), USmoothSqlFunctionLibrary::StaticClass());
 	CallBeginFunction->AllocateDefaultPins();
 
-	UK2Node_CallFunction* CallCommitFunction = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-	CallCommitFunction->FunctionReference.SetExternalMember(L"CommitTransaction", USmoothSqlFunctionLibrary::StaticClass());
-	CallCommitFunction->AllocateDefaultPins();
-	
-	UK2Node_CallFunction* CallCreateConnection = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-	CallCreateConnection->FunctionReference.SetExternalMember(L"OpenDbConnection", USmoothSqlFunctionLibrary::StaticClass());
-	CallCreateConnection->AllocateDefaultPins();
-	
+	UK2Node_IfThenElse* BeginBranch = CompilerContext.SpawnIntermediateNode<UK2Node_IfThenElse>(this, SourceGraph);
+	BeginBranch->AllocateDefaultPins();
 	
-	// UK2Node_CallFunction* CallCompFunction = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-	// CallCompFunction->FunctionReference.SetExternalMember(L"EqualEqual_BoolBool", UKismetMathLibrary::StaticClass());
-	// CallCompFunction->AllocateDefaultPins();
-
-	UK2Node_TemporaryVariable* TempVar = CompilerContext.SpawnIntermediateNode<UK2Node_TemporaryVariable>(this, SourceGraph);
-	TempVar->VariableType.PinCategory = UEdGraphSchema_K2::PC_Struct;
-	TempVar->VariableType.PinSubCategoryObject = UDbObject::StaticClass();
-	TempVar->AllocateDefaultPins();
-
-	UK2Node_AssignmentStatement* TempVarAssign = CompilerContext.SpawnIntermediateNode<UK2Node_AssignmentStatement>(this, SourceGraph);
-	TempVarAssign->AllocateDefaultPins();
-
-	// bool bWillCreateConnection = false;
-	// // Route from OpenDbConnection
-	// if (auto ParmsPin = GetConnectionParamsPin())
-	// {
-	// 	Schema->TryCreateConnection(TempVar->GetVariablePin(), TempVarAssign->GetVariablePin());
-	// 	Schema->TryCreateConnection(CallCreateConnection->GetReturnValuePin(), TempVarAssign->GetValuePin());
-	// 	MovePinLinksOrCopyDefaults(CompilerContext, ParmsPin, CallCreateConnection->FindPinChecked(L"Parms"));
-	// 	bWillCreateConnection = true;
-	// }
-	// else // Route from input
-	// {
-	// 	Schema->TryCreateConnection(TempVar->GetVariablePin(), TempVarAssign->GetVariablePin());
-	// 	MovePinLinksOrCopyDefaults(CompilerContext, GetDbHandlePin(), TempVarAssign->GetValuePin());
-	// }
-
-	// If need to craete connection
-	// UK2Node_IfThenElse* Branch = CompilerContext.SpawnIntermediateNode<UK2Node_IfThenElse>(this, SourceGraph);
-	// Branch->AllocateDefaultPins();
-
-	// // From comparison to branch condition
-	// Schema->TryCreateConnection(CallCompFunction->GetReturnValuePin(), Branch->GetConditionPin());
-	//
-	// // --> Create connection
-	// MovePinLinksOrCopyDefaults(CompilerContext, GetConditionCreatePin(), CallCompFunction->FindPinChecked(L"A"));
-	// // --> True
-	// CallCompFunction->FindPinChecked(L"B")->DefaultValue = "true";
-
-	// --> To Branch
-	Schema->TryCreateConnection(Sequence->GetThenPinGivenIndex(0), CallCreateConnection->GetExecPin());
-	// --> To Commit
-	Schema->TryCreateConnection(Sequence->GetThenPinGivenIndex(1), CallCommitFunction->GetExecPin());
-	Schema->TryCreateConnection(CallCreateConnection->GetThenPin(), TempVarAssign->GetExecPin());
-
-	Schema->TryCreateConnection(TempVar->GetVariablePin(), TempVarAssign->GetVariablePin());
-	Schema->TryCreateConnection(CallCreateConnection->GetReturnValuePin(), TempVarAssign->GetValuePin());
+	UK2Node_ExecutionSequence* Sequence = CompilerContext.SpawnIntermediateNode<UK2Node_ExecutionSequence>(this, SourceGraph);
+	Sequence->AllocateDefaultPins();
+
+	UK2Node_CallFunction* CallEndFunction = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+	CallEndFunction->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_EndScopedTransaction), USmoothSqlFunctionLibrary::StaticClass());
+	CallEndFunction->AllocateDefaultPins();
+
+	UK2Node_IfThenElse* EndBranch = CompilerContext.SpawnIntermediateNode<UK2Node_IfThenElse>(this, SourceGraph);
+	EndBranch->AllocateDefaultPins();
+
+	Schema->TryCreateConnection(CallBeginFunction->GetThenPin(), BeginBranch->GetExecPin());
+	Schema->TryCreateConnection(CallBeginFunction->FindPinChecked(L"Success"), BeginBranch->GetConditionPin());
+	Schema->TryCreateConnection(BeginBranch->GetThenPin(), Sequence->GetExecPin());
 	
-	// --> To Begin Commit
-	Schema->TryCreateConnection(TempVarAssign->GetThenPin(), CallBeginFunction->GetExecPin());
-	Schema->TryCreateConnection(TempVar->GetVariablePin(), CallBeginFunction->FindPinChecked(L"Handle"));
-	Schema->TryCreateConnection(TempVar->GetVariablePin(), CallCommitFunction->FindPinChecked(L"Handle"));
-
-	MovePinLinksOrCopyDefaults(CompilerContext, GetConnectionParamsPin(), CallCreateConnection->FindPinChecked(L"Parms"));
-	MovePinLinksOrCopyDefaults(CompilerContext, GetInnerDbHandlePin(), TempVar->GetVariablePin());
-	MovePinLinksOrCopyDefaults(CompilerContext, GetExecPin(), Sequence->GetExecPin());
-	MovePinLinksOrCopyDefaults(CompilerContext, GetThenPin(), CallBeginFunction->GetThenPin());
-	MovePinLinksOrCopyDefaults(CompilerContext, GetScopeExitPin(), CallCommitFunction->GetThenPin());
+	Schema->TryCreateConnection(Sequence->GetThenPinGivenIndex(1), CallEndFunction->GetExecPin());
+	Schema->TryCreateConnection(CallBeginFunction->GetReturnValuePin(), CallEndFunction->FindPinChecked(L"Target"));
+	Schema->TryCreateConnection(CallEndFunction->GetThenPin(), EndBranch->GetExecPin());
+	Schema->TryCreateConnection(CallEndFunction->GetReturnValuePin(), EndBranch->GetConditionPin());
+
+	MovePinLinksOrCopyDefaults(CompilerContext, GetExecPin(), CallBeginFunction->GetExecPin());
+	MovePinLinksOrCopyDefaults(CompilerContext, GetDbHandlePin(), CallBeginFunction->FindPinChecked(L"Target"));
+	MovePinLinksOrCopyDefaults(CompilerContext, GetBehaviorPin(), CallBeginFunction->FindPinChecked(L"Behavior"));
+	MovePinLinksOrCopyDefaults(CompilerContext, GetInnerDbHandlePin(), CallBeginFunction->GetReturnValuePin());
+	MovePinLinksOrCopyDefaults(CompilerContext, GetThenPin(), Sequence->GetThenPinGivenIndex(0));
+	MovePinLinksOrCopyDefaults(CompilerContext, GetScopeExitPin(), EndBranch->GetThenPin());
+
+	// Both failures lead to the same pin
+	UEdGraphPin* FailedPin = GetFailedPin();
+	if (FailedPin->LinkedTo.Num() > 0)
+	{
+		CompilerContext.CopyPinLinksToIntermediate(*FailedPin, *BeginBranch->GetElsePin());
+		CompilerContext.MovePinLinksToIntermediate(*FailedPin, *EndBranch->GetElsePin());
+	}
 
 	BreakAllNodeLinks();
 }
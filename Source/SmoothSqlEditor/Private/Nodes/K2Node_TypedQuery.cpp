@@ -0,0 +1,459 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Nodes/K2Node_TypedQuery.h"
+
+#include "BlueprintActionDatabaseRegistrar.h"
+#include "BlueprintNodeSpawner.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_ExecutionSequence.h"
+#include "K2Node_IfThenElse.h"
+#include "KismetCompiler.h"
+#include "SmoothSqlFunctionLibrary.h"
+#include "SmoothSqliteUtils.h"
+#include "DbComponents/DbObject.h"
+#include "DbComponents/DbStmt.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+
+namespace TypedQuery
+{
+	static const FName TargetPinName = L"Connection";
+	static const FName InnerLoopName = L"Body";
+
+	/// Pin type and getter of result column
+	struct FColumnPinType
+	{
+		FName Category;
+		FName Getter;
+	};
+
+	FColumnPinType GetColumnPinType(EDbValueType Type, const FString& DeclaredType)
+	{
+		using GS = UEdGraphSchema_K2;
+
+		// BOOL has NUMERIC affinity, but reads better as a bool
+		if (DeclaredType.Contains(L"BOOL"))
+			return { GS::PC_Boolean, GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, GetBool_Stmt_Idx) };
+
+		switch (Type)
+		{
+		case EDbValueType::Integer:
+			if (DeclaredType.Contains(L"BIG") || DeclaredType.Contains(L"INT64"))
+				return { GS::PC_Int64, GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, GetInt64_Stmt_Idx) };
+			return { GS::PC_Int, GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, GetInt_Stmt_Idx) };
+
+		case EDbValueType::Float:
+			return { GS::PC_Float, GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, GetFloat_Stmt_Idx) };
+
+		default:
+			// Text, expressions without declared type and blobs are read as text
+			return { GS::PC_String, GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, GetString_Stmt_Idx) };
+		}
+	}
+
+	FName GetBindFunctionName(const FName& PinCategory)
+	{
+		using GS = UEdGraphSchema_K2;
+
+		if (PinCategory == GS::PC_Boolean)
+			return GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BindQueryParamIdx_Bool);
+		if (PinCategory == GS::PC_Int)
+			return GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BindQueryParamIdx_Int);
+		if (PinCategory == GS::PC_Int64)
+			return GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BindQueryParamIdx_Int64);
+		if (PinCategory == GS::PC_Float)
+			return GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BindQueryParamIdx_Float);
+		if (PinCategory == GS::PC_String)
+			return GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BindQueryParamIdx_String);
+		if (PinCategory == GS::PC_Text)
+			return GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BindQueryParamIdx_Text);
+		if (PinCategory == GS::PC_Name)
+			return GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_BindQueryParamIdx_Name);
+
+		return NAME_None;
+	}
+
+	FName MakeParamPinName(int32 Idx)
+	{
+		return *FString::Printf(L"Param_%d", Idx);
+	}
+
+	FName MakeColumnPinName(int32 Idx)
+	{
+		return *FString::Printf(L"Column_%d", Idx);
+	}
+}
+
+void UK2Node_TypedQuery::MovePinLinksOrCopyDefaults(FKismetCompilerContext& CompilerContext, UEdGraphPin* Source, UEdGraphPin* Dest)
+{
+	if (Source->LinkedTo.Num( ) > 0)
+	{
+		CompilerContext.MovePinLinksToIntermediate( *Source, *Dest );
+	}
+	else
+	{
+		Dest->DefaultObject = Source->DefaultObject;
+		Dest->DefaultValue = Source->DefaultValue;
+		Dest->DefaultTextValue = Source->DefaultTextValue;
+	}
+}
+
+UEdGraphPin* UK2Node_TypedQuery::GetTargetPin() const
+{
+	return FindPinChecked(TypedQuery::TargetPinName);
+}
+
+UEdGraphPin* UK2Node_TypedQuery::GetLoopPin() const
+{
+	return FindPinChecked(TypedQuery::InnerLoopName);
+}
+
+UEdGraphPin* UK2Node_TypedQuery::GetCompletedPin() const
+{
+	return FindPinChecked(UEdGraphSchema_K2::PN_Completed);
+}
+
+UEdGraphPin* UK2Node_TypedQuery::GetParamPin(int32 Idx) const
+{
+	return FindPinChecked(TypedQuery::MakeParamPinName(Idx));
+}
+
+UEdGraphPin* UK2Node_TypedQuery::GetColumnPin(int32 Idx) const
+{
+	return FindPinChecked(TypedQuery::MakeColumnPinName(Idx));
+}
+
+FString UK2Node_TypedQuery::GetSchemaDbPath() const
+{
+	if (SchemaDatabase.FilePath.IsEmpty())
+	{
+		return UDbObject::MakeDbPath(UDbObject::GetDefaultConnectionParams());
+	}
+
+	return FPaths::ConvertRelativePathToFull(SchemaDatabase.FilePath);
+}
+
+void UK2Node_TypedQuery::RefreshSchema()
+{
+	ColumnNames.Reset();
+	ColumnTypes.Reset();
+	ColumnDeclaredTypes.Reset();
+	ParamNames.Reset();
+	SchemaError.Reset();
+
+	if (SQL.IsEmpty())
+	{
+		return;
+	}
+
+	FDbQueryDescription Description;
+	if (!SmoothSql::DescribeQuery(GetSchemaDbPath(), SQL, Description, SchemaError))
+	{
+		return;
+	}
+
+	for (const FDbQueryColumn& Column : Description.Columns)
+	{
+		ColumnNames.Add(Column.Name);
+		ColumnTypes.Add(static_cast<uint8>(Column.Type));
+		ColumnDeclaredTypes.Add(Column.DeclaredType);
+	}
+	ParamNames = Description.Params;
+}
+
+void UK2Node_TypedQuery::SyncParamType(UEdGraphPin* Pin)
+{
+	if (!Pin || Pin->Direction != EGPD_Input || !Pin->PinName.ToString().StartsWith(L"Param_"))
+	{
+		return;
+	}
+
+	bool bPinTypeChanged = false;
+	if (Pin->LinkedTo.Num() == 0)
+	{
+		static const FEdGraphPinType WildcardPinType = FEdGraphPinType(UEdGraphSchema_K2::PC_Wildcard, NAME_None, nullptr, EPinContainerType::None, false, FEdGraphTerminalType());
+
+		if (Pin->PinType != WildcardPinType)
+		{
+			Pin->PinType = WildcardPinType;
+			bPinTypeChanged = true;
+		}
+	}
+	else
+	{
+		auto ArgSourcePin = Pin->LinkedTo[0];
+
+		if (Pin->PinType != ArgSourcePin->PinType)
+		{
+			Pin->PinType = ArgSourcePin->PinType;
+			bPinTypeChanged = true;
+		}
+	}
+
+	if (bPinTypeChanged)
+	{
+		GetGraph()->NotifyGraphChanged();
+
+		auto BP = GetBlueprint();
+		if (!BP->bBeingCompiled)
+		{
+			FBlueprintEditorUtils::MarkBlueprintAsModified(BP);
+			BP->BroadcastChanged();
+		}
+	}
+}
+
+void UK2Node_TypedQuery::AllocateDefaultPins()
+{
+	Super::AllocateDefaultPins();
+
+	using GS = UEdGraphSchema_K2;
+
+	CreatePin(EGPD_Input, GS::PC_Exec, GS::PN_Execute);
+	CreatePin(EGPD_Input, GS::PC_Object, UDbObject::StaticClass(), TypedQuery::TargetPinName);
+
+	for (int32 Idx = 0; Idx < ParamNames.Num(); ++Idx)
+	{
+		UEdGraphPin* Pin = CreatePin(EGPD_Input, GS::PC_Wildcard, TypedQuery::MakeParamPinName(Idx));
+		Pin->PinFriendlyName = FText::FromString(ParamNames[Idx].IsEmpty() ? FString::Printf(L"?%d", Idx + 1) : ParamNames[Idx]);
+	}
+
+	CreatePin(EGPD_Output, GS::PC_Exec, TypedQuery::InnerLoopName);
+
+	for (int32 Idx = 0; Idx < ColumnNames.Num(); ++Idx)
+	{
+		const TypedQuery::FColumnPinType PinType = TypedQuery::GetColumnPinType(static_cast<EDbValueType>(ColumnTypes[Idx]), ColumnDeclaredTypes[Idx]);
+
+		UEdGraphPin* Pin = CreatePin(EGPD_Output, PinType.Category, TypedQuery::MakeColumnPinName(Idx));
+		Pin->PinFriendlyName = FText::FromString(ColumnNames[Idx]);
+		Pin->PinToolTip = ColumnDeclaredTypes[Idx].IsEmpty() ? ColumnNames[Idx] : FString::Printf(L"%s %s", *ColumnNames[Idx], *ColumnDeclaredTypes[Idx]);
+	}
+
+	CreatePin(EGPD_Output, GS::PC_Exec, GS::PN_Completed);
+}
+
+FText UK2Node_TypedQuery::GetNodeTitle(ENodeTitleType::Type Title) const
+{
+	if (Title == ENodeTitleType::FullTitle && !SQL.IsEmpty())
+	{
+		FString FirstLine;
+		SQL.Split(L"\n", &FirstLine, nullptr);
+		return FText::FromString(FString::Printf(L"Typed Query\n%s", *(FirstLine.IsEmpty() ? SQL : FirstLine).Left(64)));
+	}
+
+	return FText::FromString(L"Typed Query");
+}
+
+bool UK2Node_TypedQuery::IsNodePure() const
+{
+	return false;
+}
+
+FText UK2Node_TypedQuery::GetTooltipText() const
+{
+	FString Tooltip = L"Run SQL checked at compile time and iterate over its rows.";
+	if (!SchemaError.IsEmpty())
+	{
+		Tooltip += L"\nError: " + SchemaError;
+	}
+
+	return FText::FromString(Tooltip);
+}
+
+FLinearColor UK2Node_TypedQuery::GetNodeTitleColor() const
+{
+	return FColor(106, 90, 205);
+}
+
+FSlateIcon UK2Node_TypedQuery::GetIconAndTint(FLinearColor& OutColor) const
+{
+	static FSlateIcon Icon("EditorStyle", "GraphEditor.Macro.Loop_16x");
+	return Icon;
+}
+
+FText UK2Node_TypedQuery::GetMenuCategory() const
+{
+	return FText::FromString("SmoothSqlite|Statement");
+}
+
+void UK2Node_TypedQuery::GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const
+{
+	// actions get registered under specific object-keys; the idea is that
+	// actions might have to be updated (or deleted) if their object-key is
+	// mutated (or removed)... here we use the node's class (so if the node
+	// type disappears, then the action should go with it)
+	UClass* ActionKey = GetClass();
+	// to keep from needlessly instantiating a UBlueprintNodeSpawner, first
+	// check to make sure that the registrar is looking for actions of this type
+	// (could be regenerating actions for a specific asset, and therefore the
+	// registrar would only accept actions corresponding to that asset)
+	if (ActionRegistrar.IsOpenForRegistration(ActionKey))
+	{
+		UBlueprintNodeSpawner* NodeSpawner = UBlueprintNodeSpawner::Create(GetClass());
+		check(NodeSpawner != nullptr);
+
+		ActionRegistrar.AddBlueprintAction(ActionKey, NodeSpawner);
+	}
+}
+
+bool UK2Node_TypedQuery::IsConnectionDisallowed(const UEdGraphPin* MyPin, const UEdGraphPin* OtherPin, FString& OutReason) const
+{
+	if (MyPin->Direction == EGPD_Input && MyPin->PinName.ToString().StartsWith(L"Param_"))
+	{
+		if (TypedQuery::GetBindFunctionName(OtherPin->PinType.PinCategory) == NAME_None || OtherPin->PinType.IsContainer())
+		{
+			OutReason = "Can bind only Bool, Int, Int64, Float, String, Text and Name";
+			return true;
+		}
+	}
+
+	return Super::IsConnectionDisallowed(MyPin, OtherPin, OutReason);
+}
+
+void UK2Node_TypedQuery::PinConnectionListChanged(UEdGraphPin* Pin)
+{
+	Super::PinConnectionListChanged(Pin);
+	SyncParamType(Pin);
+}
+
+void UK2Node_TypedQuery::ReconstructNode()
+{
+	Super::ReconstructNode();
+
+	for (int32 Idx = 0; Idx < ParamNames.Num(); ++Idx)
+	{
+		SyncParamType(GetParamPin(Idx));
+	}
+}
+
+void UK2Node_TypedQuery::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	const FName PropertyName = PropertyChangedEvent.GetPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(UK2Node_TypedQuery, SQL) || PropertyName == GET_MEMBER_NAME_CHECKED(FFilePath, FilePath))
+	{
+		RefreshSchema();
+		ReconstructNode();
+	}
+
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+
+void UK2Node_TypedQuery::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
+{
+	Super::ExpandNode(CompilerContext, SourceGraph);
+
+	if (GetTargetPin()->LinkedTo.Num() == 0)
+	{
+		CompilerContext.MessageLog.Error(L"@@ Must have connected Connection to it", GetTargetPin());
+		BreakAllNodeLinks();
+		return;
+	}
+
+	// Schema may have changed since pins were generated
+	FDbQueryDescription Description;
+	FString Error;
+	if (!SmoothSql::DescribeQuery(GetSchemaDbPath(), SQL, Description, Error))
+	{
+		CompilerContext.MessageLog.Error(*FString::Printf(L"@@ SQL does not compile: %s", *Error), this);
+		BreakAllNodeLinks();
+		return;
+	}
+
+	bool bSchemaChanged = Description.Columns.Num() != ColumnNames.Num() || Description.Params != ParamNames;
+	for (int32 Idx = 0; !bSchemaChanged && Idx < ColumnNames.Num(); ++Idx)
+	{
+		bSchemaChanged = Description.Columns[Idx].Name != ColumnNames[Idx] || Description.Columns[Idx].DeclaredType != ColumnDeclaredTypes[Idx];
+	}
+
+	if (bSchemaChanged)
+	{
+		CompilerContext.MessageLog.Error(L"@@ Columns or parameters of SQL changed, refresh the node", this);
+		BreakAllNodeLinks();
+		return;
+	}
+
+	for (int32 Idx = 0; Idx < ParamNames.Num(); ++Idx)
+	{
+		if (GetParamPin(Idx)->PinType.PinCategory == UEdGraphSchema_K2::PC_Wildcard)
+		{
+			CompilerContext.MessageLog.Error(L"Parameter @@ must be connected", GetParamPin(Idx));
+			BreakAllNodeLinks();
+			return;
+		}
+	}
+
+	const UEdGraphSchema_K2* Schema = CompilerContext.GetSchema();
+
+	// Prepare once per connection
+	UK2Node_CallFunction* Prepare = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+	Prepare->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(UDbObject, PrepareCached), UDbObject::StaticClass());
+	Prepare->AllocateDefaultPins();
+	Prepare->FindPinChecked(L"SQL")->DefaultValue = SQL;
+
+	MovePinLinksOrCopyDefaults(CompilerContext, GetExecPin(), Prepare->GetExecPin());
+	MovePinLinksOrCopyDefaults(CompilerContext, GetTargetPin(), Prepare->FindPinChecked(UEdGraphSchema_K2::PN_Self));
+
+	UEdGraphPin* StatementPin = Prepare->GetReturnValuePin();
+	UEdGraphPin* LastThenPin = Prepare->GetThenPin();
+
+	// Bind params by index
+	for (int32 Idx = 0; Idx < ParamNames.Num(); ++Idx)
+	{
+		UEdGraphPin* ParamPin = GetParamPin(Idx);
+
+		UK2Node_CallFunction* Bind = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+		Bind->FunctionReference.SetExternalMember(TypedQuery::GetBindFunctionName(ParamPin->PinType.PinCategory), USmoothSqlFunctionLibrary::StaticClass());
+		Bind->AllocateDefaultPins();
+		Bind->FindPinChecked(L"Index")->DefaultValue = FString::FromInt(Idx + 1);
+
+		Schema->TryCreateConnection(LastThenPin, Bind->GetExecPin());
+		Schema->TryCreateConnection(StatementPin, Bind->FindPinChecked(L"Target"));
+		MovePinLinksOrCopyDefaults(CompilerContext, ParamPin, Bind->FindPinChecked(L"Value"));
+
+		LastThenPin = Bind->GetThenPin();
+	}
+
+	// Same loop as ForEach Query Result
+	UK2Node_IfThenElse* Branch = CompilerContext.SpawnIntermediateNode<UK2Node_IfThenElse>(this, SourceGraph);
+	Branch->AllocateDefaultPins();
+
+	UK2Node_ExecutionSequence* Sequence = CompilerContext.SpawnIntermediateNode<UK2Node_ExecutionSequence>(this, SourceGraph);
+	Sequence->AllocateDefaultPins();
+
+	UK2Node_CallFunction* Step = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+	Step->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(USmoothSqlFunctionLibrary, K2_StepStatement), USmoothSqlFunctionLibrary::StaticClass());
+	Step->AllocateDefaultPins();
+
+	Schema->TryCreateConnection(LastThenPin, Step->GetExecPin());
+	Schema->TryCreateConnection(StatementPin, Step->FindPinChecked(L"Target"));
+	Schema->TryCreateConnection(Step->GetThenPin(), Branch->GetExecPin());
+	Schema->TryCreateConnection(Step->FindPinChecked(L"Success"), Branch->GetConditionPin());
+	Schema->TryCreateConnection(Branch->GetThenPin(), Sequence->GetExecPin());
+	Schema->TryCreateConnection(Sequence->GetThenPinGivenIndex(1), Step->GetExecPin());
+
+	MovePinLinksOrCopyDefaults(CompilerContext, GetLoopPin(), Sequence->GetThenPinGivenIndex(0));
+	MovePinLinksOrCopyDefaults(CompilerContext, GetCompletedPin(), Branch->GetElsePin());
+
+	// Read only columns that are used, by index
+	for (int32 Idx = 0; Idx < ColumnNames.Num(); ++Idx)
+	{
+		UEdGraphPin* ColumnPin = GetColumnPin(Idx);
+		if (ColumnPin->LinkedTo.Num() == 0)
+		{
+			continue;
+		}
+
+		const TypedQuery::FColumnPinType PinType = TypedQuery::GetColumnPinType(static_cast<EDbValueType>(ColumnTypes[Idx]), ColumnDeclaredTypes[Idx]);
+
+		UK2Node_CallFunction* Get = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+		Get->FunctionReference.SetExternalMember(PinType.Getter, USmoothSqlFunctionLibrary::StaticClass());
+		Get->AllocateDefaultPins();
+		Get->FindPinChecked(L"ColumnIdx")->DefaultValue = FString::FromInt(Idx);
+
+		Schema->TryCreateConnection(Step->GetReturnValuePin(), Get->FindPinChecked(L"Target"));
+		CompilerContext.MovePinLinksToIntermediate(*ColumnPin, *Get->GetReturnValuePin());
+	}
+
+	BreakAllNodeLinks();
+}
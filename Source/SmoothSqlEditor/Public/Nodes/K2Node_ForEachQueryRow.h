@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "K2Node.h"
+#include "K2Node_ForEachQueryRow.generated.h"
+
+/**
+ * Iterates over query results, reading every row into a struct with one native call
+ *
+ * Struct members are filled from columns with the same names
+ */
+UCLASS()
+class SMOOTHSQLEDITOR_API UK2Node_ForEachQueryRow : public UK2Node
+{
+	GENERATED_BODY()
+
+	UEdGraphPin* GetTargetPin() const;
+	UEdGraphPin* GetLoopPin() const;
+	UEdGraphPin* GetRowPin() const;
+	UEdGraphPin* GetCompletedPin() const;
+
+	void MovePinLinksOrCopyDefaults( FKismetCompilerContext &CompilerContext, UEdGraphPin *Source, UEdGraphPin *Dest );
+
+public:
+
+	// Struct every row is read into
+	UPROPERTY(EditAnywhere, Category="Query")
+	UScriptStruct* RowStruct;
+
+	virtual void AllocateDefaultPins() override;
+	virtual void GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const override;
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual bool IsNodePure() const override;
+	virtual FSlateIcon GetIconAndTint(FLinearColor& OutColor) const override;
+	virtual FText GetMenuCategory() const override;
+	virtual FLinearColor GetNodeTitleColor() const override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph) override;
+
+	virtual FText GetTooltipText() const override;
+};
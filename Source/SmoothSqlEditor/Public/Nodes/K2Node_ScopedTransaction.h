@@ -8,21 +8,21 @@
 #include "K2Node_ScopedTransaction.generated.h"
 
 /**
- * 
+ * Runs Body inside a transaction of existing connection
+ *
+ * Transaction is committed once Body finishes, or rolled back if any statement failed inside it
  */
 UCLASS()
 class SMOOTHSQLEDITOR_API UK2Node_ScopedTransaction : public UK2Node
 {
 	GENERATED_BODY()
 
-	UEdGraphPin* GetConditionCreatePin() const;
-	UEdGraphPin* GetInnerDbHandlePin() const;
-	UEdGraphPin* GetConnectionParamsPin() const;
-	UEdGraphPin* GetThenPin() const;
 	UEdGraphPin* GetDbHandlePin() const;
+	UEdGraphPin* GetBehaviorPin() const;
+	UEdGraphPin* GetThenPin() const;
+	UEdGraphPin* GetInnerDbHandlePin() const;
 	UEdGraphPin* GetScopeExitPin() const;
-
-	void UpdateConnectionPin();
+	UEdGraphPin* GetFailedPin() const;
 
 public:
 	virtual void AllocateDefaultPins() override;
@@ -32,11 +32,6 @@ public:
 	virtual FLinearColor GetNodeTitleColor() const override;
 	virtual FText GetKeywords() const override;
 	virtual FText GetMenuCategory() const override;
-	virtual void ReconstructNode() override;
-	virtual void PinDefaultValueChanged(UEdGraphPin* Pin) override;
-	void PinConnectionListChanged(UEdGraphPin* Pin) override;
 	virtual void GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const override;
 	virtual void ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph) override;
-
-private:
 };
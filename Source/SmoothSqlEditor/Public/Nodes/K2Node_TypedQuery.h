@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "K2Node.h"
+#include "Engine/EngineTypes.h"
+#include "K2Node_TypedQuery.generated.h"
+
+/**
+ * Runs literal SQL and iterates over its rows with typed pins
+ *
+ * SQL is prepared against schema database in the editor, which gives one output pin per result column
+ * typed by the column declaration and one input pin per parameter. Node compiles down to cached statement,
+ * binds and reads by index, so there are no name lookups at runtime.
+ */
+UCLASS()
+class SMOOTHSQLEDITOR_API UK2Node_TypedQuery : public UK2Node
+{
+	GENERATED_BODY()
+
+	UEdGraphPin* GetTargetPin() const;
+	UEdGraphPin* GetLoopPin() const;
+	UEdGraphPin* GetCompletedPin() const;
+	UEdGraphPin* GetParamPin(int32 Idx) const;
+	UEdGraphPin* GetColumnPin(int32 Idx) const;
+
+	/**
+	 * @brief Database used to validate SQL
+	 */
+	FString GetSchemaDbPath() const;
+
+	/**
+	 * @brief Prepare SQL and store its columns and params
+	 */
+	void RefreshSchema();
+
+	void SyncParamType(UEdGraphPin* Pin);
+
+	void MovePinLinksOrCopyDefaults( FKismetCompilerContext &CompilerContext, UEdGraphPin *Source, UEdGraphPin *Dest );
+
+public:
+
+	// Query to run, parameters may be anonymous (?) or named (:name, @name, $name)
+	UPROPERTY(EditAnywhere, Category="Query", meta=(MultiLine=true))
+	FString SQL;
+
+	// Database with the schema SQL is validated against, default connection database if empty
+	UPROPERTY(EditAnywhere, Category="Query", meta=(FilePathFilter="Database files (*.db)|*.db"))
+	FFilePath SchemaDatabase;
+
+	virtual void AllocateDefaultPins() override;
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual bool IsNodePure() const override;
+	virtual FText GetTooltipText() const override;
+	virtual FLinearColor GetNodeTitleColor() const override;
+	virtual FSlateIcon GetIconAndTint(FLinearColor& OutColor) const override;
+	virtual FText GetMenuCategory() const override;
+	virtual void GetMenuActions(FBlueprintActionDatabaseRegistrar& ActionRegistrar) const override;
+	virtual bool IsConnectionDisallowed(const UEdGraphPin* MyPin, const UEdGraphPin* OtherPin, FString& OutReason) const override;
+	virtual void PinConnectionListChanged(UEdGraphPin* Pin) override;
+	virtual void ReconstructNode() override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph) override;
+
+private:
+
+	UPROPERTY()
+	TArray<FString> ColumnNames;		///< Result columns found by last refresh
+
+	UPROPERTY()
+	TArray<uint8> ColumnTypes;			///< EDbValueType of ColumnNames
+
+	UPROPERTY()
+	TArray<FString> ColumnDeclaredTypes;	///< Declared types of ColumnNames
+
+	UPROPERTY()
+	TArray<FString> ParamNames;			///< Parameters found by last refresh
+
+	UPROPERTY()
+	FString SchemaError;				///< Error of last refresh
+};
@@ -701,6 +701,12 @@ public:
     /// Return UTF-8 encoded English language explanation of the most recent failed API call (if any).
     const char* getErrorMsg() const noexcept;
 
+    /// Return the raw SQLite Statement Object, for SQLite APIs not wrapped by this class
+    sqlite3_stmt* getStatementHandle() const noexcept
+    {
+        return mStmtPtr;
+    }
+
 private:
     /**
      * @brief Shared pointer to the sqlite3_stmt SQLite Statement Object.